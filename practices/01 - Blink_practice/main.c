@@ -3,30 +3,62 @@
 #include "pico/time.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "wake_bench.h"
+#include "gpio_seq.h"
+#include "core_affinity.h"
+#include "rtos_alloc.h"
+#include "stack_profile.h"
+#include "tickless.h"
+#include "deadline_monitor.h"
+#include "stack_sizes.h"
 
 #define LED1_PIN 2
 #define LED2_PIN 3
 #define LED3_PIN 4
+#define LED_DEADLINE_MS 5 // Cada troca dos LEDs, contada da liberação (DEADLINE_MONITOR = 1)
 
+// LEDs trocados por um software timer a partir da tabela de passos (1) ou
+// pela tarefa original com vTaskDelayUntil (0)
+#ifndef LED_SEQUENCER
+#define LED_SEQUENCER 1
+#endif
+
+#if LED_SEQUENCER
+// Um LED aceso por vez, 250 ms cada, para sempre
+static const GpioSeqStep_t ledSteps[] = {
+    { 1u << LED1_PIN, 250 },
+    { 1u << LED2_PIN, 250 },
+    { 1u << LED3_PIN, 250 },
+};
+static GpioSequence_t ledSequence;
+#else
 void led_task(void *pvParameters) {
     const TickType_t xDelay = pdMS_TO_TICKS(250); // Intervalo de 500ms
     TickType_t xLastWakeTime = xTaskGetTickCount();
+    WAKE_BENCH_TASK(wakeStats, "LED Task", 250);
+#if DEADLINE_MONITOR
+    deadline_monitor_register(250, LED_DEADLINE_MS, NULL); // Cada vTaskDelayUntil fecha um job
+#endif
 
     while (1) {
         gpio_put(LED1_PIN, 1); // Liga o LED1
         vTaskDelayUntil(&xLastWakeTime, xDelay);
+        WAKE_BENCH_MARK(wakeStats);
 
         gpio_put(LED1_PIN, 0); // Desliga o LED1
         gpio_put(LED2_PIN, 1); // Liga o LED2
         vTaskDelayUntil(&xLastWakeTime, xDelay);
+        WAKE_BENCH_MARK(wakeStats);
 
         gpio_put(LED2_PIN, 0); // Desliga o LED2
         gpio_put(LED3_PIN, 1); // Liga o LED3
         vTaskDelayUntil(&xLastWakeTime, xDelay);
+        WAKE_BENCH_MARK(wakeStats);
 
         gpio_put(LED3_PIN, 0); // Desliga o LED3
     }
 }
+#endif
 
 int main() {
     stdio_init_all();
@@ -38,7 +70,26 @@ int main() {
     gpio_init(LED3_PIN);
     gpio_set_dir(LED3_PIN, GPIO_OUT);
 
-    xTaskCreate(led_task, "LED Task", 1024, NULL, configMAX_PRIORITIES, NULL);
+#if LED_SEQUENCER
+    gpio_seq_start(&ledSequence, "LED Sequence", ledSteps, sizeof(ledSteps) / sizeof(ledSteps[0]), GPIO_SEQ_FOREVER);
+#else
+    core_affinity_create(led_task, "LED Task", STACK_LED_TASK, NULL, tskIDLE_PRIORITY + 1, CORE_ROLE_UI, NULL);
+#endif
+
+#if WAKE_BENCH
+    wake_bench_init(); // Carga de interferência e relatório de latência
+#endif
+
+#if TICKLESS_IDLE
+    tickless_init(); // Sono da idle entre os ticks e relatório de residência
+#endif
+
+#if STACK_PROFILE
+    stack_profile_init(); // Uso de pilha de cada tarefa
+#endif
+#if RAM_REPORT
+    rtos_alloc_report(); // Memória de cada objeto do kernel criado até aqui
+#endif
 
     vTaskStartScheduler();
 
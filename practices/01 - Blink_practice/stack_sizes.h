@@ -0,0 +1,11 @@
+#ifndef STACK_SIZES_H
+#define STACK_SIZES_H
+
+// Profundidade da pilha de cada tarefa, em palavras. Ainda não dimensionado:
+// sem uma execução com STACK_PROFILE=1, são os valores que a prática já usava.
+// Para dimensionar a partir de uma:
+//   python3 tools/stack_sizes.py --update "practices/01 - Blink_practice/stack_sizes.h" saida.txt
+
+#define STACK_LED_TASK 1024  // original da prática, não medido
+
+#endif
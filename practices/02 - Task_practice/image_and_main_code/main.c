@@ -3,21 +3,50 @@
 #include "pico/time.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "wake_bench.h"
+#include "gpio_seq.h"
+#include "core_affinity.h"
+#include "rtos_alloc.h"
+#include "stack_profile.h"
+#include "tickless.h"
+#include "stack_sizes.h"
 
 #define LED1_PIN 5
 #define LED2_PIN 6
 
+// Piscas feitos por software timers a partir de tabelas de passos (1) ou
+// pelas duas tarefas originais (0)
+#ifndef LED_SEQUENCER
+#define LED_SEQUENCER 1
+#endif
+
+#if LED_SEQUENCER
+// LED1 pisca 3 vezes e para; LED2 pisca para sempre, começando apagado
+static const GpioSeqStep_t led1Steps[] = {
+    { 1u << LED1_PIN, 250 },
+    { 0, 250 },
+};
+static const GpioSeqStep_t led2Steps[] = {
+    { 0, 250 },
+    { 1u << LED2_PIN, 250 },
+};
+static GpioSequence_t led1Sequence;
+static GpioSequence_t led2Sequence;
+#else
 int led1_count = 0;
 
 void blink_led1_task(void *pvParameters) {
     const TickType_t delay = pdMS_TO_TICKS(250);
+    WAKE_BENCH_TASK(wakeStats, "Blink LED1 Task", 250);
 
     for (;;) {
         if (led1_count < 3) {
             gpio_put(LED1_PIN, 1);
             vTaskDelay(delay); // meio segundo de atraso
+            WAKE_BENCH_MARK(wakeStats);
             gpio_put(LED1_PIN, 0);
             vTaskDelay(delay); // meio segundo de atraso
+            WAKE_BENCH_MARK(wakeStats);
             led1_count++;
         }else {
 	
@@ -29,14 +58,18 @@ void blink_led1_task(void *pvParameters) {
 
 void blink_led2_task(void *pvParameters) {
     const TickType_t delay = pdMS_TO_TICKS(250);
+    WAKE_BENCH_TASK(wakeStats, "Blink LED2 Task", 250);
 
     for (;;) {
         gpio_put(LED2_PIN, 0);
         vTaskDelay(delay); // meio segundo de atraso
+        WAKE_BENCH_MARK(wakeStats);
         gpio_put(LED2_PIN, 1);
         vTaskDelay(delay); // meio segundo de atraso
+        WAKE_BENCH_MARK(wakeStats);
     }
 }
+#endif
 
 int main() {
     stdio_init_all();
@@ -47,8 +80,28 @@ int main() {
     gpio_init(LED2_PIN);
     gpio_set_dir(LED2_PIN, GPIO_OUT);
 
-    xTaskCreate(blink_led1_task, "Blink LED1 Task", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
-    xTaskCreate(blink_led2_task, "Blink LED2 Task", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
+#if LED_SEQUENCER
+    gpio_seq_start(&led1Sequence, "Blink LED1", led1Steps, sizeof(led1Steps) / sizeof(led1Steps[0]), 3);
+    gpio_seq_start(&led2Sequence, "Blink LED2", led2Steps, sizeof(led2Steps) / sizeof(led2Steps[0]), GPIO_SEQ_FOREVER);
+#else
+    core_affinity_create(blink_led1_task, "Blink LED1 Task", STACK_BLINK_LED1_TASK, NULL, tskIDLE_PRIORITY, CORE_ROLE_UI, NULL);
+    core_affinity_create(blink_led2_task, "Blink LED2 Task", STACK_BLINK_LED2_TASK, NULL, tskIDLE_PRIORITY, CORE_ROLE_UI, NULL);
+#endif
+
+#if WAKE_BENCH
+    wake_bench_init(); // Carga de interferência e relatório de latência
+#endif
+
+#if TICKLESS_IDLE
+    tickless_init(); // Sono da idle entre os ticks e relatório de residência
+#endif
+
+#if STACK_PROFILE
+    stack_profile_init(); // Uso de pilha de cada tarefa
+#endif
+#if RAM_REPORT
+    rtos_alloc_report(); // Memória de cada objeto do kernel criado até aqui
+#endif
 
     vTaskStartScheduler();
 
@@ -2,6 +2,14 @@
 #include "pico/time.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "runtime_stats.h"
+#include "wake_bench.h"
+#include "core_affinity.h"
+#include "rtos_alloc.h"
+#include "stack_profile.h"
+#include "tickless.h"
+#include "telemetry.h"
+#include "stack_sizes.h"
 
 // Definições dos pinos dos LEDs
 #define LED1_PIN 14
@@ -9,35 +17,47 @@
 
 // Variáveis globais
 volatile unsigned long ulIdleCycleCount = 0UL;
-volatile unsigned long ulPreviousIdleCycleCount = 0UL;
-volatile float cpu_usage = 0.0f; // Variável global para uso da CPU
 
-// Função idle hook
+// Função idle hook; com TICKLESS_IDLE=1 conta uma volta da idle por despertar
 void vApplicationIdleHook(void)
 {
     ulIdleCycleCount++;
 }
 
-// Função para calcular e atualizar o uso da CPU
-void update_cpu_usage(void)
+// Função para imprimir o uso de CPU da tarefa e o uso total na janela de medição
+static void vPrintStatus(const char *pcLedName, unsigned long ulNumber)
 {
-    unsigned long ulCurrentIdleCycleCount = ulIdleCycleCount;
-    cpu_usage = ((float)(ulCurrentIdleCycleCount - ulPreviousIdleCycleCount) / ulCurrentIdleCycleCount) * 100;
-    ulPreviousIdleCycleCount = ulCurrentIdleCycleCount;
+    RuntimeStats_t task, cpu;
+
+#if TELEMETRY
+    // Registros binários no lugar da linha de texto; o nome da tarefa vai no registro
+    (void) pcLedName;
+    if (runtime_stats_get_task(NULL, &task) && runtime_stats_get_cpu(&cpu)) {
+        telemetry_task(pcTaskGetName(NULL), (uint32_t) (task.usage * 100), (uint32_t) (task.peak * 100));
+        telemetry_task("CPU", (uint32_t) (cpu.usage * 100), (uint32_t) (cpu.peak * 100));
+    }
+    telemetry_event("idle_cycles", ulNumber);
+#else
+    if (runtime_stats_get_task(NULL, &task) && runtime_stats_get_cpu(&cpu)) {
+        printf("%s Task is running. ulIdleCycleCount = %lu, Task CPU: %.2f%% (peak %.2f%%), CPU Usage: %.2f%% (peak %.2f%%)\n",
+               pcLedName, ulNumber, task.usage, task.peak, cpu.usage, cpu.peak);
+    } else {
+        // Ainda não há amostras suficientes para uma janela
+        printf("%s Task is running. ulIdleCycleCount = %lu\n", pcLedName, ulNumber);
+    }
+#endif
 }
 
 // Função para imprimir o nome da tarefa, o contador e o uso da CPU para LED1
 void vPrintLED1Status(unsigned long ulNumber)
 {
-    update_cpu_usage();
-    printf("LED1 Task is running. ulIdleCycleCount = %lu, CPU Usage: %.2f%%\n", ulNumber, cpu_usage);
+    vPrintStatus("LED1", ulNumber);
 }
 
 // Função para imprimir o nome da tarefa, o contador e o uso da CPU para LED2
 void vPrintLED2Status(unsigned long ulNumber)
 {
-    // O valor de cpu_usage já foi atualizado pela tarefa LED1
-    printf("LED2 Task is running. ulIdleCycleCount = %lu, CPU Usage: %.2f%%\n", ulNumber, cpu_usage);
+    vPrintStatus("LED2", ulNumber);
 }
 
 // Função da tarefa para piscar o LED1
@@ -47,12 +67,15 @@ void blink_led1_task(void *pvParameters) {
     // Configura o pino GPIO como saída
     gpio_init(LED1_PIN);
     gpio_set_dir(LED1_PIN, GPIO_OUT);
+    WAKE_BENCH_TASK(wakeStats, "Blink LED1 Task", 500);
 
     for (;;) {
         gpio_put(LED1_PIN, 1);
         vTaskDelay(delay); // meio segundo de atraso
+        WAKE_BENCH_MARK(wakeStats);
         gpio_put(LED1_PIN, 0);
         vTaskDelay(delay); // meio segundo de atraso
+        WAKE_BENCH_MARK(wakeStats);
         vPrintLED1Status(ulIdleCycleCount);
     }
 }
@@ -64,12 +87,15 @@ void blink_led2_task(void *pvParameters) {
     // Configura o pino GPIO como saída
     gpio_init(LED2_PIN);
     gpio_set_dir(LED2_PIN, GPIO_OUT);
+    WAKE_BENCH_TASK(wakeStats, "Blink LED2 Task", 500);
 
     for (;;) {
         gpio_put(LED2_PIN, 0);
         vTaskDelay(delay); // meio segundo de atraso
+        WAKE_BENCH_MARK(wakeStats);
         gpio_put(LED2_PIN, 1);
         vTaskDelay(delay); // meio segundo de atraso
+        WAKE_BENCH_MARK(wakeStats);
         vPrintLED2Status(ulIdleCycleCount);
     }
 }
@@ -79,8 +105,30 @@ int main() {
     stdio_init_all();
 
     // Cria as tarefas
-    xTaskCreate(blink_led1_task, "Blink LED1 Task", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
-    xTaskCreate(blink_led2_task, "Blink LED2 Task", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
+    core_affinity_create(blink_led1_task, "Blink LED1 Task", STACK_BLINK_LED1_TASK, NULL, tskIDLE_PRIORITY, CORE_ROLE_UI, NULL);
+    core_affinity_create(blink_led2_task, "Blink LED2 Task", STACK_BLINK_LED2_TASK, NULL, tskIDLE_PRIORITY, CORE_ROLE_UI, NULL);
+
+    // Inicia a medição de uso de CPU por tarefa
+    runtime_stats_init();
+
+#if TELEMETRY
+    telemetry_init(tskIDLE_PRIORITY + 1); // Envio dos registros em lotes
+#endif
+
+#if WAKE_BENCH
+    wake_bench_init(); // Carga de interferência e relatório de latência
+#endif
+
+#if TICKLESS_IDLE
+    tickless_init(); // Sono da idle entre os ticks e relatório de residência
+#endif
+
+#if STACK_PROFILE
+    stack_profile_init(); // Uso de pilha de cada tarefa
+#endif
+#if RAM_REPORT
+    rtos_alloc_report(); // Memória de cada objeto do kernel criado até aqui
+#endif
 
     // Inicia o scheduler
     vTaskStartScheduler();
@@ -90,4 +138,3 @@ int main() {
 
     return 0;
 }
-
@@ -0,0 +1,12 @@
+#ifndef STACK_SIZES_H
+#define STACK_SIZES_H
+
+// Profundidade da pilha de cada tarefa, em palavras. Ainda não dimensionado:
+// sem uma execução com STACK_PROFILE=1, são os valores que a prática já usava.
+// Para dimensionar a partir de uma:
+//   python3 tools/stack_sizes.py --update "practices/03 - Idle Hook/stack_sizes.h" saida.txt
+
+#define STACK_BLINK_LED1_TASK configMINIMAL_STACK_SIZE  // original da prática, não medido
+#define STACK_BLINK_LED2_TASK configMINIMAL_STACK_SIZE  // original da prática, não medido
+
+#endif
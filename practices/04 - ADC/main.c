@@ -1,81 +1,538 @@
 #include <stdio.h>
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
 #include "pico/stdlib.h"
 #include "hardware/adc.h"
+#ifndef PICO_SIM
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#endif
+#include "sample_ring.h"
+#include "adc_filter.h"
+#include "runtime_stats.h"
+#include "tone.h"
+#include "dlog.h"
+#include "telemetry.h"
+#include "core_affinity.h"
+#include "rtos_alloc.h"
+#include "stack_profile.h"
+#include "stack_sizes.h"
+#include "trace_recorder.h"
+#include "deadline_monitor.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#endif
 
 // Definições de pinos
 #define ADC_PIN 26
 #define LED_PIN 15
 #define BUZZER_PIN 14
 
-// Definições para a Queue
-QueueHandle_t adcQueue;
+// Definições da amostragem
+#define ADC_SAMPLE_RATE_HZ 100000  // 100 kS/s
+#define ADC_BLOCK_SAMPLES 256      // Amostras por bloco de DMA
+#define ADC_RING_SAMPLES 4096      // Tamanho do buffer circular (potência de 2)
+#define ADC_REPORT_MS 300          // Intervalo entre as impressões no terminal
+#define ADC_THRESHOLD 2000
+#define ADC_HYSTERESIS 100         // Liga acima de 2050, desliga abaixo de 1950
+
+// Definições do filtro
+#ifndef ADC_FILTER
+#define ADC_FILTER 1               // 0 = consumidores leem as amostras cruas, para comparação
+#endif
+#define ADC_DECIMATION_LOG2 6      // Média de 64 amostras por valor filtrado (1562 valores/s)
+#define ADC_IIR_SHIFT 2            // IIR sobre as médias: y += (x - y) / 4
+#ifndef ADC_FILTER_BENCH
+#define ADC_FILTER_BENCH 0         // 1 = mede o custo do filtro por amostra na partida
+#endif
+
+// Definições do buzzer
+#define BUZZER_FREQ_HZ 1000
+#define BUZZER_DURATION_MS 100
+#ifndef BUZZER_BUSY_WAIT
+#define BUZZER_BUSY_WAIT 0         // 1 = laço de espera ocupada original, para comparação
+#endif
+
+// Deadline da tarefa do ADC (DEADLINE_MONITOR = 1)
+#ifdef PICO_SIM
+#define ADC_PERIOD_MS 1            // O ADC simulado é lido a cada tick
+#define ADC_DEADLINE_MS 1
+#elif ADC_FILTER
+#define ADC_PERIOD_MS 0            // Acordada pelo DMA a cada bloco (2,56 ms)
+#define ADC_DEADLINE_MS 2
+#else
+#define ADC_PERIOD_MS ADC_REPORT_MS
+#define ADC_DEADLINE_MS 10
+#endif
+
+// Buffer circular compartilhado pelos consumidores (sem cópia)
+static uint16_t adcBuffer[ADC_RING_SAMPLES];
+SampleRing_t adcRing;
+int ledConsumer;
+int buzzerConsumer;
+TaskHandle_t ledTaskHandle;
+TaskHandle_t buzzerTaskHandle;
+
+// Despertares de cada consumidor e eventos úteis (mudanças de estado do LED)
+volatile uint32_t ledWakeups;
+volatile uint32_t buzzerWakeups;
+volatile uint32_t adcEvents;
+
+#if ADC_FILTER
+// Estágio de filtro: a tarefa do ADC é o único consumidor do buffer e publica
+// só os valores filtrados e as passagens pelo limiar
+int filterConsumer;
+static AdcFilter_t adcFilter;
+static AdcHysteresis_t adcDetector;
+volatile uint16_t adcFiltered;
+volatile uint32_t adcFilteredCount;
+
+// Filtra o que chegou no buffer; LED e buzzer são notificados só nos eventos,
+// com o evento nos 16 bits altos e o valor filtrado nos baixos
+static void adc_filter_drain(void) {
+    static uint16_t filtered[(ADC_RING_SAMPLES >> ADC_DECIMATION_LOG2) + 1];
+    const uint16_t *samples;
+    uint32_t count;
+
+    while ((count = sample_ring_peek(&adcRing, filterConsumer, &samples)) > 0) {
+        uint32_t produced = adc_filter_process(&adcFilter, samples, count, filtered);
+        if (!sample_ring_release(&adcRing, filterConsumer, count)) {
+            continue;
+        }
+
+        for (uint32_t i = 0; i < produced; i++) {
+            AdcEvent_t event = adc_hysteresis_update(&adcDetector, filtered[i]);
+            if (event != ADC_EVENT_NONE) {
+                uint32_t value = ((uint32_t) event << 16) | filtered[i];
+                adcEvents++;
+                xTaskNotify(ledTaskHandle, value, eSetValueWithOverwrite);
+                xTaskNotify(buzzerTaskHandle, value, eSetValueWithOverwrite);
+            }
+        }
+        if (produced > 0) {
+            adcFiltered = filtered[produced - 1];
+            adcFilteredCount += produced;
+#if TELEMETRY
+            telemetry_adc(0, filtered, produced); // Todos os valores filtrados, em binário
+#endif
+        }
+    }
+}
+#endif
+
+#ifdef PICO_SIM
+// No host o ADC simulado faz o papel do DMA: a cada tick escreve as amostras
+// que o hardware teria convertido desde a última chamada
+static uint64_t simStartUs;
+static uint64_t simProduced;
+
+static void adc_sampler_start(void) {
+    simStartUs = time_us_64();
+    simProduced = 0;
+}
+
+static void adc_sampler_poll(void) {
+    uint64_t due = (time_us_64() - simStartUs) * ADC_SAMPLE_RATE_HZ / 1000000;
+    uint32_t count = (uint32_t) (due - simProduced);
+
+    for (uint32_t i = 0; i < count; i++) {
+        *sample_ring_write_ptr(&adcRing, i) = adc_read();
+    }
+    sample_ring_commit(&adcRing, count);
+    simProduced = due;
+}
+#else
+// Na placa o ADC roda livre e dois canais de DMA encadeados se revezam nos
+// blocos do buffer, então não há intervalo sem captura entre um bloco e outro
+static int dmaChannel[2];
+
+static void adc_dma_irq_handler(void) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    for (int i = 0; i < 2; i++) {
+        if (dma_channel_get_irq0_status(dmaChannel[i])) {
+            dma_channel_acknowledge_irq0(dmaChannel[i]);
+
+            // Publica o bloco concluído; o outro canal já está no bloco seguinte,
+            // então este é reprogramado para o bloco depois dele
+            sample_ring_commit_from_isr(&adcRing, ADC_BLOCK_SAMPLES, &xHigherPriorityTaskWoken);
+            dma_channel_set_write_addr(dmaChannel[i], sample_ring_write_ptr(&adcRing, ADC_BLOCK_SAMPLES), false);
+            dma_channel_set_trans_count(dmaChannel[i], ADC_BLOCK_SAMPLES, false);
+        }
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+static void adc_sampler_start(void) {
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_set_clkdiv(48000000.0f / ADC_SAMPLE_RATE_HZ - 1);
+
+    dmaChannel[0] = dma_claim_unused_channel(true);
+    dmaChannel[1] = dma_claim_unused_channel(true);
+
+    for (int i = 0; i < 2; i++) {
+        dma_channel_config config = dma_channel_get_default_config(dmaChannel[i]);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+        channel_config_set_read_increment(&config, false);
+        channel_config_set_write_increment(&config, true);
+        channel_config_set_dreq(&config, DREQ_ADC);
+        channel_config_set_chain_to(&config, dmaChannel[1 - i]);
+
+        dma_channel_configure(dmaChannel[i], &config, sample_ring_write_ptr(&adcRing, i * ADC_BLOCK_SAMPLES),
+                              &adc_hw->fifo, ADC_BLOCK_SAMPLES, false);
+        dma_channel_set_irq0_enabled(dmaChannel[i], true);
+    }
+
+    irq_set_exclusive_handler(DMA_IRQ_0, adc_dma_irq_handler);
+    irq_set_enabled(DMA_IRQ_0, true);
+
+    dma_channel_start(dmaChannel[0]);
+    adc_run(true);
+}
+#endif
+
+#ifdef PICO_SIM
+// Resumo do buffer circular ao final da execução: amostras produzidas a
+// 100 kS/s e as perdas de cada consumidor
+static void adc_ring_report(void) {
+#if ADC_FILTER
+    static const char *const names[] = { "filter" };
+#else
+    static const char *const names[] = { "led", "buzzer" };
+#endif
+
+    printf("{\"adc_ring\":{\"rate_hz\":%u,\"samples\":%lu,\"seconds\":%.3f,\"consumers\":{",
+           (unsigned) ADC_SAMPLE_RATE_HZ, (unsigned long) adcRing.head, (double) (time_us_64() - simStartUs) / 1e6);
+    for (uint32_t i = 0; i < adcRing.consumer_count; i++) {
+        printf("%s\"%s\":{\"overruns\":%lu,\"dropped_samples\":%lu}", i ? "," : "", names[i],
+               (unsigned long) adcRing.consumers[i].overruns, (unsigned long) adcRing.consumers[i].dropped_samples);
+    }
+    printf("}}}\n");
+}
+#endif
+
+#if DEADLINE_MONITOR
+// Chamado na tarefa do ADC quando um job perde o deadline; no máximo uma
+// linha por intervalo de relatório, para o log não virar a sobrecarga
+static void adc_deadline_overrun(TaskHandle_t task, const DeadlineStats_t *stats) {
+    static TickType_t lastLog;
+    static bool logged = false;
+    TickType_t now = xTaskGetTickCount();
+
+    (void) task;
+    if (logged && now - lastLog < pdMS_TO_TICKS(ADC_REPORT_MS)) {
+        return;
+    }
+    logged = true;
+    lastLog = now;
+#if TELEMETRY
+    telemetry_event("deadline_response_us", stats->last_response_us);
+#else
+    DLOG("ADC deadline miss at %u ms: response %u us (deadline %u us, %u in a row)\n",
+         (unsigned) (now * portTICK_PERIOD_MS), stats->last_response_us, stats->deadline_us,
+         stats->consecutive_misses);
+#endif
+}
+#endif
 
 // Tarefa para ler o valor do ADC
 void adc_read_task(void *params) {
-    uint16_t adc_value;
+    TickType_t xLastReport = xTaskGetTickCount();
+
+    adc_select_input(0);
+    adc_sampler_start(); // A IRQ do DMA fica no núcleo desta tarefa
+    core_affinity_pin_idle_tasks();
+#if DEADLINE_MONITOR
+    deadline_monitor_register(ADC_PERIOD_MS, ADC_DEADLINE_MS, adc_deadline_overrun);
+#endif
 
     while (1) {
-        // Ler o valor do ADC
-        adc_select_input(0);
-        adc_value = adc_read();
+#ifdef PICO_SIM
+        adc_sampler_poll();
+        vTaskDelay(1);
+#elif ADC_FILTER
+        sample_ring_wait(&adcRing, filterConsumer, pdMS_TO_TICKS(ADC_REPORT_MS));
+#else
+        vTaskDelay(pdMS_TO_TICKS(ADC_REPORT_MS));
+#endif
+#if ADC_FILTER
+        adc_filter_drain();
+#endif
 
-        // Enviar o valor do ADC para a Queue
-        xQueueSend(adcQueue, &adc_value, portMAX_DELAY);
+        if (xTaskGetTickCount() - xLastReport >= pdMS_TO_TICKS(ADC_REPORT_MS)) {
+            xLastReport = xTaskGetTickCount();
 
-        // Imprimir o valor do ADC no terminal
-        printf("ADC Value: %d\n", adc_value);
+#if TELEMETRY
+            // Os valores filtrados já saíram no estágio de filtro; aqui vão as perdas
+#if ADC_FILTER
+            telemetry_event("filter_overruns", adcRing.consumers[filterConsumer].overruns);
+#else
+            uint16_t lastSample = adcBuffer[(adcRing.head - 1) & adcRing.mask];
+            telemetry_adc(0, &lastSample, 1);
+            telemetry_event("led_overruns", adcRing.consumers[ledConsumer].overruns);
+            telemetry_event("buzzer_overruns", adcRing.consumers[buzzerConsumer].overruns);
+#endif
+            telemetry_event("led_wakeups", ledWakeups);
+            telemetry_event("buzzer_wakeups", buzzerWakeups);
+            telemetry_event("adc_events", adcEvents);
+#elif ADC_FILTER
+            // Registrar o valor filtrado e as perdas do estágio de filtro (log diferido)
+            DLOG("ADC Filtered: %u (%u samples, %u values, overruns %u/%u)\n",
+                 adcFiltered,
+                 adcRing.head,
+                 adcFilteredCount,
+                 adcRing.consumers[filterConsumer].overruns,
+                 adcRing.consumers[filterConsumer].dropped_samples);
+#else
+            // Registrar o valor do ADC e as perdas de cada consumidor (log diferido)
+            DLOG("ADC Value: %u (%u samples, overruns LED %u/%u, buzzer %u/%u)\n",
+                 adcBuffer[(adcRing.head - 1) & adcRing.mask],
+                 adcRing.head,
+                 adcRing.consumers[ledConsumer].overruns,
+                 adcRing.consumers[ledConsumer].dropped_samples,
+                 adcRing.consumers[buzzerConsumer].overruns,
+                 adcRing.consumers[buzzerConsumer].dropped_samples);
+#endif
+
+#if !TELEMETRY
+            // Registrar quantas vezes os consumidores acordaram para cada evento útil
+            DLOG("Consumers: LED %u, buzzer %u wake-ups for %u events\n",
+                 ledWakeups, buzzerWakeups, adcEvents);
+#endif
+
+            // Registrar o tempo de CPU gasto para gerar o tom, em centésimos de %
+            RuntimeStats_t buzzerStats;
+            if (runtime_stats_get_task(buzzerTaskHandle, &buzzerStats)) {
+                uint32_t usage = (uint32_t) (buzzerStats.usage * 100);
+                uint32_t peak = (uint32_t) (buzzerStats.peak * 100);
+#if TELEMETRY
+                telemetry_task("Buzzer Control", usage, peak);
+#elif BUZZER_BUSY_WAIT
+                DLOG("Buzzer CPU: %u.%02u%% (peak %u.%02u%%), busy-wait loop\n",
+                     usage / 100, usage % 100, peak / 100, peak % 100);
+#else
+                DLOG("Buzzer CPU: %u.%02u%% (peak %u.%02u%%), PWM tone engine (%u us in tone API)\n",
+                     usage / 100, usage % 100, peak / 100, peak % 100, (uint32_t) tone_cpu_time_us());
+#endif
+            }
+
+            // Registrar o uso de cada núcleo; sem SMP é a projeção pelas tarefas
+            CoreUsage_t coreUsage;
+            for (int core = 0; core < CORE_AFFINITY_CORES; core++) {
+                if (core_affinity_get_usage(core, &coreUsage)) {
+                    uint32_t usage = (uint32_t) (coreUsage.usage * 100);
+#if TELEMETRY
+                    static const char *const coreNames[] = { "Core 0", "Core 1" };
+                    telemetry_task(coreNames[core], usage, usage);
+#else
+                    DLOG("Core %u: %u.%02u%% (%u tasks, projected %u)\n",
+                         core, usage / 100, usage % 100, coreUsage.tasks, coreUsage.projected);
+#endif
+                }
+            }
 
-        // Aguardar 300ms
-        vTaskDelay(pdMS_TO_TICKS(300));
+#if DEADLINE_MONITOR
+            // Perdas de deadline desta tarefa até aqui, com o instante para o
+            // tools/deadline_check.py separar as fases do cenário
+            DeadlineStats_t deadline;
+            if (deadline_monitor_get(xTaskGetCurrentTaskHandle(), &deadline)) {
+#if TELEMETRY
+                telemetry_event("deadline_misses", deadline.misses);
+#else
+                DLOG("ADC deadline at %u ms: %u jobs, %u misses, response max %u us\n",
+                     (unsigned) (xLastReport * portTICK_PERIOD_MS), deadline.jobs, deadline.misses,
+                     deadline.max_response_us);
+#endif
+            }
+#endif
+        }
+
+        DEADLINE_JOB_DONE(); // Com o DMA acordando a tarefa; nos outros builds o delay fecha o job
     }
 }
 
 // Tarefa para acionar o LED com base no valor do ADC
+#if ADC_FILTER
 void led_control_task(void *params) {
-    uint16_t adc_value;
+    uint32_t notification;
 
     while (1) {
-        // Receber o valor do ADC da Queue
-        if (xQueueReceive(adcQueue, &adc_value, portMAX_DELAY)) {
-            // Acender ou apagar o LED com base no valor do ADC
-            if (adc_value > 2000) {
-                gpio_put(LED_PIN, 1);
-            } else {
-                gpio_put(LED_PIN, 0);
+        // Acorda só quando o valor filtrado passa pelo limiar
+        xTaskNotifyWait(0, UINT32_MAX, &notification, portMAX_DELAY);
+        ledWakeups++;
+
+        if ((notification >> 16) == ADC_EVENT_RISE) {
+            gpio_put(LED_PIN, 1);
+#if TELEMETRY
+            telemetry_event("led", 1);
+#else
+            DLOG("LED State: ON\n");
+#endif
+        } else {
+            gpio_put(LED_PIN, 0);
+#if TELEMETRY
+            telemetry_event("led", 0);
+#else
+            DLOG("LED State: OFF\n");
+#endif
+        }
+    }
+}
+#else
+void led_control_task(void *params) {
+    uint32_t ledState = 0;
+
+    while (1) {
+        // Esperar novas amostras no buffer
+        if (!sample_ring_wait(&adcRing, ledConsumer, portMAX_DELAY)) {
+            continue;
+        }
+        ledWakeups++;
+
+        const uint16_t *samples;
+        uint32_t count;
+        uint16_t adc_value = 0;
+
+        // Consumir as amostras no lugar; o LED segue a mais recente
+        while ((count = sample_ring_peek(&adcRing, ledConsumer, &samples)) > 0) {
+            adc_value = samples[count - 1];
+            if (!sample_ring_release(&adcRing, ledConsumer, count)) {
+                continue;
             }
 
-            // Imprimir o estado do LED no terminal
-            printf("LED State: %s\n", (adc_value > 2000) ? "ON" : "OFF");
+            // Acender ou apagar o LED com base no valor do ADC
+            uint32_t newState = adc_value > ADC_THRESHOLD;
+            if (newState != ledState) {
+                ledState = newState;
+                adcEvents++;
+                gpio_put(LED_PIN, ledState);
+
+                // Registrar o estado do LED
+#if TELEMETRY
+                telemetry_event("led", ledState);
+#else
+                if (ledState) {
+                    DLOG("LED State: ON\n");
+                } else {
+                    DLOG("LED State: OFF\n");
+                }
+#endif
+            }
         }
     }
 }
 
+#endif
+
 // Tarefa para acionar o buzzer com base no valor do ADC
+#if ADC_FILTER
 void buzzer_control_task(void *params) {
-    uint16_t adc_value;
+    uint32_t notification;
 
     while (1) {
-        // Receber o valor do ADC da Queue
-        if (xQueueReceive(adcQueue, &adc_value, portMAX_DELAY)) {
-            // Acionar ou desligar o buzzer com base no valor do ADC
-            if (adc_value > 2000) {
-                for (int i = 0; i < 100; i++) { // Frequência arbitrária
-                    gpio_put(BUZZER_PIN, 1);
-                    busy_wait_us_32(500); // 1 kHz (500us high + 500us low)
-                    gpio_put(BUZZER_PIN, 0);
-                    busy_wait_us_32(500);
-                }
-            } else {
+        xTaskNotifyWait(0, UINT32_MAX, &notification, portMAX_DELAY);
+        buzzerWakeups++;
+
+#if BUZZER_BUSY_WAIT
+        // Espera ocupada original, repetida até chegar a descida
+        while ((notification >> 16) == ADC_EVENT_RISE) {
+            for (int i = 0; i < 100; i++) {
+                gpio_put(BUZZER_PIN, 1);
+                busy_wait_us_32(500);
                 gpio_put(BUZZER_PIN, 0);
+                busy_wait_us_32(500);
             }
+            if (xTaskNotifyWait(0, UINT32_MAX, &notification, 0) == pdTRUE) {
+                buzzerWakeups++;
+            }
+        }
+#else
+        // O tom dura até a descida, sem a tarefa acordar no meio
+        if ((notification >> 16) == ADC_EVENT_RISE) {
+            tone_play(BUZZER_FREQ_HZ, 0);
+        } else {
+            tone_stop();
         }
+#endif
     }
 }
+#else
+void buzzer_control_task(void *params) {
+#if !BUZZER_BUSY_WAIT
+    bool above = false;
+#endif
+
+    while (1) {
+        // Esperar novas amostras no buffer
+        if (!sample_ring_wait(&adcRing, buzzerConsumer, portMAX_DELAY)) {
+            continue;
+        }
+        buzzerWakeups++;
+
+        const uint16_t *samples;
+        uint32_t count;
+        uint16_t adc_value = 0;
+        bool valid = false;
+
+        while ((count = sample_ring_peek(&adcRing, buzzerConsumer, &samples)) > 0) {
+            adc_value = samples[count - 1];
+            valid = sample_ring_release(&adcRing, buzzerConsumer, count);
+        }
+
+        if (!valid) {
+            continue;
+        }
+
+        // Acionar ou desligar o buzzer com base no valor do ADC
+#if BUZZER_BUSY_WAIT
+        if (adc_value > ADC_THRESHOLD) {
+            for (int i = 0; i < 100; i++) { // Frequência arbitrária
+                gpio_put(BUZZER_PIN, 1);
+                busy_wait_us_32(500); // 1 kHz (500us high + 500us low)
+                gpio_put(BUZZER_PIN, 0);
+                busy_wait_us_32(500);
+            }
+        } else {
+            gpio_put(BUZZER_PIN, 0);
+        }
+#else
+        // O PWM gera o tom e um timer o desliga; só a passagem pelo limiar
+        // inicia ou corta o tom, os outros despertares não mexem nele
+        bool nowAbove = adc_value > ADC_THRESHOLD;
+        if (nowAbove != above) {
+            above = nowAbove;
+            if (above) {
+                tone_play(BUZZER_FREQ_HZ, BUZZER_DURATION_MS);
+            } else {
+                tone_stop();
+            }
+        }
+#endif
+    }
+}
+#endif
+
+#if ADC_FILTER_BENCH || TELEMETRY_BENCH || TRACE_RECORDER_BENCH
+// Benchmarks da partida, com o scheduler já no ar: na placa o SysTick só é
+// ligado pelo vTaskStartScheduler(). A tarefa se remove no fim
+void bench_task(void *params) {
+#if ADC_FILTER_BENCH
+    adc_filter_bench(ADC_DECIMATION_LOG2, ADC_IIR_SHIFT); // Custo do filtro por amostra
+#endif
+#if TELEMETRY_BENCH
+    telemetry_bench(); // Registros binários contra o texto equivalente
+#endif
+#if TRACE_RECORDER_BENCH
+    trace_recorder_bench(); // Custo de gravar um evento do kernel
+#endif
+    vTaskDelete(NULL);
+}
+#endif
 
 int main() {
+    TaskHandle_t adcTaskHandle;
+
     // Inicializar stdio
     stdio_init_all();
 
@@ -88,19 +545,54 @@ int main() {
     gpio_set_dir(LED_PIN, GPIO_OUT);
     gpio_init(BUZZER_PIN);
     gpio_set_dir(BUZZER_PIN, GPIO_OUT);
+#if !BUZZER_BUSY_WAIT
+    tone_init(BUZZER_PIN);
+#endif
 
-    // Criar a Queue para comunicação entre as tarefas
-    adcQueue = xQueueCreate(10, sizeof(uint16_t));
+    // Criar o buffer circular; até dois blocos podem estar em escrita pelo DMA
+    sample_ring_init(&adcRing, adcBuffer, ADC_RING_SAMPLES, 2 * ADC_BLOCK_SAMPLES);
 
-    if (adcQueue == NULL) {
-        printf("Failed to create queue.\n");
-        while (1);
-    }
+    // Criar as tarefas: a amostragem num núcleo, os consumidores e o log no outro
+    core_affinity_create(adc_read_task, "ADC Read Task", STACK_ADC_READ_TASK, NULL, 1, CORE_ROLE_REALTIME, &adcTaskHandle);
+    core_affinity_create(led_control_task, "LED Control Task", STACK_LED_CONTROL_TASK, NULL, 1, CORE_ROLE_UI, &ledTaskHandle);
+    core_affinity_create(buzzer_control_task, "Buzzer Control Task", STACK_BUZZER_CONTROL_TASK, NULL, 1, CORE_ROLE_UI, &buzzerTaskHandle);
+
+#if ADC_FILTER
+    // Só o estágio de filtro lê o buffer; LED e buzzer recebem os eventos
+    filterConsumer = sample_ring_add_consumer(&adcRing, adcTaskHandle);
+    adc_filter_init(&adcFilter, ADC_DECIMATION_LOG2, ADC_IIR_SHIFT);
+    adc_hysteresis_init(&adcDetector, ADC_THRESHOLD, ADC_HYSTERESIS);
+#else
+    // Registrar os consumidores, cada um com o seu cursor de leitura
+    ledConsumer = sample_ring_add_consumer(&adcRing, ledTaskHandle);
+    buzzerConsumer = sample_ring_add_consumer(&adcRing, buzzerTaskHandle);
+#endif
 
-    // Criar as tarefas
-    xTaskCreate(adc_read_task, "ADC Read Task", 256, NULL, 1, NULL);
-    xTaskCreate(led_control_task, "LED Control Task", 256, NULL, 1, NULL);
-    xTaskCreate(buzzer_control_task, "Buzzer Control Task", 256, NULL, 1, NULL);
+    // Medir o uso de CPU das tarefas e iniciar o log diferido
+    runtime_stats_init();
+    dlog_init(tskIDLE_PRIORITY + 1);
+#if TELEMETRY
+    telemetry_init(tskIDLE_PRIORITY + 1);
+#endif
+#ifdef PICO_SIM
+    sim_at_exit(core_affinity_report);
+    sim_at_exit(adc_ring_report);
+#endif
+#if TRACE_RECORDER
+    trace_recorder_init(); // Trace do kernel para tools/trace_to_chrome.py
+#endif
+
+#if ADC_FILTER_BENCH || TELEMETRY_BENCH || TRACE_RECORDER_BENCH
+    // Acima das demais tarefas, roda assim que o scheduler inicia
+    core_affinity_create(bench_task, "Bench Task", STACK_BENCH_TASK, NULL, 2, CORE_ROLE_ANY, NULL);
+#endif
+
+#if STACK_PROFILE
+    stack_profile_init(); // Uso de pilha de cada tarefa
+#endif
+#if RAM_REPORT
+    rtos_alloc_report(); // Memória de cada objeto do kernel criado até aqui
+#endif
 
     // Iniciar o scheduler do FreeRTOS
     vTaskStartScheduler();
@@ -111,4 +603,3 @@ int main() {
 
     return 0;
 }
-
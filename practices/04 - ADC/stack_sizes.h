@@ -0,0 +1,14 @@
+#ifndef STACK_SIZES_H
+#define STACK_SIZES_H
+
+// Profundidade da pilha de cada tarefa, em palavras. Ainda não dimensionado:
+// sem uma execução com STACK_PROFILE=1, são os valores que a prática já usava.
+// Para dimensionar a partir de uma:
+//   python3 tools/stack_sizes.py --update "practices/04 - ADC/stack_sizes.h" saida.txt
+
+#define STACK_ADC_READ_TASK       256  // original da prática, não medido
+#define STACK_BENCH_TASK          1024  // tarefa nova, escolhido à mão, não medido
+#define STACK_BUZZER_CONTROL_TASK 256  // original da prática, não medido
+#define STACK_LED_CONTROL_TASK    256  // original da prática, não medido
+
+#endif
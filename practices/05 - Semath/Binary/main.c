@@ -4,6 +4,14 @@
 #include "task.h"
 #include "queue.h"
 #include "semphr.h"
+#include "dlog.h"
+#include "latency_trace.h"
+#include "msg_pool.h"
+#include "msg_bench.h"
+#include "core_affinity.h"
+#include "rtos_alloc.h"
+#include "stack_profile.h"
+#include "stack_sizes.h"
 
 // LED and button pins
 #define LED_PIN 15
@@ -13,20 +21,42 @@
 TaskHandle_t buttonTaskHandle = NULL;
 TaskHandle_t ledTaskHandle = NULL;
 SemaphoreHandle_t buttonSemaphore;
+
+// LED commands travel by pointer: the buffer comes from ledMessages, moves
+// through ledQueue and goes back to the pool once the LED task has read it
+typedef struct {
+    uint32_t command;    // 1 = toggle the LED
+    uint32_t press;      // Press number since boot
+    uint64_t pressed_us; // When the button task handled the press
+} LedMessage_t;
+
+#define LED_MESSAGES 10
+MSG_POOL_STORAGE(ledMessageStorage, sizeof(LedMessage_t), LED_MESSAGES);
+MsgPool_t ledMessages;
 QueueHandle_t ledQueue;
 
 // Debounce delay (in ms)
 #define DEBOUNCE_DELAY 200
 
+// Latency trace channel for the single button path
+#define TRACE_CHANNEL 0
+
 // Button ISR
 void button_isr(uint gpio, uint32_t events) {
+    LATENCY_ISR_ENTRY(TRACE_CHANNEL, gpio);
+
     static uint32_t last_interrupt_time = 0;
     uint32_t interrupt_time = to_ms_since_boot(get_absolute_time());
 
     // Debounce: ignore interrupts within DEBOUNCE_DELAY ms
     if (interrupt_time - last_interrupt_time > DEBOUNCE_DELAY) {
         BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-        xSemaphoreGiveFromISR(buttonSemaphore, &xHigherPriorityTaskWoken);
+        // A give that fails (semaphore still given) wakes nobody
+        if (xSemaphoreGiveFromISR(buttonSemaphore, &xHigherPriorityTaskWoken) == pdPASS) {
+            LATENCY_GIVE(TRACE_CHANNEL);
+        } else {
+            LATENCY_COLLAPSED(TRACE_CHANNEL);
+        }
         portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
     }
     last_interrupt_time = interrupt_time;
@@ -34,17 +64,32 @@ void button_isr(uint gpio, uint32_t events) {
 
 // Button task
 void button_task(void *params) {
+    uint32_t presses = 0;
+
     while (1) {
         // Wait for semaphore notification
         if (xSemaphoreTake(buttonSemaphore, portMAX_DELAY)) {
-            printf("Button pressed\n");
+            LATENCY_MARK(TRACE_CHANNEL, LT_TASK_WAKE);
+            DLOG("Button pressed\n");
+
+            // Send command to LED task; an empty pool drops the press
+            LedMessage_t *message = msg_alloc(&ledMessages);
+            if (message == NULL) {
+                LATENCY_DROP(TRACE_CHANNEL);
+                DLOG("No LED message left, press dropped\n");
+                continue;
+            }
+            message->command = 1;
+            message->press = ++presses;
+            message->pressed_us = time_us_64();
 
-            // Send command to LED task
-            uint32_t ledCommand = 1; // Command to toggle the LED
-            if (xQueueSend(ledQueue, &ledCommand, portMAX_DELAY) == pdPASS) {
-                printf("Command sent to LED task\n");
+            if (msg_send(ledQueue, message, portMAX_DELAY) == pdPASS) {
+                LATENCY_MARK(TRACE_CHANNEL, LT_QUEUE_SEND);
+                DLOG("Command sent to LED task\n");
             } else {
-                printf("Failed to send command to LED task\n");
+                msg_free(message);
+                LATENCY_DROP(TRACE_CHANNEL);
+                DLOG("Failed to send command to LED task\n");
             }
         }
     }
@@ -54,12 +99,23 @@ void button_task(void *params) {
 void led_task(void *params) {
     uint32_t ledState = 0;
     while (1) {
-        uint32_t ledCommand;
-        // Wait for command in the queue
-        if (xQueueReceive(ledQueue, &ledCommand, portMAX_DELAY)) {
+        // Wait for command in the queue; the message is ours until msg_free()
+        LedMessage_t *message = msg_receive(ledQueue, portMAX_DELAY);
+        if (message != NULL) {
+            LATENCY_MARK(TRACE_CHANNEL, LT_LED_RECEIVE);
             ledState = !ledState; // Toggle LED state
             gpio_put(LED_PIN, ledState);
-            printf("LED %s\n", ledState ? "on" : "off");
+            LATENCY_MARK(TRACE_CHANNEL, LT_GPIO_PUT);
+
+            uint32_t press = message->press;
+            uint32_t waited_us = (uint32_t) (time_us_64() - message->pressed_us);
+            msg_free(message);
+
+            if (ledState) {
+                DLOG("LED on (press %u, %u us after the button task)\n", press, waited_us);
+            } else {
+                DLOG("LED off (press %u, %u us after the button task)\n", press, waited_us);
+            }
         }
     }
 }
@@ -74,8 +130,9 @@ int main() {
     gpio_pull_up(BUTTON_PIN);
 
     // Create binary semaphore and queue
-    buttonSemaphore = xSemaphoreCreateBinary();
-    ledQueue = xQueueCreate(10, sizeof(uint32_t));
+    buttonSemaphore = rtos_alloc_binary("buttonSemaphore");
+    msg_pool_init(&ledMessages, "ledMessages", ledMessageStorage, sizeof(LedMessage_t), LED_MESSAGES);
+    ledQueue = msg_queue_create("ledQueue", LED_MESSAGES);
 
     // Check if semaphore and queue were created successfully
     if (buttonSemaphore != NULL && ledQueue != NULL) {
@@ -83,8 +140,25 @@ int main() {
         gpio_set_irq_enabled_with_callback(BUTTON_PIN, GPIO_IRQ_EDGE_FALL, true, &button_isr);
 
         // Create tasks
-        xTaskCreate(button_task, "Button Task", 256, NULL, 1, &buttonTaskHandle);
-        xTaskCreate(led_task, "LED Task", 256, NULL, 1, &ledTaskHandle);
+        core_affinity_create(button_task, "Button Task", STACK_BUTTON_TASK, NULL, 1, CORE_ROLE_REALTIME, &buttonTaskHandle);
+        core_affinity_create(led_task, "LED Task", STACK_LED_TASK, NULL, 1, CORE_ROLE_UI, &ledTaskHandle);
+
+        // Deferred logger drains at the lowest application priority
+        dlog_init(tskIDLE_PRIORITY + 1);
+#if LATENCY_TRACE
+        latency_trace_init("binary_semaphore");
+#endif
+
+#if MSG_BENCH
+        msg_bench_init(); // Copying queues against pointer messages, 4 B to 1 KB
+#endif
+
+#if STACK_PROFILE
+        stack_profile_init(); // Stack use of every task
+#endif
+#if RAM_REPORT
+        rtos_alloc_report(); // Memory of each kernel object created so far
+#endif
 
         // Start FreeRTOS scheduler
         vTaskStartScheduler();
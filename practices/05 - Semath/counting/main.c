@@ -4,6 +4,18 @@
 #include "task.h"
 #include "queue.h"
 #include "semphr.h"
+#include "latency_trace.h"
+#include "button_input.h"
+#include "cycle_count.h"
+#include "core_affinity.h"
+#include "rtos_alloc.h"
+#include "runtime_stats.h"
+#include "stack_profile.h"
+#include "stack_sizes.h"
+#include "trace_recorder.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#endif
 
 // LED and button pins
 #define LED1_PIN 15
@@ -15,19 +27,62 @@
 #define LED4_PIN 9
 #define BUTTON4_PIN 8
 
+// One dispatcher task woken by a notification bit per button, straight from
+// the ISR, that also keeps the count of lit LEDs (1), or the original button
+// task, mailbox and LED task per button around a counting semaphore (0)
+#ifndef LED_DISPATCHER
+#define LED_DISPATCHER 1
+#endif
+
+// At most this many LEDs on at the same time
+#define MAX_LEDS_ON 3
+
+#if LED_DISPATCHER
+// Task handle
+TaskHandle_t ledDispatcherHandle;
+#else
 // Task handles and semaphore
 TaskHandle_t buttonTaskHandles[4];
 TaskHandle_t ledTaskHandles[4];
 SemaphoreHandle_t ledSemaphore;
 QueueHandle_t ledQueue[4];
+#endif
+
+// A stack_sizes.h generated from one design lacks the tasks of the other
+#ifndef STACK_LED_DISPATCHER
+#define STACK_LED_DISPATCHER 256
+#endif
+#ifndef STACK_BUTTON_TASK
+#define STACK_BUTTON_TASK 256
+#endif
+#ifndef STACK_LED_TASK
+#define STACK_LED_TASK 256
+#endif
+
+// Kernel RAM of each design, counted the way rtos_alloc counts it
+#define TASKS_DESIGN_BYTES \
+    (4 * ((STACK_BUTTON_TASK + STACK_LED_TASK) * sizeof(StackType_t) + 2 * sizeof(StaticTask_t) \
+          + sizeof(StaticQueue_t) + sizeof(uint32_t)) \
+     + sizeof(StaticSemaphore_t))
+#define DISPATCHER_DESIGN_BYTES (STACK_LED_DISPATCHER * sizeof(StackType_t) + sizeof(StaticTask_t))
 
 // Adjusted debounce delay (in ms)
 #define DEBOUNCE_DELAY 200
 
+// Debounce with per-pin state and a timer per button (1), or the original
+// single timestamp shared by all four buttons (0)
+#ifndef PER_PIN_DEBOUNCE
+#define PER_PIN_DEBOUNCE 1
+#endif
+
 // Function declarations
 void button_isr(uint gpio, uint32_t events);
+#if LED_DISPATCHER
+void led_dispatcher_task(void *params);
+#else
 void button_task(void *params);
 void led_task(void *params);
+#endif
 
 typedef struct {
     uint32_t ledPin;
@@ -43,8 +98,54 @@ ButtonLedConfig buttonLedConfigs[4] = {
     {LED4_PIN, BUTTON4_PIN, 3}
 };
 
+// Presses seen by the button tasks (or the dispatcher) and time spent in the ISR
+uint32_t buttonPresses[4];
+static uint32_t isrCount = 0;
+static uint64_t isrSumNs = 0;
+static uint32_t isrMaxNs = 0;
+
+static void isr_timing_update(uint32_t start) {
+    uint32_t elapsed = cycle_count_elapsed_ns(start, cycle_count_now());
+    isrCount++;
+    isrSumNs += elapsed;
+    if (elapsed > isrMaxNs) {
+        isrMaxNs = elapsed;
+    }
+}
+
+#if PER_PIN_DEBOUNCE
+// Button ISR: the debouncer keeps the state of each pin and confirms on a timer
+void button_isr(uint gpio, uint32_t events) {
+    uint32_t start = cycle_count_now();
+    int i = button_input_find(gpio); // Buttons are added in config order
+
+    TRACE_ISR_ENTER(gpio);
+    if (i >= 0) {
+        LATENCY_ISR_ENTRY(i, gpio);
+        ButtonIrqResult_t result = button_input_handle_irq(gpio, events);
+        if (result == BUTTON_IRQ_DELIVERED) {
+            LATENCY_GIVE(i);
+        } else if (result == BUTTON_IRQ_COLLAPSED) {
+            LATENCY_COLLAPSED(i);
+        }
+    }
+    TRACE_ISR_EXIT(gpio);
+    isr_timing_update(start);
+}
+#else
 // Button ISR
 void button_isr(uint gpio, uint32_t events) {
+    uint32_t start = cycle_count_now();
+
+    TRACE_ISR_ENTER(gpio);
+
+    // One trace channel per button; the entry time is kept until the notify
+    for (int i = 0; i < 4; i++) {
+        if (gpio == buttonLedConfigs[i].buttonPin) {
+            LATENCY_ISR_ENTRY(i, gpio);
+        }
+    }
+
     static uint32_t last_interrupt_time = 0;
     uint32_t interrupt_time = to_ms_since_boot(get_absolute_time());
 
@@ -53,14 +154,108 @@ void button_isr(uint gpio, uint32_t events) {
         for (int i = 0; i < 4; i++) {
             if (gpio == buttonLedConfigs[i].buttonPin) {
                 BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-                vTaskNotifyGiveFromISR(buttonTaskHandles[i], &xHigherPriorityTaskWoken);
+                uint32_t previous;
+                // A press still pending in the notification value wakes nobody
+#if LED_DISPATCHER
+                xTaskNotifyAndQueryFromISR(ledDispatcherHandle, 1u << i, eSetBits, &previous, &xHigherPriorityTaskWoken);
+                bool collapsed = (previous & (1u << i)) != 0;
+#else
+                xTaskNotifyAndQueryFromISR(buttonTaskHandles[i], 0, eIncrement, &previous, &xHigherPriorityTaskWoken);
+                bool collapsed = previous != 0;
+#endif
+                if (collapsed) {
+                    LATENCY_COLLAPSED(i);
+                } else {
+                    LATENCY_GIVE(i);
+                }
                 portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
                 break;
             }
         }
     }
     last_interrupt_time = interrupt_time;
+    TRACE_ISR_EXIT(gpio);
+    isr_timing_update(start);
 }
+#endif
+
+#ifdef PICO_SIM
+// Counts checked by tools/button_storm.py against the injected presses
+static void button_report(void) {
+    printf("{\"debounce\":\"%s\",\"presses\":[%lu,%lu,%lu,%lu],\"isr\":{\"count\":%lu,\"mean_ns\":%lu,\"max_ns\":%lu}}\n",
+           PER_PIN_DEBOUNCE ? "per_pin" : "shared",
+           (unsigned long) buttonPresses[0], (unsigned long) buttonPresses[1],
+           (unsigned long) buttonPresses[2], (unsigned long) buttonPresses[3],
+           (unsigned long) isrCount, (unsigned long) (isrCount ? isrSumNs / isrCount : 0),
+           (unsigned long) isrMaxNs);
+}
+
+// Kernel RAM and context switches (with SWITCH_COUNT = 1) of the LED design;
+// run both builds on the same script and compare the switches per press
+static void led_design_report(void) {
+    uint32_t objects;
+    uint32_t bytes;
+    uint32_t presses = buttonPresses[0] + buttonPresses[1] + buttonPresses[2] + buttonPresses[3];
+    uint32_t switches = runtime_stats_get_switches();
+    uint32_t perPress = presses ? (uint32_t) ((uint64_t) switches * 100 / presses) : 0;
+
+    rtos_alloc_get_totals(&objects, &bytes);
+    printf("{\"led_design\":\"%s\",\"objects\":%lu,\"kernel_bytes\":%lu,\"design_bytes\":%lu,"
+           "\"saved_bytes\":%lu,\"presses\":%lu,\"switches\":%lu,\"switches_per_press\":%lu.%02lu}\n",
+           LED_DISPATCHER ? "dispatcher" : "tasks", (unsigned long) objects, (unsigned long) bytes,
+           (unsigned long) (LED_DISPATCHER ? DISPATCHER_DESIGN_BYTES : TASKS_DESIGN_BYTES),
+           (unsigned long) (TASKS_DESIGN_BYTES - DISPATCHER_DESIGN_BYTES),
+           (unsigned long) presses, (unsigned long) switches,
+           (unsigned long) (perPress / 100), (unsigned long) (perPress % 100));
+}
+#endif
+
+#if LED_DISPATCHER
+// LED dispatcher: bit i of the notification value is a press on button i
+void led_dispatcher_task(void *params) {
+    uint32_t ledStates = 0; // Bit i set while LED i is on
+    uint32_t ledsOn = 0;
+
+    while (1) {
+        // Wait for presses from the ISR; several buttons can arrive together
+        uint32_t pressed;
+        xTaskNotifyWait(0, UINT32_MAX, &pressed, portMAX_DELAY);
+
+        for (int i = 0; i < 4; i++) {
+            uint32_t bit = 1u << i;
+            if ((pressed & bit) == 0) {
+                continue;
+            }
+            // No queue in between: the send and receive stages take no time
+            LATENCY_MARK(i, LT_TASK_WAKE);
+            LATENCY_MARK(i, LT_QUEUE_SEND);
+            LATENCY_MARK(i, LT_LED_RECEIVE);
+            buttonPresses[i]++;
+
+            if ((ledStates & bit) == 0) {
+                // Turn on the LED only if a slot is free
+                if (ledsOn < MAX_LEDS_ON) {
+                    ledsOn++;
+                    ledStates |= bit;
+                    gpio_put(buttonLedConfigs[i].ledPin, 1);
+                    LATENCY_MARK(i, LT_GPIO_PUT);
+                    printf("LED %d ON. Available slots: %d\n", i + 1, (int) (MAX_LEDS_ON - ledsOn));
+                } else {
+                    LATENCY_DROP(i);
+                    printf("Cannot turn on LED %d, no slot free. Available slots: %d\n", i + 1, 0);
+                }
+            } else {
+                // Turn off the LED and free its slot
+                ledsOn--;
+                ledStates &= ~bit;
+                gpio_put(buttonLedConfigs[i].ledPin, 0);
+                LATENCY_MARK(i, LT_GPIO_PUT);
+                printf("LED %d OFF. Available slots: %d\n", i + 1, (int) (MAX_LEDS_ON - ledsOn));
+            }
+        }
+    }
+}
+#else
 
 // Button task
 void button_task(void *params) {
@@ -68,10 +263,13 @@ void button_task(void *params) {
     while (1) {
         // Wait for notification from ISR
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        LATENCY_MARK(config->taskIndex, LT_TASK_WAKE);
+        buttonPresses[config->taskIndex]++;
 
         // Send command to LED task to toggle LED
         uint32_t ledCommand = 1; // Command to toggle the LED
         if (xQueueSend(ledQueue[config->taskIndex], &ledCommand, portMAX_DELAY) == pdPASS) {
+            LATENCY_MARK(config->taskIndex, LT_QUEUE_SEND);
 
               printf("Command sent to LED task %d\n", config->taskIndex + 1);
         }
@@ -86,25 +284,30 @@ void led_task(void *params) {
         uint32_t ledCommand;
         // Wait for command in the queue
         if (xQueueReceive(ledQueue[config->taskIndex], &ledCommand, portMAX_DELAY)) {
+            LATENCY_MARK(config->taskIndex, LT_LED_RECEIVE);
             if (ledState == 0) {
                 // Try to take semaphore to turn on the LED
                 if (xSemaphoreTake(ledSemaphore, 0) == pdTRUE) {
                     ledState = 1;
                     gpio_put(config->ledPin, ledState);
+                    LATENCY_MARK(config->taskIndex, LT_GPIO_PUT);
                     printf("LED %d ON. Available slots: %d\n", config->taskIndex + 1, uxSemaphoreGetCount(ledSemaphore));
                 } else {
+                    LATENCY_DROP(config->taskIndex);
                     printf("Cannot turn on LED %d, semaphore unavailable. Available slots: %d\n", config->taskIndex + 1, uxSemaphoreGetCount(ledSemaphore));
                 }
             } else {
                 // Turn off the LED and release the semaphore
                 ledState = 0;
                 gpio_put(config->ledPin, ledState);
+                LATENCY_MARK(config->taskIndex, LT_GPIO_PUT);
                 xSemaphoreGive(ledSemaphore);
                 printf("LED %d OFF. Available slots: %d\n", config->taskIndex + 1, uxSemaphoreGetCount(ledSemaphore));
             }
         }
     }
 }
+#endif
 
 int main() {
     // Initialize GPIO
@@ -113,34 +316,80 @@ int main() {
         gpio_init(buttonLedConfigs[i].ledPin);
         gpio_set_dir(buttonLedConfigs[i].ledPin, GPIO_OUT);
         gpio_put(buttonLedConfigs[i].ledPin, 0); // Start with LED off
+#if !PER_PIN_DEBOUNCE
         gpio_init(buttonLedConfigs[i].buttonPin);
         gpio_set_dir(buttonLedConfigs[i].buttonPin, GPIO_IN);
         gpio_pull_up(buttonLedConfigs[i].buttonPin);
+#endif
     }
 
+#if LED_DISPATCHER
+    // A single task replaces the eight tasks, four mailboxes and the semaphore
+    core_affinity_create(led_dispatcher_task, "LED Dispatcher", STACK_LED_DISPATCHER, NULL, 2, CORE_ROLE_REALTIME, &ledDispatcherHandle);
+    bool created = ledDispatcherHandle != NULL;
+#else
     // Create counting semaphore with max count of 3 and initial count of 3
-    ledSemaphore = xSemaphoreCreateCounting(3, 3);
+    ledSemaphore = rtos_alloc_counting("ledSemaphore", MAX_LEDS_ON, MAX_LEDS_ON);
 
     // Create queue
+    bool created = ledSemaphore != NULL;
     for (int i = 0; i < 4; i++) {
-        ledQueue[i] = xQueueCreate(1, sizeof(uint32_t));
+        ledQueue[i] = rtos_alloc_queue("ledQueue", 1, sizeof(uint32_t));
+        created = created && ledQueue[i] != NULL;
     }
+#endif
 
-    // Check if semaphore and queues were created successfully
-    if (ledSemaphore != NULL) {
+    // Check if the dispatcher, or the semaphore and queues, were created successfully
+    if (created) {
         // Configure button interrupts
         for (int i = 0; i < 4; i++) {
+#if !PER_PIN_DEBOUNCE
             gpio_set_irq_enabled_with_callback(buttonLedConfigs[i].buttonPin, GPIO_IRQ_EDGE_FALL, true, &button_isr);
+#endif
 
+#if LED_DISPATCHER
+#if PER_PIN_DEBOUNCE
+            // Each press sets the bit of its button in the dispatcher
+            button_input_subscribe(button_input_add(buttonLedConfigs[i].buttonPin, true), ledDispatcherHandle, 1u << i, 0);
+#endif
+#else
             // Create tasks with higher priority for faster response
-            xTaskCreate(button_task, "Button Task", 256, &buttonLedConfigs[i], 2, &buttonTaskHandles[i]);
-            xTaskCreate(led_task, "LED Task", 256, &buttonLedConfigs[i], 2, &ledTaskHandles[i]);
+            core_affinity_create(button_task, "Button Task", STACK_BUTTON_TASK, &buttonLedConfigs[i], 2, CORE_ROLE_REALTIME, &buttonTaskHandles[i]);
+            core_affinity_create(led_task, "LED Task", STACK_LED_TASK, &buttonLedConfigs[i], 2, CORE_ROLE_UI, &ledTaskHandles[i]);
+
+#if PER_PIN_DEBOUNCE
+            // Each press notifies the button task of its own pin
+            button_input_subscribe(button_input_add(buttonLedConfigs[i].buttonPin, true), buttonTaskHandles[i], 1, 0);
+#endif
+#endif
         }
+#if PER_PIN_DEBOUNCE
+        // Take over the shared GPIO callback to time the ISR and trace latency
+        gpio_set_irq_callback(&button_isr);
+#endif
+#ifdef PICO_SIM
+        sim_at_exit(button_report);
+        sim_at_exit(led_design_report);
+#endif
+
+#if LATENCY_TRACE
+        latency_trace_init("task_notify");
+#endif
+#if TRACE_RECORDER
+        trace_recorder_init(); // Kernel trace for tools/trace_to_chrome.py
+#endif
+
+#if STACK_PROFILE
+        stack_profile_init(); // Stack use of every task
+#endif
+#if RAM_REPORT
+        rtos_alloc_report(); // Memory of each kernel object created so far
+#endif
 
         // Start FreeRTOS scheduler
         vTaskStartScheduler();
     } else {
-        printf("Failed to create semaphore or queues\n");
+        printf("Failed to create %s\n", LED_DISPATCHER ? "the LED dispatcher" : "semaphore or queues");
     }
 
     // The program should never reach here
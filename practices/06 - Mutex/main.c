@@ -4,6 +4,18 @@
 #include "semphr.h"
 #include "pico/stdlib.h"
 #include "hardware/adc.h"
+#include "dlog.h"
+#include "mutex_profile.h"
+#include "seqlock.h"
+#include "seqlock_bench.h"
+#include "button_input.h"
+#include "core_affinity.h"
+#include "rtos_alloc.h"
+#include "stack_profile.h"
+#include "stack_sizes.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#endif
 
 #define LED1_PIN 14
 #define LED2_PIN 15
@@ -12,6 +24,38 @@
 #define POTENTIOMETER_PIN 26
 #define LED_TIMEOUT pdMS_TO_TICKS(5000) // 5 segundos
 
+// Mensagens emitidas com o mutex em posse: log diferido (1) ou printf (0)
+#ifndef MUTEX_USE_DLOG
+#define MUTEX_USE_DLOG 1
+#endif
+
+// Versão com posse curta: o mutex protege só a cópia de potentiometerData e a
+// exclusividade dos LEDs fica com um semáforo binário (1), ou o original,
+// com o mutex preso durante todo o LED_TIMEOUT (0, padrão)
+#ifndef MUTEX_SHORT_HOLD
+#define MUTEX_SHORT_HOLD 0
+#endif
+
+// Na versão com posse curta, publicar a leitura por seqlock (1) ou mutex (0)
+#ifndef POTENTIOMETER_SEQLOCK
+#define POTENTIOMETER_SEQLOCK 1
+#endif
+
+// Com posse curta e seqlock nenhuma tarefa trava o mutex, então ele não é criado
+#define MUTEX_LOCKED (!MUTEX_SHORT_HOLD || !POTENTIOMETER_SEQLOCK)
+
+// Botões lidos a cada 100 ms (1, original) ou por interrupção com debounce (0)
+#ifndef BUTTON_POLLING
+#define BUTTON_POLLING 0
+#endif
+#define BUTTON_PRESS_BIT (1u << 0)
+
+#if MUTEX_USE_DLOG
+#define LOG(...) DLOG(__VA_ARGS__)
+#else
+#define LOG(...) printf(__VA_ARGS__)
+#endif
+
 // Estrutura global para armazenar os dados do potenciômetro
 typedef struct {
     uint16_t adc_value;   // Valor lido do potenciômetro
@@ -20,41 +64,230 @@ typedef struct {
 
 // Declaração da variável global
 PotentiometerData_t potentiometerData;
+#if MUTEX_LOCKED
 SemaphoreHandle_t xMutex; // Mutex para garantir exclusão mútua
+#endif
+#if MUTEX_SHORT_HOLD
+SemaphoreHandle_t xLedToken; // Só um LED aceso por vez
+#endif
+SEQLOCK_DEFINE(potentiometerSnapshot, PotentiometerData_t); // Cópia publicada sem trava
+
+TaskHandle_t xLedTaskHandles[2]; // Guardados na criação, sem busca pelo nome
+
+// Quantas vezes as tarefas dos botões acordaram, com ou sem botão pressionado
+volatile uint32_t ulButtonWakeups = 0;
+
+// Espera o próximo pressionar do botão
+static void vWaitButtonPress(uint32_t buttonPin) {
+#if BUTTON_POLLING
+    while (gpio_get(buttonPin) != 0) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+        ulButtonWakeups++;
+    }
+#else
+    uint32_t ulBits = 0;
+    (void) buttonPin;
+    while ((ulBits & BUTTON_PRESS_BIT) == 0) {
+        xTaskNotifyWait(0, BUTTON_PRESS_BIT, &ulBits, portMAX_DELAY);
+        ulButtonWakeups++;
+    }
+#endif
+}
+
+#ifdef PICO_SIM
+// Latência da borda simulada até a ação da tarefa do botão
+static uint32_t ulPresses = 0;
+static uint64_t ullPressSumUs = 0;
+static uint32_t ulPressMaxUs = 0;
+
+static void vRecordPressLatency(uint32_t buttonPin) {
+    uint32_t ulLatency = (uint32_t) (time_us_64() - sim_gpio_edge_time_us(buttonPin));
+
+    ulPresses++;
+    ullPressSumUs += ulLatency;
+    if (ulLatency > ulPressMaxUs) {
+        ulPressMaxUs = ulLatency;
+    }
+}
+
+static void vButtonReport(void) {
+    printf("{\"buttons\":\"%s\",\"wakeups\":%lu,\"presses\":%lu,\"press_to_action_us\":{\"mean\":%lu,\"max\":%lu}}\n",
+           BUTTON_POLLING ? "polling" : "irq", (unsigned long) ulButtonWakeups, (unsigned long) ulPresses,
+           (unsigned long) (ulPresses ? ullPressSumUs / ulPresses : 0), (unsigned long) ulPressMaxUs);
+}
+#define RECORD_PRESS(pin) vRecordPressLatency(pin)
+#else
+#define RECORD_PRESS(pin)
+#endif
+
+// Medição do tempo de posse do mutex e do custo das mensagens dentro dele
+uint32_t ulMaxHoldUs = 0;
+uint32_t ulMaxLogUs = 0;
+
+static void vTimedLogUpdate(uint32_t ulStart) {
+    uint32_t ulElapsed = time_us_32() - ulStart;
+    if (ulElapsed > ulMaxLogUs) {
+        ulMaxLogUs = ulElapsed;
+    }
+}
+
+#if MUTEX_SHORT_HOLD
+#define LED_LOCK xLedToken
+#define LED_LOCK_TAKEN "LEDs reserved"
+#define LED_LOCK_GIVEN "LEDs released"
+
+#if POTENTIOMETER_SEQLOCK
+// Publica uma leitura; os leitores nunca esperam e nunca veem um par misturado
+static void vPublishPotentiometer(uint16_t adcValue, TickType_t xNow) {
+    PotentiometerData_t data = { adcValue, xNow };
+    uint32_t ulWriteStart = time_us_32();
+
+    seqlock_write(&potentiometerSnapshot, &data);
+
+    // Não há trava em posse: é o tempo da escrita, que nenhum leitor espera
+    uint32_t ulWrite = time_us_32() - ulWriteStart;
+    if (ulWrite > ulMaxHoldUs) {
+        ulMaxHoldUs = ulWrite;
+    }
+}
+
+static void vReadPotentiometer(PotentiometerData_t *data) {
+    seqlock_read(&potentiometerSnapshot, data);
+}
+#else
+// Publica uma leitura; o mutex fica preso só durante a cópia
+static void vPublishPotentiometer(uint16_t adcValue, TickType_t xNow) {
+    if (xSemaphoreTake(xMutex, portMAX_DELAY) == pdTRUE) {
+        uint32_t ulHoldStart = time_us_32();
+
+        potentiometerData.adc_value = adcValue;
+        potentiometerData.timestamp = xNow;
+
+        uint32_t ulHeld = time_us_32() - ulHoldStart;
+        xSemaphoreGive(xMutex);
+
+        if (ulHeld > ulMaxHoldUs) {
+            ulMaxHoldUs = ulHeld;
+        }
+    }
+}
+
+static void vReadPotentiometer(PotentiometerData_t *data) {
+    if (xSemaphoreTake(xMutex, portMAX_DELAY) == pdTRUE) {
+        *data = potentiometerData;
+        xSemaphoreGive(xMutex);
+    }
+}
+#endif
+
+// A reserva dos LEDs não é a posse do mutex dos dados, medida na publicação
+static void vReportHold(uint32_t ulHeld) {
+    (void) ulHeld;
+#if POTENTIOMETER_SEQLOCK
+    printf("Seqlock write max %lu us (no lock held), slowest log call %lu us with %s\n",
+           (unsigned long) ulMaxHoldUs, (unsigned long) ulMaxLogUs, MUTEX_USE_DLOG ? "dlog" : "printf");
+#else
+    printf("Mutex held max %lu us per publish, slowest log call %lu us with %s\n",
+           (unsigned long) ulMaxHoldUs, (unsigned long) ulMaxLogUs, MUTEX_USE_DLOG ? "dlog" : "printf");
+#endif
+}
+
+// Consulta o semáforo sem pegá-lo; pdTRUE se os LEDs estão em uso
+static BaseType_t xLedsBusy(uint32_t ledPin) {
+    PotentiometerData_t last;
+
+    if (uxSemaphoreGetCount(xLedToken) != 0) {
+        return pdFALSE;
+    }
+    vReadPotentiometer(&last);
+    printf("Attempt to turn on LED %d failed - LEDs are in use (potentiometer %u at %lu ms)\n",
+           ledPin, last.adc_value, (unsigned long) last.timestamp);
+    return pdTRUE;
+}
+#else
+#define LED_LOCK xMutex
+#define LED_LOCK_TAKEN "Mutex acquired"
+#define LED_LOCK_GIVEN "Mutex released"
+
+// O mutex já está em posse durante toda a seção dos LEDs
+static void vPublishPotentiometer(uint16_t adcValue, TickType_t xNow) {
+    potentiometerData.adc_value = adcValue;
+    potentiometerData.timestamp = xNow;
+}
+
+static void vReportHold(uint32_t ulHeld) {
+    if (ulHeld > ulMaxHoldUs) {
+        ulMaxHoldUs = ulHeld;
+    }
+    printf("Mutex held %lu us (max %lu us), slowest log call %lu us with %s\n",
+           (unsigned long) ulHeld, (unsigned long) ulMaxHoldUs, (unsigned long) ulMaxLogUs,
+           MUTEX_USE_DLOG ? "dlog" : "printf");
+}
+
+// Tenta pegar o mutex sem esperar; pdTRUE se ele está em uso
+static BaseType_t xLedsBusy(uint32_t ledPin) {
+    if (xSemaphoreTake(xMutex, 0) == pdTRUE) {
+        xSemaphoreGive(xMutex); // Libera imediatamente porque apenas queremos verificar o status do mutex
+        return pdFALSE;
+    }
+    printf("Attempt to turn on LED %d failed - Mutex is in use\n", ledPin);
+    return pdTRUE;
+}
+#endif
+
+// Seção feita com LED_LOCK em posse: acende o LED pelo LED_TIMEOUT e, no LED2,
+// lê e publica o potenciômetro a cada 100 ms
+static void vLedHeldSection(uint32_t ledPin) {
+    uint32_t ulLogStart;
+
+    if (ledPin != LED2_PIN) {
+        gpio_put(ledPin, 1); // Liga o LED1
+        vTaskDelay(LED_TIMEOUT); // Espera o timeout do LED
+        gpio_put(ledPin, 0); // Desliga o LED1
+        return;
+    }
+
+    ulLogStart = time_us_32();
+    LOG("LED %d ON - " LED_LOCK_TAKEN "\n", ledPin);
+    vTimedLogUpdate(ulLogStart);
+    gpio_put(ledPin, 1); // Liga o LED
+
+    // Loop para ler o potenciômetro enquanto o LED2 estiver ligado
+    for (TickType_t xStartTime = xTaskGetTickCount();
+         (xTaskGetTickCount() - xStartTime) < LED_TIMEOUT;
+         vTaskDelay(pdMS_TO_TICKS(100))) {
+
+        uint16_t adcValue = adc_read();
+        TickType_t xNow = xTaskGetTickCount();
+        vPublishPotentiometer(adcValue, xNow);
+
+        ulLogStart = time_us_32();
+        LOG("Potentiometer Value: %d at %u ms\n", adcValue, (unsigned) xNow); // Sem %lu, vale para DLOG e printf
+        vTimedLogUpdate(ulLogStart);
+    }
+
+    gpio_put(ledPin, 0); // Desliga o LED
+    ulLogStart = time_us_32();
+    LOG("LED %d OFF - " LED_LOCK_GIVEN "\n", ledPin);
+    vTimedLogUpdate(ulLogStart);
+}
 
 void vLedTask(void *pvParameters) {
     uint32_t ledPin = (uint32_t) pvParameters;
 
     while (1) {
-        // Tenta pegar o mutex para controlar o LED
-        if (xSemaphoreTake(xMutex, portMAX_DELAY) == pdTRUE) {
-            if (ledPin == LED2_PIN) {
-                printf("LED %d ON - Mutex acquired\n", ledPin);
-                gpio_put(ledPin, 1); // Liga o LED
-
-                // Loop para ler o potenciômetro enquanto o LED2 estiver ligado
-                for (TickType_t xStartTime = xTaskGetTickCount();
-                     (xTaskGetTickCount() - xStartTime) < LED_TIMEOUT;
-                     vTaskDelay(pdMS_TO_TICKS(100))) {
-
-                    uint16_t adcValue = adc_read();
-
-                    // Atualiza a estrutura global com o valor lido e o timestamp
-                    potentiometerData.adc_value = adcValue;
-                    potentiometerData.timestamp = xTaskGetTickCount();
-
-                    printf("Potentiometer Value: %d at %lu ms\n", adcValue, potentiometerData.timestamp);
-                }
-
-                gpio_put(ledPin, 0); // Desliga o LED
-                printf("LED %d OFF - Mutex released\n", ledPin);
-            } else {
-                gpio_put(ledPin, 1); // Liga o LED1
-                vTaskDelay(LED_TIMEOUT); // Espera o timeout do LED
-                gpio_put(ledPin, 0); // Desliga o LED1
-            }
-
-            xSemaphoreGive(xMutex); // Libera o mutex
+        // Tenta pegar a trava para controlar o LED
+        if (xSemaphoreTake(LED_LOCK, portMAX_DELAY) == pdTRUE) {
+            uint32_t ulHoldStart = time_us_32();
+
+            vLedHeldSection(ledPin);
+
+            uint32_t ulHeld = time_us_32() - ulHoldStart;
+            xSemaphoreGive(LED_LOCK); // Libera a trava
+            vReportHold(ulHeld);
+#if MUTEX_PROFILE
+            mutex_profile_report();
+#endif
         }
 
         vTaskSuspend(NULL); // Suspende a tarefa até que o botão a reative
@@ -72,19 +305,17 @@ void vButtonTask(void *pvParameters) {
     }
 
     while (1) {
-        // Verifica se o botão foi pressionado
-        if (gpio_get(buttonPin) == 0) {
-            if (xSemaphoreTake(xMutex, 0) == pdFALSE) {
-                printf("Attempt to turn on LED %d failed - Mutex is in use\n", ledPin);
-            } else {
-                xSemaphoreGive(xMutex); // Libera imediatamente porque apenas queremos verificar o status do mutex
-                printf("Button %d pressed - Resuming LED %d task\n", buttonPin, ledPin);
-                vTaskResume(xTaskGetHandle(ledPin == LED1_PIN ? "LedTask1" : "LedTask2"));
-            }
-            vTaskDelay(pdMS_TO_TICKS(500)); // Debounce
-        }
+        // Espera o botão ser pressionado
+        vWaitButtonPress(buttonPin);
+        RECORD_PRESS(buttonPin);
 
-        vTaskDelay(pdMS_TO_TICKS(100));
+        if (xLedsBusy(ledPin) == pdFALSE) {
+            printf("Button %d pressed - Resuming LED %d task\n", buttonPin, ledPin);
+            vTaskResume(xLedTaskHandles[ledPin == LED1_PIN ? 0 : 1]);
+        }
+#if BUTTON_POLLING
+        vTaskDelay(pdMS_TO_TICKS(500)); // Debounce
+#endif
     }
 }
 
@@ -105,6 +336,7 @@ int main() {
     gpio_set_dir(LED2_PIN, GPIO_OUT);
     gpio_put(LED2_PIN, 0); 
 
+#if BUTTON_POLLING
     gpio_init(BUTTON1_PIN);
     gpio_set_dir(BUTTON1_PIN, GPIO_IN);
     gpio_pull_up(BUTTON1_PIN);
@@ -112,18 +344,61 @@ int main() {
     gpio_init(BUTTON2_PIN);
     gpio_set_dir(BUTTON2_PIN, GPIO_IN);
     gpio_pull_up(BUTTON2_PIN);
+#endif
 
+    bool created = true;
+
+#if MUTEX_LOCKED
     // Cria o mutex
-    xMutex = xSemaphoreCreateMutex();
+    xMutex = rtos_alloc_mutex("xMutex");
+    created = created && xMutex != NULL;
+#if MUTEX_PROFILE
+    mutex_profile_name(xMutex, "potentiometer");
+#endif
+#endif
+#if MUTEX_SHORT_HOLD
+    xLedToken = rtos_alloc_binary("xLedToken");
+    if (xLedToken != NULL) {
+        xSemaphoreGive(xLedToken);
+    }
+    created = created && xLedToken != NULL;
+#endif
 
-    if (xMutex != NULL) {
+    if (created) {
         // Cria as tarefas dos LEDs
-        xTaskCreate(vLedTask, "LedTask1", 256, (void *) LED1_PIN, 2, NULL);
-        xTaskCreate(vLedTask, "LedTask2", 256, (void *) LED2_PIN, 2, NULL);
+        core_affinity_create(vLedTask, "LedTask1", STACK_LEDTASK1, (void *) LED1_PIN, 2, CORE_ROLE_UI, &xLedTaskHandles[0]);
+        core_affinity_create(vLedTask, "LedTask2", STACK_LEDTASK2, (void *) LED2_PIN, 2, CORE_ROLE_UI, &xLedTaskHandles[1]);
 
         // Cria as tarefas dos botões
-        xTaskCreate(vButtonTask, "ButtonTask1", 256, (void *) BUTTON1_PIN, 1, NULL);
-        xTaskCreate(vButtonTask, "ButtonTask2", 256, (void *) BUTTON2_PIN, 1, NULL);
+        TaskHandle_t xButtonTask1, xButtonTask2;
+        core_affinity_create(vButtonTask, "ButtonTask1", STACK_BUTTONTASK1, (void *) BUTTON1_PIN, 1, CORE_ROLE_REALTIME, &xButtonTask1);
+        core_affinity_create(vButtonTask, "ButtonTask2", STACK_BUTTONTASK2, (void *) BUTTON2_PIN, 1, CORE_ROLE_REALTIME, &xButtonTask2);
+
+#if !BUTTON_POLLING
+        // Cada pressionar acorda a tarefa do botão por notificação
+        button_input_subscribe(button_input_add(BUTTON1_PIN, true), xButtonTask1, BUTTON_PRESS_BIT, 0);
+        button_input_subscribe(button_input_add(BUTTON2_PIN, true), xButtonTask2, BUTTON_PRESS_BIT, 0);
+#endif
+#ifdef PICO_SIM
+        sim_at_exit(vButtonReport);
+#endif
+
+        // Tarefa que transmite o log diferido
+        dlog_init(tskIDLE_PRIORITY + 1);
+
+#if SEQLOCK_STRESS
+        seqlock_stress_init(1); // Leituras rasgadas sem e com o seqlock
+#endif
+#if SEQLOCK_BENCH
+        seqlock_bench_init(3); // Custo do seqlock contra o mutex
+#endif
+
+#if STACK_PROFILE
+        stack_profile_init(); // Uso de pilha de cada tarefa
+#endif
+#if RAM_REPORT
+        rtos_alloc_report(); // Memória de cada objeto do kernel criado até aqui
+#endif
 
         // Inicia o agendador
         vTaskStartScheduler();
@@ -0,0 +1,14 @@
+#ifndef STACK_SIZES_H
+#define STACK_SIZES_H
+
+// Profundidade da pilha de cada tarefa, em palavras. Ainda não dimensionado:
+// sem uma execução com STACK_PROFILE=1, são os valores que a prática já usava.
+// Para dimensionar a partir de uma:
+//   python3 tools/stack_sizes.py --update "practices/06 - Mutex/stack_sizes.h" saida.txt
+
+#define STACK_BUTTONTASK1 256  // original da prática, não medido
+#define STACK_BUTTONTASK2 256  // original da prática, não medido
+#define STACK_LEDTASK1    256  // original da prática, não medido
+#define STACK_LEDTASK2    256  // original da prática, não medido
+
+#endif
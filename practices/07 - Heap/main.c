@@ -6,21 +6,91 @@
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include <string.h>
+#include "block_pool.h"
+#include "heap_profile.h"
+#include "telemetry.h"
+#include "cycle_count.h"
+#include "core_affinity.h"
+#include "rtos_alloc.h"
+#include "stack_profile.h"
+#include "deadline_monitor.h"
+#include "stack_sizes.h"
+
+#if configSUPPORT_DYNAMIC_ALLOCATION != 1
+#error "A prática do heap precisa de configSUPPORT_DYNAMIC_ALLOCATION = 1"
+#endif
 
 #define LED_PIN 15
 #define HEAP_CONSUMPTION_SIZE 128  // Definindo o tamanho de cada consumo de heap em bytes
+#define HEAP_LIVE_BUFFERS 16       // Buffers mantidos ao mesmo tempo pela tarefa de consumo (pools)
+#define HEAP_MONITOR_DEADLINE_MS 50 // Varredura e impressão dentro disso (DEADLINE_MONITOR = 1)
+
+#ifndef HEAP_USE_POOLS
+#define HEAP_USE_POOLS 0           // 1 = consumo rotativo servido pelos pools de blocos fixos
+#endif
+
+#ifndef HEAP_POOL_BENCH
+#define HEAP_POOL_BENCH 0          // 1 = mede o custo dos pools contra o pvPortMalloc na partida
+#endif
 
 void vHeapMonitorTask(void *pvParameters) {
     const size_t totalHeapSize = configTOTAL_HEAP_SIZE;  // Tamanho total do heap configurado em FreeRTOSConfig.h
     size_t freeHeapSize;
     const size_t heapThreshold = totalHeapSize / 2;  // 50% do tamanho total do heap
 
+#if DEADLINE_MONITOR
+    deadline_monitor_register(1000, HEAP_MONITOR_DEADLINE_MS, NULL);
+#endif
+
     while (1) {
         freeHeapSize = xPortGetFreeHeapSize();  // Obtendo o tamanho livre do heap
-        
+
+#if HEAP_PROFILE
+        // Registro binário com fragmentação, uso por tarefa e pontos de chamada
+        heap_profile_emit();
+#elif !TELEMETRY
         printf("Heap livre: %u bytes\n", freeHeapSize);  // Enviando tamanho livre do heap pela porta serial
+#endif
 
-        if (freeHeapSize < heapThreshold) {
+        // Ocupação de cada classe dos pools; metade dos blocos em uso também acende o LED
+        uint32_t blocksInUse = 0;
+        uint32_t blocksTotal = 0;
+        uint32_t poolFailures = 0;
+#if HEAP_USE_POOLS
+        BlockPoolStats_t stats;
+        for (uint i = 0; block_pool_get_stats(i, &stats); i++) {
+#if !HEAP_PROFILE && !TELEMETRY
+            printf("Pool %3lu B: %lu/%lu em uso, pico %lu, falhas %lu\n",
+                   (unsigned long) stats.block_size, (unsigned long) stats.in_use, (unsigned long) stats.blocks,
+                   (unsigned long) stats.high_water, (unsigned long) stats.failures);
+#endif
+            blocksInUse += stats.in_use;
+            blocksTotal += stats.blocks;
+            poolFailures += stats.failures;
+        }
+#endif
+        (void) poolFailures; // Só vai na telemetria
+#if TELEMETRY && !HEAP_PROFILE
+        TelemetryHeap_t heap = {
+            .total = totalHeapSize,
+            .free = freeHeapSize,
+            .min_ever = xPortGetMinimumEverFreeHeapSize(),
+            .pool_in_use = blocksInUse,
+            .pool_blocks = blocksTotal,
+            .pool_failures = poolFailures,
+            .fallback_in_use = block_pool_fallback_in_use(),
+        };
+        telemetry_heap(&heap);
+#elif !HEAP_PROFILE && HEAP_USE_POOLS
+        printf("Fallback para o heap: %lu em uso, %lu no total\n",
+               (unsigned long) block_pool_fallback_in_use(), (unsigned long) block_pool_fallback_total());
+#endif
+
+#if DEADLINE_MONITOR && !HEAP_PROFILE && !TELEMETRY
+        deadline_monitor_report(); // Respostas desta tarefa até o ciclo anterior
+#endif
+
+        if (freeHeapSize < heapThreshold || blocksInUse > blocksTotal / 2) {
             gpio_put(LED_PIN, 1);  // Acende o LED se o tamanho livre for menor que 50%
         } else {
             gpio_put(LED_PIN, 0);  // Apaga o LED caso contrário
@@ -30,11 +100,35 @@ void vHeapMonitorTask(void *pvParameters) {
     }
 }
 
+#if HEAP_USE_POOLS
+void vHeapConsumptionTask(void *pvParameters) {
+    // Tamanhos variados para passar por todas as classes dos pools
+    static const size_t sizes[] = { HEAP_CONSUMPTION_SIZE, 24, 60, 200, HEAP_CONSUMPTION_SIZE, 256 };
+    void *buffers[HEAP_LIVE_BUFFERS] = { NULL };
+    uint32_t next = 0;
+
+    while (1) {
+        // Libera o buffer mais antigo e aloca outro no lugar
+        void **slot = &buffers[next % HEAP_LIVE_BUFFERS];
+        size_t size = sizes[next % (sizeof(sizes) / sizeof(sizes[0]))];
+        block_pool_free(*slot);
+        *slot = block_pool_alloc(size);
+
+        if (*slot != NULL) {
+            // Simula alguma operação que utiliza a memória alocada
+            memset(*slot, 0, size);
+        }
+        next++;
+
+        vTaskDelay(pdMS_TO_TICKS(50));  // Espera de 50 ms antes de consumir mais heap
+    }
+}
+#else
 void vHeapConsumptionTask(void *pvParameters) {
     while (1) {
         // Aloca memória dinamicamente para consumir o heap
         void *pMem = pvPortMalloc(HEAP_CONSUMPTION_SIZE);
-        
+
         if (pMem != NULL) {
             // Simula alguma operação que utiliza a memória alocada
             memset(pMem, 0, HEAP_CONSUMPTION_SIZE);
@@ -43,6 +137,86 @@ void vHeapConsumptionTask(void *pvParameters) {
         vTaskDelay(pdMS_TO_TICKS(50));  // Espera de 0.5 segundo antes de consumir mais heap
     }
 }
+#endif
+
+#if HEAP_POOL_BENCH
+#define BENCH_ROUNDS 200
+#define BENCH_BATCH 8              // Blocos alocados antes de liberar (cabe na menor classe)
+#define BENCH_FRAGMENTS 64         // Blocos usados para fragmentar o heap antes da medida
+
+typedef struct {
+    uint64_t sum;
+    uint32_t max;
+    uint32_t count;
+} BenchStat_t;
+
+static void bench_add(BenchStat_t *stat, uint32_t ns) {
+    stat->sum += ns;
+    stat->count++;
+    if (ns > stat->max) {
+        stat->max = ns;
+    }
+}
+
+// Mede alloc e free de um tamanho com o escalonador suspenso; as interrupções
+// continuam ligadas, então o máximo inclui o tick quando ele cai na medida
+static void bench_run(const char *name, void *(*alloc)(size_t), void (*release)(void *), size_t size) {
+    BenchStat_t allocStat = { 0 };
+    BenchStat_t freeStat = { 0 };
+    void *blocks[BENCH_BATCH];
+
+    vTaskSuspendAll();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int i = 0; i < BENCH_BATCH; i++) {
+            uint32_t start = cycle_count_now();
+            blocks[i] = alloc(size);
+            bench_add(&allocStat, cycle_count_elapsed_ns(start, cycle_count_now()));
+        }
+        // Libera fora de ordem para o heap_4 precisar juntar blocos vizinhos
+        for (int i = 0; i < BENCH_BATCH; i++) {
+            void *block = blocks[(i * 3) % BENCH_BATCH];
+            uint32_t start = cycle_count_now();
+            release(block);
+            bench_add(&freeStat, cycle_count_elapsed_ns(start, cycle_count_now()));
+        }
+    }
+    xTaskResumeAll();
+
+    printf("{\"bench\":\"%s\",\"size\":%u,\"ops\":%lu,"
+           "\"alloc_ns\":{\"mean\":%lu,\"max\":%lu},\"free_ns\":{\"mean\":%lu,\"max\":%lu}}\n",
+           name, (unsigned) size, (unsigned long) allocStat.count,
+           (unsigned long) (allocStat.sum / allocStat.count), (unsigned long) allocStat.max,
+           (unsigned long) (freeStat.sum / freeStat.count), (unsigned long) freeStat.max);
+}
+
+static void *pool_alloc_no_fallback(size_t size) {
+    return block_pool_alloc_from_isr(size);
+}
+
+// Compara os pools com o pvPortMalloc num heap fragmentado e depois se remove
+void vPoolBenchTask(void *pvParameters) {
+    static const size_t sizes[] = { 32, 64, 128, 256 };
+    void *fragments[BENCH_FRAGMENTS];
+
+    // Deixa buracos de tamanhos variados na lista de livres do heap_4
+    for (int i = 0; i < BENCH_FRAGMENTS; i++) {
+        fragments[i] = pvPortMalloc(16 + (i * 40) % 240);
+    }
+    for (int i = 0; i < BENCH_FRAGMENTS; i += 2) {
+        vPortFree(fragments[i]);
+    }
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench_run("block_pool", pool_alloc_no_fallback, block_pool_free_from_isr, sizes[i]);
+        bench_run("pvPortMalloc", pvPortMalloc, vPortFree, sizes[i]);
+    }
+
+    for (int i = 1; i < BENCH_FRAGMENTS; i += 2) {
+        vPortFree(fragments[i]);
+    }
+    vTaskDelete(NULL);
+}
+#endif
 
 int main() {
     stdio_init_all();  // Inicializa a UART
@@ -50,8 +224,25 @@ int main() {
     gpio_init(LED_PIN);
     gpio_set_dir(LED_PIN, GPIO_OUT);
 
-    xTaskCreate(vHeapMonitorTask, "Heap Monitor", 256, NULL, 1, NULL);  // Tarefa para monitorar o heap
-    xTaskCreate(vHeapConsumptionTask, "Heap Consumer", 256, NULL, 1, NULL);  // Tarefa para consumir o heap
+#if HEAP_USE_POOLS || HEAP_POOL_BENCH
+    block_pool_init();  // Monta os pools de blocos fixos antes das tarefas
+#endif
+#if TELEMETRY
+    telemetry_init(1);  // Registros do monitor em lotes binários
+#endif
+
+    core_affinity_create(vHeapMonitorTask, "Heap Monitor", STACK_HEAP_MONITOR, NULL, 1, CORE_ROLE_UI, NULL);  // Tarefa para monitorar o heap
+    core_affinity_create(vHeapConsumptionTask, "Heap Consumer", STACK_HEAP_CONSUMER, NULL, 1, CORE_ROLE_ANY, NULL);  // Tarefa para consumir o heap
+#if HEAP_POOL_BENCH
+    core_affinity_create(vPoolBenchTask, "Pool Bench", STACK_POOL_BENCH, NULL, 2, CORE_ROLE_ANY, NULL);  // Roda antes das demais e termina
+#endif
+
+#if STACK_PROFILE
+    stack_profile_init(); // Uso de pilha de cada tarefa
+#endif
+#if RAM_REPORT
+    rtos_alloc_report(); // Memória de cada objeto do kernel criado até aqui
+#endif
 
     vTaskStartScheduler();  // Inicia o agendador do FreeRTOS
 
@@ -61,4 +252,3 @@ int main() {
 
     return 0;
 }
-
@@ -0,0 +1,13 @@
+#ifndef STACK_SIZES_H
+#define STACK_SIZES_H
+
+// Profundidade da pilha de cada tarefa, em palavras. Ainda não dimensionado:
+// sem uma execução com STACK_PROFILE=1, são os valores que a prática já usava.
+// Para dimensionar a partir de uma:
+//   python3 tools/stack_sizes.py --update "practices/07 - Heap/stack_sizes.h" saida.txt
+
+#define STACK_HEAP_CONSUMER 256  // original da prática, não medido
+#define STACK_HEAP_MONITOR  256  // original da prática, não medido
+#define STACK_POOL_BENCH    512  // tarefa nova, escolhido à mão, não medido
+
+#endif
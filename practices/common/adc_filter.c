@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include "adc_filter.h"
+#include "cycle_count.h"
+#include "hardware/sync.h"
+#if defined(PICO_SIM) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define ADC_FILTER_TSC 1
+#define ADC_FILTER_SOURCE "tsc"
+#else
+#define ADC_FILTER_TSC 0
+#ifdef PICO_SIM
+#define ADC_FILTER_SOURCE "none"   // Sem contador de ciclos, só ns
+#else
+#define ADC_FILTER_SOURCE "clk_sys"
+#endif
+#endif
+
+void adc_filter_init(AdcFilter_t *filter, uint32_t decimation_log2, uint32_t iir_shift) {
+    filter->decimation_log2 = decimation_log2;
+    filter->iir_shift = iir_shift;
+    filter->sum = 0;
+    filter->pending = 0;
+    filter->state_q16 = 0;
+    filter->primed = false;
+}
+
+// Uma média decimada passa pelo IIR
+static uint16_t filter_step(AdcFilter_t *filter, uint32_t sum) {
+    // sum < 2^(12 + log2), então o deslocamento cabe em 32 bits
+    int32_t mean_q16 = (int32_t) (sum << (16 - filter->decimation_log2));
+
+    if (!filter->primed) {
+        filter->state_q16 = mean_q16;
+        filter->primed = true;
+    } else {
+        filter->state_q16 += (mean_q16 - filter->state_q16) >> filter->iir_shift;
+    }
+    return (uint16_t) ((filter->state_q16 + (1 << 15)) >> 16);
+}
+
+uint32_t adc_filter_process(AdcFilter_t *filter, const uint16_t *samples, uint32_t count, uint16_t *out) {
+    const uint32_t block = 1u << filter->decimation_log2;
+    uint32_t produced = 0;
+    uint32_t i = 0;
+
+    // Completa o bloco que ficou pela metade na chamada anterior
+    while (filter->pending > 0 && i < count) {
+        filter->sum += samples[i++];
+        if (++filter->pending == block) {
+            out[produced++] = filter_step(filter, filter->sum);
+            filter->sum = 0;
+            filter->pending = 0;
+        }
+    }
+
+    // Blocos inteiros: laço sem desvios para o compilador desenrolar
+    while (count - i >= block) {
+        uint32_t sum = 0;
+        for (uint32_t j = 0; j < block; j++) {
+            sum += samples[i + j];
+        }
+        i += block;
+        out[produced++] = filter_step(filter, sum);
+    }
+
+    while (i < count) {
+        filter->sum += samples[i++];
+        filter->pending++;
+    }
+    return produced;
+}
+
+void adc_hysteresis_init(AdcHysteresis_t *detector, uint16_t threshold, uint16_t hysteresis) {
+    detector->high = threshold + hysteresis / 2;
+    detector->low = threshold - hysteresis / 2;
+    detector->above = false;
+}
+
+AdcEvent_t adc_hysteresis_update(AdcHysteresis_t *detector, uint16_t value) {
+    if (!detector->above && value > detector->high) {
+        detector->above = true;
+        return ADC_EVENT_RISE;
+    }
+    if (detector->above && value < detector->low) {
+        detector->above = false;
+        return ADC_EVENT_FALL;
+    }
+    return ADC_EVENT_NONE;
+}
+
+void adc_filter_bench(uint32_t decimation_log2, uint32_t iir_shift) {
+    static uint16_t samples[ADC_FILTER_BENCH_SAMPLES];
+    static uint16_t out[ADC_FILTER_BENCH_BLOCK + 1];
+    AdcFilter_t filter;
+    uint64_t ns = 0;
+    uint64_t cycles = 0;
+    volatile uint32_t sink = 0; // Impede o compilador de descartar o filtro
+
+    // Sinal de teste: rampa com ruído pseudoaleatório de 12 bits
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < ADC_FILTER_BENCH_SAMPLES; i++) {
+        seed = seed * 1103515245u + 12345u;
+        samples[i] = (uint16_t) ((i + (seed >> 20)) & 0xfff);
+    }
+
+    adc_filter_init(&filter, decimation_log2, iir_shift);
+    for (uint32_t round = 0; round < ADC_FILTER_BENCH_ROUNDS; round++) {
+        // Na placa o SysTick só mede trechos menores que um tick: um bloco de DMA
+        // por vez, com as interrupções desligadas para nenhuma ISR entrar na conta
+        for (uint32_t i = 0; i < ADC_FILTER_BENCH_SAMPLES; i += ADC_FILTER_BENCH_BLOCK) {
+            uint32_t status = save_and_disable_interrupts();
+            uint32_t start = cycle_count_now();
+#if ADC_FILTER_TSC
+            uint64_t tsc_start = __rdtsc();
+#endif
+            uint32_t produced = adc_filter_process(&filter, &samples[i], ADC_FILTER_BENCH_BLOCK, out);
+#if ADC_FILTER_TSC
+            cycles += __rdtsc() - tsc_start;
+#endif
+            ns += cycle_count_elapsed_ns(start, cycle_count_now());
+            restore_interrupts(status);
+            sink += produced ? out[produced - 1] : 0;
+        }
+    }
+
+    uint64_t total = (uint64_t) ADC_FILTER_BENCH_SAMPLES * ADC_FILTER_BENCH_ROUNDS;
+#if !ADC_FILTER_TSC && !defined(PICO_SIM)
+    cycles = ns * (clock_get_hz(clk_sys) / 1000000u) / 1000u; // Ciclos do clk_sys
+#endif
+    printf("{\"adc_filter_bench\":{\"decimation\":%lu,\"iir_shift\":%lu,\"samples\":%llu,"
+           "\"ns_per_sample\":%.2f,\"cycles_per_sample\":%.2f,\"source\":\"%s\"}}\n",
+           (unsigned long) (1u << decimation_log2), (unsigned long) iir_shift, (unsigned long long) total,
+           (double) ns / (double) total, (double) cycles / (double) total,
+           ADC_FILTER_SOURCE);
+    (void) sink;
+}
@@ -0,0 +1,63 @@
+#ifndef ADC_FILTER_H
+#define ADC_FILTER_H
+
+/*
+ * Filtro das amostras do ADC em ponto fixo e detector de limiar com histerese.
+ *
+ * O filtro soma blocos de 2^decimation_log2 amostras (média móvel por bloco,
+ * que também faz a decimação) e passa cada média por um IIR de um polo,
+ *   y += (x - y) / 2^iir_shift
+ * com o estado em Q16 para não perder os bits abaixo de 1 LSB. Só inteiros,
+ * sem divisão: o mesmo código roda no Cortex-M0+, que não tem FPU.
+ *
+ * O detector só muda de estado ao passar de threshold + hysteresis/2 subindo
+ * ou de threshold - hysteresis/2 descendo, então ruído em volta do limiar
+ * não gera eventos. Nada aqui usa o FreeRTOS; a prática decide como publicar
+ * os valores e os eventos.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ADC_FILTER_BENCH_SAMPLES 4096
+#define ADC_FILTER_BENCH_ROUNDS  64
+#define ADC_FILTER_BENCH_BLOCK   256   // Amostras por chamada, como um bloco de DMA
+
+typedef struct {
+    uint32_t decimation_log2;
+    uint32_t iir_shift;
+    uint32_t sum;       // Soma do bloco em curso
+    uint32_t pending;   // Amostras já somadas no bloco em curso
+    int32_t state_q16;  // Saída do IIR em Q16
+    bool primed;        // O IIR começa na primeira média, sem subir do zero
+} AdcFilter_t;
+
+typedef enum {
+    ADC_EVENT_NONE,
+    ADC_EVENT_RISE,   // Passou de threshold + hysteresis/2
+    ADC_EVENT_FALL    // Passou de threshold - hysteresis/2
+} AdcEvent_t;
+
+typedef struct {
+    uint16_t high;
+    uint16_t low;
+    bool above;
+} AdcHysteresis_t;
+
+// decimation_log2 de 0 a 16
+void adc_filter_init(AdcFilter_t *filter, uint32_t decimation_log2, uint32_t iir_shift);
+
+// Filtra count amostras e escreve um valor a cada 2^decimation_log2 em out,
+// que precisa de espaço para (count >> decimation_log2) + 1 valores. O bloco
+// incompleto no fim continua na próxima chamada. Retorna quantos valores saíram
+uint32_t adc_filter_process(AdcFilter_t *filter, const uint16_t *samples, uint32_t count, uint16_t *out);
+
+void adc_hysteresis_init(AdcHysteresis_t *detector, uint16_t threshold, uint16_t hysteresis);
+
+AdcEvent_t adc_hysteresis_update(AdcHysteresis_t *detector, uint16_t value);
+
+// Mede o custo do filtro por amostra e imprime uma linha JSON. Chamar de uma
+// tarefa: na placa o SysTick só conta depois do vTaskStartScheduler()
+void adc_filter_bench(uint32_t decimation_log2, uint32_t iir_shift);
+
+#endif
@@ -0,0 +1,156 @@
+#include "FreeRTOS.h"
+#include "hardware/sync.h"
+#include "block_pool.h"
+
+// Bloco livre: o próprio bloco guarda o ponteiro para o próximo
+typedef struct FreeBlock {
+    struct FreeBlock *next;
+} FreeBlock_t;
+
+typedef struct {
+    uint8_t *start;
+    uint8_t *end;
+    FreeBlock_t *free_list;
+    BlockPoolStats_t stats;
+} Pool_t;
+
+#define POOL_STORAGE(size) \
+    static uint8_t storage_##size[BLOCK_POOL_COUNT_##size * size] __attribute__((aligned(8)))
+
+POOL_STORAGE(32);
+POOL_STORAGE(64);
+POOL_STORAGE(128);
+POOL_STORAGE(256);
+
+#define POOL(size) { storage_##size, storage_##size + sizeof(storage_##size), NULL, { size, BLOCK_POOL_COUNT_##size, 0, 0, 0 } }
+
+static Pool_t pools[BLOCK_POOL_CLASSES] = { POOL(32), POOL(64), POOL(128), POOL(256) };
+
+static spin_lock_t *lock;
+static uint32_t fallback_in_use = 0;
+static uint32_t fallback_total = 0;
+
+void block_pool_init(void) {
+    lock = spin_lock_init(spin_lock_claim_unused(true));
+
+    for (int i = 0; i < BLOCK_POOL_CLASSES; i++) {
+        Pool_t *pool = &pools[i];
+        uint32_t size = pool->stats.block_size;
+
+        // Lista em ordem crescente de endereço
+        pool->free_list = NULL;
+        for (uint32_t n = pool->stats.blocks; n > 0; n--) {
+            FreeBlock_t *block = (FreeBlock_t *) (pool->start + (n - 1) * size);
+            block->next = pool->free_list;
+            pool->free_list = block;
+        }
+    }
+}
+
+static Pool_t *class_for(size_t size) {
+    for (int i = 0; i < BLOCK_POOL_CLASSES; i++) {
+        if (size <= pools[i].stats.block_size) {
+            return &pools[i];
+        }
+    }
+    return NULL;
+}
+
+static Pool_t *owner_of(const void *block) {
+    for (int i = 0; i < BLOCK_POOL_CLASSES; i++) {
+        if ((const uint8_t *) block >= pools[i].start && (const uint8_t *) block < pools[i].end) {
+            return &pools[i];
+        }
+    }
+    return NULL;
+}
+
+static void *take(Pool_t *pool) {
+    uint32_t saved = spin_lock_blocking(lock);
+    FreeBlock_t *block = pool->free_list;
+
+    if (block != NULL) {
+        pool->free_list = block->next;
+        if (++pool->stats.in_use > pool->stats.high_water) {
+            pool->stats.high_water = pool->stats.in_use;
+        }
+    } else {
+        pool->stats.failures++;
+    }
+
+    spin_unlock(lock, saved);
+    return block;
+}
+
+static void put(Pool_t *pool, void *block) {
+    uint32_t saved = spin_lock_blocking(lock);
+
+    ((FreeBlock_t *) block)->next = pool->free_list;
+    pool->free_list = (FreeBlock_t *) block;
+    pool->stats.in_use--;
+
+    spin_unlock(lock, saved);
+}
+
+void *block_pool_alloc_from_isr(size_t size) {
+    Pool_t *pool = class_for(size);
+    return pool != NULL ? take(pool) : NULL;
+}
+
+void *block_pool_alloc(size_t size) {
+    void *block = block_pool_alloc_from_isr(size);
+
+#if BLOCK_POOL_FALLBACK && configSUPPORT_DYNAMIC_ALLOCATION == 1
+    if (block == NULL && (block = pvPortMalloc(size)) != NULL) {
+        uint32_t saved = spin_lock_blocking(lock);
+        fallback_in_use++;
+        fallback_total++;
+        spin_unlock(lock, saved);
+    }
+#endif
+    return block;
+}
+
+void block_pool_free_from_isr(void *block) {
+    Pool_t *pool = owner_of(block);
+
+    configASSERT(pool != NULL || block == NULL);
+    if (pool != NULL) {
+        put(pool, block);
+    }
+}
+
+void block_pool_free(void *block) {
+    Pool_t *pool = owner_of(block);
+
+    if (pool != NULL) {
+        put(pool, block);
+    }
+#if configSUPPORT_DYNAMIC_ALLOCATION == 1
+    else if (block != NULL) {
+        vPortFree(block);
+        uint32_t saved = spin_lock_blocking(lock);
+        fallback_in_use--;
+        spin_unlock(lock, saved);
+    }
+#endif
+}
+
+bool block_pool_get_stats(uint index, BlockPoolStats_t *stats) {
+    if (index >= BLOCK_POOL_CLASSES) {
+        return false;
+    }
+
+    uint32_t saved = spin_lock_blocking(lock);
+    *stats = pools[index].stats;
+    spin_unlock(lock, saved);
+    return true;
+}
+
+uint32_t block_pool_fallback_in_use(void) {
+    return fallback_in_use;
+}
+
+uint32_t block_pool_fallback_total(void) {
+    return fallback_total;
+}
@@ -0,0 +1,70 @@
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+/*
+ * Alocador de blocos de tamanho fixo.
+ *
+ * Cada classe (32, 64, 128 e 256 bytes) tem um vetor estático de blocos e
+ * uma lista de livres; alocar e liberar só mexem na cabeça da lista, então o
+ * custo é constante e a memória não fragmenta. A lista é protegida por um
+ * spin lock com as interrupções desligadas, o que vale para os dois cores e
+ * para ISRs.
+ *
+ * block_pool_alloc() usa a menor classe que comporta o pedido. Se ela estiver
+ * vazia (ou o pedido for maior que 256 bytes) e BLOCK_POOL_FALLBACK = 1, o
+ * bloco vem do pvPortMalloc(); block_pool_free() reconhece a origem pelo
+ * endereço. As versões FromISR nunca recorrem ao heap do FreeRTOS.
+ * Sem configSUPPORT_DYNAMIC_ALLOCATION não há fallback.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/types.h"
+
+#ifndef BLOCK_POOL_FALLBACK
+#define BLOCK_POOL_FALLBACK 1
+#endif
+
+// Blocos por classe
+#ifndef BLOCK_POOL_COUNT_32
+#define BLOCK_POOL_COUNT_32  32
+#endif
+#ifndef BLOCK_POOL_COUNT_64
+#define BLOCK_POOL_COUNT_64  32
+#endif
+#ifndef BLOCK_POOL_COUNT_128
+#define BLOCK_POOL_COUNT_128 32
+#endif
+#ifndef BLOCK_POOL_COUNT_256
+#define BLOCK_POOL_COUNT_256 16
+#endif
+
+#define BLOCK_POOL_CLASSES   4
+
+typedef struct {
+    uint32_t block_size;
+    uint32_t blocks;       // total de blocos da classe
+    uint32_t in_use;
+    uint32_t high_water;   // maior in_use já visto
+    uint32_t failures;     // pedidos que acharam a classe vazia
+} BlockPoolStats_t;
+
+// Monta as listas de livres; chamar antes de criar as tarefas
+void block_pool_init(void);
+
+void *block_pool_alloc(size_t size);
+void block_pool_free(void *block);
+
+// Para ISRs: só blocos dos pools, sem fallback
+void *block_pool_alloc_from_isr(size_t size);
+void block_pool_free_from_isr(void *block);
+
+// Estatísticas da classe (0 a BLOCK_POOL_CLASSES - 1)
+bool block_pool_get_stats(uint index, BlockPoolStats_t *stats);
+
+// Pedidos atendidos pelo pvPortMalloc() e ainda não liberados / no total
+uint32_t block_pool_fallback_in_use(void);
+uint32_t block_pool_fallback_total(void);
+
+#endif
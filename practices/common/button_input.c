@@ -0,0 +1,186 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "button_input.h"
+#include "rtos_alloc.h"
+#include "trace_recorder.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#endif
+
+typedef struct {
+    TaskHandle_t task;
+    uint32_t press_bits;
+    uint32_t release_bits;
+} Subscriber_t;
+
+typedef struct {
+    uint pin;
+    bool active_low;
+    volatile bool pressed;   // último estado entregue
+    volatile bool locked;    // janela de debounce aberta
+    uint64_t event_time_us;
+    TimerHandle_t timer;
+    Subscriber_t subscribers[BUTTON_INPUT_MAX_SUBSCRIBERS];
+    uint32_t subscriber_count;
+} Button_t;
+
+static Button_t buttons[BUTTON_INPUT_MAX];
+static uint32_t button_count = 0;
+
+// Pino -> índice + 1 (0 = sem botão), para a ISR não percorrer a lista
+static uint8_t pin_to_button[BUTTON_INPUT_NUM_GPIOS];
+
+static bool read_pressed(const Button_t *button) {
+    return gpio_get(button->pin) != button->active_low;
+}
+
+static uint64_t edge_time_us(const Button_t *button) {
+#ifdef PICO_SIM
+    return sim_gpio_edge_time_us(button->pin);
+#else
+    (void) button;
+    return time_us_64();
+#endif
+}
+
+// Entrega o evento a todos os inscritos; woken = NULL fora de ISR. Devolve
+// quantos não tinham os bits ainda pendentes, ou seja, quantos vão acordar
+static uint32_t deliver(Button_t *button, bool pressed, BaseType_t *woken) {
+    uint32_t fresh = 0;
+
+    button->pressed = pressed;
+    button->event_time_us = edge_time_us(button);
+
+    for (uint32_t i = 0; i < button->subscriber_count; i++) {
+        const Subscriber_t *subscriber = &button->subscribers[i];
+        uint32_t bits = pressed ? subscriber->press_bits : subscriber->release_bits;
+
+        if (bits == 0) {
+            continue;
+        }
+
+        uint32_t previous;
+        if (woken != NULL) {
+            xTaskNotifyAndQueryFromISR(subscriber->task, bits, eSetBits, &previous, woken);
+        } else {
+            xTaskNotifyAndQuery(subscriber->task, bits, eSetBits, &previous);
+        }
+        if ((previous & bits) != bits) {
+            fresh++;
+        }
+    }
+    return fresh;
+}
+
+ButtonIrqResult_t button_input_handle_irq(uint gpio, uint32_t events) {
+    BaseType_t woken = pdFALSE;
+    int index = button_input_find(gpio);
+    ButtonIrqResult_t result = BUTTON_IRQ_NONE;
+
+    (void) events;
+    if (index < 0) {
+        return BUTTON_IRQ_NONE;
+    }
+
+    Button_t *button = &buttons[index];
+#if BUTTON_INPUT_CONFIRM
+    // Cada borda recomeça a janela; o timer decide
+    xTimerResetFromISR(button->timer, &woken);
+#else
+    if (!button->locked) {
+        bool pressed = read_pressed(button);
+        if (pressed != button->pressed) {
+            result = deliver(button, pressed, &woken) > 0 ? BUTTON_IRQ_DELIVERED : BUTTON_IRQ_COLLAPSED;
+            button->locked = true;
+            xTimerResetFromISR(button->timer, &woken);
+        }
+    }
+#endif
+
+    portYIELD_FROM_ISR(woken);
+    return result;
+}
+
+static void button_irq(uint gpio, uint32_t events) {
+    TRACE_ISR_ENTER(gpio);
+    button_input_handle_irq(gpio, events);
+    TRACE_ISR_EXIT(gpio);
+}
+
+// Fim da janela: entrega o que mudou enquanto as bordas eram ignoradas
+static void debounce_timer_callback(TimerHandle_t timer) {
+    Button_t *button = (Button_t *) pvTimerGetTimerID(timer);
+    bool changed;
+
+    taskENTER_CRITICAL();
+    bool pressed = read_pressed(button);
+    changed = pressed != button->pressed;
+    button->locked = changed;
+    taskEXIT_CRITICAL();
+
+    if (changed) {
+        deliver(button, pressed, NULL);
+        xTimerReset(timer, 0);
+    }
+}
+
+int button_input_add(uint pin, bool active_low) {
+    if (button_count == BUTTON_INPUT_MAX || pin >= BUTTON_INPUT_NUM_GPIOS) {
+        return -1;
+    }
+
+    Button_t *button = &buttons[button_count];
+    button->pin = pin;
+    button->active_low = active_low;
+    button->timer = rtos_alloc_timer("Debounce", pdMS_TO_TICKS(BUTTON_INPUT_DEBOUNCE_MS), pdFALSE,
+                                 button, debounce_timer_callback);
+    if (button->timer == NULL) {
+        return -1;
+    }
+
+    gpio_init(pin);
+    gpio_set_dir(pin, GPIO_IN);
+    if (active_low) {
+        gpio_pull_up(pin);
+    } else {
+        gpio_pull_down(pin);
+    }
+    button->pressed = read_pressed(button);
+
+    button_count++;
+    pin_to_button[pin] = (uint8_t) button_count;
+    gpio_set_irq_enabled_with_callback(pin, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, button_irq);
+    return (int) (button_count - 1);
+}
+
+bool button_input_subscribe(int button, TaskHandle_t task, uint32_t press_bits, uint32_t release_bits) {
+    if (button < 0 || (uint32_t) button >= button_count) {
+        return false;
+    }
+
+    Button_t *target = &buttons[button];
+    bool ok = false;
+
+    taskENTER_CRITICAL();
+    if (target->subscriber_count < BUTTON_INPUT_MAX_SUBSCRIBERS) {
+        target->subscribers[target->subscriber_count++] = (Subscriber_t) { task, press_bits, release_bits };
+        ok = true;
+    }
+    taskEXIT_CRITICAL();
+
+    return ok;
+}
+
+int button_input_find(uint pin) {
+    return pin < BUTTON_INPUT_NUM_GPIOS ? (int) pin_to_button[pin] - 1 : -1;
+}
+
+bool button_input_is_pressed(int button) {
+    return buttons[button].pressed;
+}
+
+uint64_t button_input_event_time_us(int button) {
+    return buttons[button].event_time_us;
+}
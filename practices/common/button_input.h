@@ -0,0 +1,73 @@
+#ifndef BUTTON_INPUT_H
+#define BUTTON_INPUT_H
+
+/*
+ * Botões por interrupção com debounce por timer.
+ *
+ * A IRQ do GPIO entrega a primeira borda na hora (debounce na borda de
+ * subida do sinal lógico, sem esperar estabilizar) e abre uma janela de
+ * BUTTON_INPUT_DEBOUNCE_MS em que as demais bordas do pino são ignoradas.
+ * Quando o software timer da janela expira, o nível é lido de novo; se
+ * mudou durante a janela (botão solto antes do fim, por exemplo), o evento
+ * correspondente é entregue e uma nova janela começa.
+ *
+ * Eventos de pressionar e soltar chegam às tarefas inscritas como bits de
+ * notificação (xTaskNotify com eSetBits), então a tarefa dorme em
+ * xTaskNotifyWait() sem nenhum despertar enquanto ninguém aperta nada.
+ *
+ * Com BUTTON_INPUT_CONFIRM = 1 a IRQ não entrega nada: cada borda reinicia
+ * o timer e o evento só sai quando o nível fica estável a janela inteira
+ * (mais imune a ruído, mas com a janela somada à latência). O padrão é 0:
+ * nas práticas as bordas vêm de botões mecânicos, cujo repique só segue um
+ * pressionar de verdade, e o rastreio de latência abre o evento na IRQ, o que
+ * a confirmação não permite (button_input_handle_irq devolve sempre NONE).
+ *
+ * gpio_set_irq_enabled_with_callback() registra um único callback por core.
+ * Uma prática que precise do seu próprio callback instala-o com
+ * gpio_set_irq_callback() depois dos button_input_add() e chama
+ * button_input_handle_irq() de dentro dele.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/types.h"
+
+#define BUTTON_INPUT_MAX              8
+#define BUTTON_INPUT_MAX_SUBSCRIBERS  4
+
+#ifndef BUTTON_INPUT_DEBOUNCE_MS
+#define BUTTON_INPUT_DEBOUNCE_MS      20
+#endif
+
+#ifndef BUTTON_INPUT_CONFIRM
+#define BUTTON_INPUT_CONFIRM          0
+#endif
+
+#define BUTTON_INPUT_NUM_GPIOS        30
+
+// Configura o pino (entrada com pull) e a IRQ; devolve o índice do botão ou -1
+int button_input_add(uint pin, bool active_low);
+
+// Bits de notificação enviados à tarefa a cada pressionar e soltar (0 = ignora)
+bool button_input_subscribe(int button, TaskHandle_t task, uint32_t press_bits, uint32_t release_bits);
+
+bool button_input_is_pressed(int button);
+
+// Índice do botão no pino, ou -1 (tabela direta, pode ser chamada na ISR)
+int button_input_find(uint pin);
+
+typedef enum {
+    BUTTON_IRQ_NONE,       // Borda ignorada ou deixada para o timer
+    BUTTON_IRQ_DELIVERED,  // Evento entregue e algum inscrito notificado de novo
+    BUTTON_IRQ_COLLAPSED   // Evento entregue, mas os bits ainda estavam pendentes
+} ButtonIrqResult_t;
+
+// Tratamento da IRQ; diz o que aconteceu com a borda na hora
+ButtonIrqResult_t button_input_handle_irq(uint gpio, uint32_t events);
+
+// Instante da borda que gerou o último evento (no host, a borda simulada)
+uint64_t button_input_event_time_us(int button);
+
+#endif
@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "core_affinity.h"
+#include "runtime_stats.h"
+#include "rtos_alloc.h"
+
+typedef struct {
+    TaskHandle_t handle;
+    CoreRole_t role;
+} AffinityTask_t;
+
+static AffinityTask_t tasks[CORE_AFFINITY_MAX_TASKS];
+static UBaseType_t task_count = 0;
+
+int core_affinity_core(CoreRole_t role) {
+    switch (role) {
+    case CORE_ROLE_REALTIME:
+        return CORE_AFFINITY_REALTIME_CORE;
+    case CORE_ROLE_UI:
+        return CORE_AFFINITY_UI_CORE;
+    default:
+        return -1;
+    }
+}
+
+BaseType_t core_affinity_create(TaskFunction_t code, const char *name, configSTACK_DEPTH_TYPE stack,
+                                void *params, UBaseType_t priority, CoreRole_t role, TaskHandle_t *handle) {
+    TaskHandle_t created = NULL;
+    int core = core_affinity_core(role);
+    UBaseType_t mask = core < 0 ? tskNO_AFFINITY : (UBaseType_t) 1 << core;
+
+    // Sem SMP a máscara é ignorada
+    BaseType_t result = rtos_alloc_task(code, name, stack, params, priority, mask, &created);
+
+    if (result == pdPASS) {
+        taskENTER_CRITICAL();
+        if (task_count < CORE_AFFINITY_MAX_TASKS) {
+            tasks[task_count].handle = created;
+            tasks[task_count].role = role;
+            task_count++;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    if (handle != NULL) {
+        *handle = created;
+    }
+    return result;
+}
+
+void core_affinity_pin_idle_tasks(void) {
+#if CORE_AFFINITY_SMP
+    // As idles nascem sem afinidade e migram; presas, o tempo de cada uma é o
+    // tempo ocioso do seu núcleo
+    for (BaseType_t i = 0; i < configNUMBER_OF_CORES; i++) {
+        vTaskCoreAffinitySet(xTaskGetIdleTaskHandleForCore(i), (UBaseType_t) 1 << i);
+    }
+#endif
+}
+
+// Tarefas atribuídas a cada núcleo e, sem SMP, o uso projetado de cada um
+static void collect(float usage[CORE_AFFINITY_CORES], uint32_t count[CORE_AFFINITY_CORES]) {
+    float unpinned[CORE_AFFINITY_MAX_TASKS];
+    UBaseType_t unpinned_count = 0;
+
+    for (int c = 0; c < CORE_AFFINITY_CORES; c++) {
+        usage[c] = 0.0f;
+        count[c] = 0;
+    }
+
+    for (UBaseType_t i = 0; i < task_count; i++) {
+        RuntimeStats_t stats;
+        int core = core_affinity_core(tasks[i].role);
+
+        if (!runtime_stats_get_task(tasks[i].handle, &stats)) {
+            continue; // Tarefa deletada ou ainda sem duas amostras
+        }
+        if (core < 0) {
+            unpinned[unpinned_count++] = stats.usage;
+        } else {
+            usage[core] += stats.usage;
+            count[core]++;
+        }
+    }
+
+    // Tarefas sem núcleo vão para o menos carregado, como o escalonador faria
+    for (UBaseType_t i = 0; i < unpinned_count; i++) {
+        int lightest = 0;
+        for (int c = 1; c < CORE_AFFINITY_CORES; c++) {
+            if (usage[c] < usage[lightest]) {
+                lightest = c;
+            }
+        }
+        usage[lightest] += unpinned[i];
+        count[lightest]++;
+    }
+}
+
+bool core_affinity_get_usage(BaseType_t core, CoreUsage_t *usage) {
+    float projected[CORE_AFFINITY_CORES];
+    uint32_t count[CORE_AFFINITY_CORES];
+
+    if (core < 0 || core >= CORE_AFFINITY_CORES) {
+        return false;
+    }
+
+    collect(projected, count);
+    usage->tasks = count[core];
+
+#if CORE_AFFINITY_SMP
+    RuntimeStats_t stats;
+    if (!runtime_stats_get_core(core, &stats)) {
+        return false;
+    }
+    usage->usage = stats.usage;
+    usage->projected = false;
+#else
+    usage->usage = projected[core];
+    usage->projected = true;
+#endif
+    return true;
+}
+
+void core_affinity_report(void) {
+    CoreUsage_t usage[CORE_AFFINITY_CORES];
+    float total = 0.0f;
+    float busiest = 0.0f;
+
+    for (int c = 0; c < CORE_AFFINITY_CORES; c++) {
+        if (!core_affinity_get_usage(c, &usage[c])) {
+            return;
+        }
+        total += usage[c].usage;
+        if (usage[c].usage > busiest) {
+            busiest = usage[c].usage;
+        }
+    }
+
+    printf("{\"cores\":[");
+    for (int c = 0; c < CORE_AFFINITY_CORES; c++) {
+        printf("%s{\"core\":%d,\"usage\":%.2f,\"tasks\":%lu}", c ? "," : "", c,
+               usage[c].usage, (unsigned long) usage[c].tasks);
+    }
+    // Carga total sobre a do núcleo mais ocupado; no host é só a projeção das
+    // cargas atribuídas, não um ganho medido
+    printf("],\"projected\":%s,\"%s\":%.2f}\n", usage[0].projected ? "true" : "false",
+           usage[0].projected ? "projected_balance" : "balance", busiest > 0.0f ? total / busiest : 1.0f);
+}
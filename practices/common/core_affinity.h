@@ -0,0 +1,78 @@
+#ifndef CORE_AFFINITY_H
+#define CORE_AFFINITY_H
+
+/*
+ * Política de afinidade das tarefas nos dois núcleos do RP2040.
+ *
+ * As práticas criam as tarefas com um papel em vez de um núcleo:
+ *   CORE_ROLE_REALTIME  amostragem do ADC e tarefas acordadas por ISR
+ *   CORE_ROLE_UI        LEDs, log, impressão e relatórios
+ *   CORE_ROLE_ANY       o escalonador escolhe o núcleo
+ * Assim uma tarefa de log ou de LED nunca atrasa a que trata a interrupção.
+ *
+ * Build SMP na placa (port RP2040 do FreeRTOS-Kernel V11), no FreeRTOSConfig.h:
+ *   #define configNUMBER_OF_CORES                   2
+ *   #define configUSE_CORE_AFFINITY                 1
+ *   #define configRUN_MULTIPLE_PRIORITIES           1
+ *   #define configTICK_CORE                         0
+ *   #define configUSE_PASSIVE_IDLE_HOOK             0
+ *   #define configTIMER_SERVICE_TASK_CORE_AFFINITY  ( 1 << CORE_AFFINITY_UI_CORE )
+ * A interrupção do DMA do ADC e as de GPIO ficam no núcleo que as habilita,
+ * ou seja, no núcleo da tarefa que chama irq_set_enabled/gpio_set_irq_*.
+ *
+ * Sem SMP (e no host, onde o port POSIX tem um núcleo só) as tarefas são
+ * criadas com xTaskCreate. O relatório então projeta o uso de cada núcleo
+ * somando o tempo de CPU das tarefas atribuídas a ele (runtime_stats), e o
+ * ganho estimado é o tempo total dividido pelo do núcleo mais carregado.
+ */
+
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if configNUMBER_OF_CORES > 1 && configUSE_CORE_AFFINITY == 1
+#define CORE_AFFINITY_SMP 1
+#else
+#define CORE_AFFINITY_SMP 0
+#endif
+
+#ifndef CORE_AFFINITY_REALTIME_CORE
+#define CORE_AFFINITY_REALTIME_CORE 0
+#endif
+#ifndef CORE_AFFINITY_UI_CORE
+#define CORE_AFFINITY_UI_CORE       1
+#endif
+
+#define CORE_AFFINITY_CORES         2  // Núcleos do RP2040, também na projeção do host
+#define CORE_AFFINITY_MAX_TASKS     16
+
+typedef enum {
+    CORE_ROLE_ANY,
+    CORE_ROLE_REALTIME,
+    CORE_ROLE_UI
+} CoreRole_t;
+
+typedef struct {
+    float usage;     // % do núcleo na janela do runtime_stats
+    uint32_t tasks;  // Tarefas atribuídas ao núcleo
+    bool projected;  // true quando somado das tarefas (build sem SMP)
+} CoreUsage_t;
+
+// Cria a tarefa (rtos_alloc) no núcleo do papel; ela entra no relatório por núcleo
+BaseType_t core_affinity_create(TaskFunction_t code, const char *name, configSTACK_DEPTH_TYPE stack,
+                                void *params, UBaseType_t priority, CoreRole_t role, TaskHandle_t *handle);
+
+// Núcleo de um papel, -1 para CORE_ROLE_ANY
+int core_affinity_core(CoreRole_t role);
+
+// Prende cada idle ao seu núcleo para medir o uso por núcleo no SMP;
+// chamar de uma tarefa, depois de vTaskStartScheduler(). Sem SMP não faz nada
+void core_affinity_pin_idle_tasks(void);
+
+// Uso de um núcleo; precisa de runtime_stats_init() antes do escalonador
+bool core_affinity_get_usage(BaseType_t core, CoreUsage_t *usage);
+
+// Uma linha JSON com o uso de cada núcleo e o ganho estimado com dois núcleos
+void core_affinity_report(void);
+
+#endif
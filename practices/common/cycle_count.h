@@ -0,0 +1,40 @@
+#ifndef CYCLE_COUNT_H
+#define CYCLE_COUNT_H
+
+/*
+ * Carimbo de tempo de alta resolução para medir trechos curtos (ISRs,
+ * alocadores). Na placa é o valor do SysTick, que o FreeRTOS faz contar para
+ * baixo no clock do sistema dentro de cada tick, então só vale para trechos
+ * menores que um tick. No host é o CLOCK_MONOTONIC em ns.
+ */
+
+#include <stdint.h>
+
+#ifdef PICO_SIM
+#include <time.h>
+
+static inline uint32_t cycle_count_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t) ((uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+static inline uint32_t cycle_count_elapsed_ns(uint32_t start, uint32_t end) {
+    return end - start;
+}
+#else
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+
+static inline uint32_t cycle_count_now(void) {
+    return systick_hw->cvr;
+}
+
+static inline uint32_t cycle_count_elapsed_ns(uint32_t start, uint32_t end) {
+    uint32_t reload = systick_hw->rvr + 1;
+    uint32_t cycles = (start + reload - end) % reload;
+    return cycles * 1000u / (clock_get_hz(clk_sys) / 1000000u);
+}
+#endif
+
+#endif
@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "deadline_monitor.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#endif
+
+#if DEADLINE_MONITOR
+
+#if configUSE_TRACE_FACILITY != 1
+#error "deadline_monitor precisa de configUSE_TRACE_FACILITY = 1"
+#endif
+
+#define TICK_US (1000000u / configTICK_RATE_HZ)
+
+typedef struct {
+    TaskHandle_t task;
+    DeadlineOverrunHandler_t handler;
+    uint32_t period_ticks;
+    uint32_t deadline_ticks;
+    uint32_t release;           // Tick de liberação do job atual
+    uint32_t next_miss;         // Tick em que o job pendente conta mais uma perda
+    uint32_t release_us;        // Só nas tarefas por evento; nas periódicas vem do tick
+    bool released;              // Por evento: false enquanto espera
+    bool started;
+    bool missed;                // Perda já contada pelo tick
+    DeadlineStats_t stats;
+} MonitoredTask_t;
+
+// Índice = uxTaskNumber - 1
+static MonitoredTask_t monitored[DEADLINE_MONITOR_MAX_TASKS];
+static volatile uint32_t monitored_count = 0;
+#ifdef PICO_SIM
+static bool report_registered = false;
+#endif
+
+// Último tick visto e o instante em que chegou, base das liberações periódicas
+static volatile uint32_t last_tick = 0;
+static volatile uint32_t last_tick_us = 0;
+
+static bool tick_reached(uint32_t tick, uint32_t target) {
+    return (int32_t) (tick - target) >= 0;
+}
+
+static MonitoredTask_t *slot_get(uint32_t slot) {
+    return slot != 0 && slot <= monitored_count ? &monitored[slot - 1] : NULL;
+}
+
+static uint32_t release_time_us(const MonitoredTask_t *m) {
+    if (m->stats.period_us == 0) {
+        return m->release_us;
+    }
+    return last_tick_us - (last_tick - m->release) * TICK_US;
+}
+
+static void mark_start(MonitoredTask_t *m, uint32_t now_us) {
+    uint32_t delay = now_us - release_time_us(m);
+
+    m->started = true;
+    if (delay > m->stats.max_start_us) {
+        m->stats.max_start_us = delay;
+    }
+}
+
+static void count_miss(DeadlineStats_t *stats) {
+    stats->misses++;
+    stats->consecutive_misses++;
+    if (stats->consecutive_misses > stats->max_consecutive_misses) {
+        stats->max_consecutive_misses = stats->consecutive_misses;
+    }
+}
+
+static void release_job(MonitoredTask_t *m, uint32_t release) {
+    m->release = release;
+    m->next_miss = release + m->deadline_ticks;
+    m->missed = false;
+}
+
+// Fecha o job atual; true se ele perdeu o deadline
+static bool close_job(MonitoredTask_t *m, uint32_t now_us) {
+    DeadlineStats_t *stats = &m->stats;
+    uint32_t response = now_us - release_time_us(m);
+    bool missed = m->missed || response > stats->deadline_us;
+
+    stats->jobs++;
+    stats->last_response_us = response;
+    stats->sum_response_us += response;
+    if (response > stats->max_response_us) {
+        stats->max_response_us = response;
+    }
+    if (stats->period_us != 0 && response > stats->period_us) {
+        stats->overruns++;
+    }
+
+    if (!missed) {
+        stats->consecutive_misses = 0;
+    } else if (!m->missed) {
+        count_miss(stats);
+    }
+    return missed;
+}
+
+// Próximo job periódico; se a liberação já passou a tarefa segue sem bloquear
+static void next_job(MonitoredTask_t *m, uint32_t release, uint32_t now_us) {
+    release_job(m, release);
+    m->started = false;
+    if (tick_reached(last_tick, release)) {
+        mark_start(m, now_us);
+    }
+}
+
+static void end_periodic_job(MonitoredTask_t *m, uint32_t release, uint32_t next_release) {
+    DeadlineStats_t stats;
+    bool missed;
+
+    taskENTER_CRITICAL();
+    uint32_t now_us = time_us_32();
+    m->release = release;
+    missed = close_job(m, now_us);
+    next_job(m, next_release, now_us);
+    stats = m->stats;
+    taskEXIT_CRITICAL();
+
+    if (missed && m->handler != NULL) {
+        m->handler(m->task, &stats);
+    }
+}
+
+void deadline_monitor_on_delay_until(uint32_t slot, uint32_t previous_wake, uint32_t increment) {
+    MonitoredTask_t *m = slot_get(slot);
+
+    if (m != NULL && m->stats.period_us != 0) {
+        // O próprio kernel guarda a liberação nominal do job que termina
+        end_periodic_job(m, previous_wake, previous_wake + increment);
+    }
+}
+
+void deadline_monitor_on_delay(uint32_t slot, uint32_t ticks) {
+    MonitoredTask_t *m = slot_get(slot);
+
+    if (m != NULL && m->stats.period_us != 0) {
+        end_periodic_job(m, m->release, xTaskGetTickCount() + ticks);
+    }
+}
+
+void deadline_monitor_on_switch_in(uint32_t slot) {
+    MonitoredTask_t *m = slot_get(slot);
+    uint32_t now_us = time_us_32();
+
+    if (m == NULL || m->started) {
+        return;
+    }
+    if (!m->released) {
+        // Por evento: o job começa quando a tarefa volta a rodar
+        m->released = true;
+        m->release_us = now_us;
+        release_job(m, last_tick);
+    } else if (!tick_reached(last_tick, m->release)) {
+        return; // Trocada de volta antes de bloquear no delay
+    }
+    mark_start(m, now_us);
+}
+
+void deadline_monitor_on_tick(uint32_t tick) {
+    tick++; // O hook vem antes do incremento
+
+    // Com o escalonador suspenso o kernel repete o mesmo tick até ele ser entregue
+    if (tick != last_tick) {
+        last_tick = tick;
+        last_tick_us = time_us_32();
+    }
+
+    // Um job periódico atrasado perde também cada liberação que passa por ele
+    for (uint32_t i = 0; i < monitored_count; i++) {
+        MonitoredTask_t *m = &monitored[i];
+        if (m->released && (!m->missed || m->period_ticks != 0) && tick_reached(tick, m->next_miss)) {
+            count_miss(&m->stats);
+            m->missed = true;
+            m->next_miss += m->period_ticks;
+        }
+    }
+}
+
+bool deadline_monitor_register(uint32_t period_ms, uint32_t deadline_ms, DeadlineOverrunHandler_t handler) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    uint32_t period_ticks = pdMS_TO_TICKS(period_ms);
+    uint32_t deadline_ticks = pdMS_TO_TICKS(deadline_ms);
+    bool registered = false;
+
+    taskENTER_CRITICAL();
+    if (uxTaskGetTaskNumber(task) == 0 && monitored_count < DEADLINE_MONITOR_MAX_TASKS) {
+        MonitoredTask_t *m = &monitored[monitored_count];
+        m->task = task;
+        m->handler = handler;
+        m->period_ticks = period_ms != 0 && period_ticks == 0 ? 1 : period_ticks;
+        m->deadline_ticks = deadline_ticks > 0 ? deadline_ticks : 1;
+        m->release_us = time_us_32();
+        release_job(m, xTaskGetTickCount());
+        m->released = true;
+        m->started = true;
+        m->stats.name = pcTaskGetName(task);
+        m->stats.period_us = period_ms * 1000u;
+        m->stats.deadline_us = deadline_ms * 1000u;
+
+        // Os hooks só enxergam a entrada depois de preenchida
+        monitored_count++;
+        vTaskSetTaskNumber(task, monitored_count);
+        registered = true;
+    }
+    taskEXIT_CRITICAL();
+
+#ifdef PICO_SIM
+    if (registered && !report_registered) {
+        report_registered = sim_at_exit(deadline_monitor_report);
+    }
+#endif
+    return registered;
+}
+
+void deadline_monitor_job_done(void) {
+    MonitoredTask_t *m = slot_get(uxTaskGetTaskNumber(xTaskGetCurrentTaskHandle()));
+    DeadlineStats_t stats;
+    bool missed;
+
+    if (m == NULL || m->stats.period_us != 0) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    missed = close_job(m, time_us_32());
+    m->released = false;
+    m->started = false;
+    stats = m->stats;
+    taskEXIT_CRITICAL();
+
+    if (missed && m->handler != NULL) {
+        m->handler(m->task, &stats);
+    }
+}
+
+bool deadline_monitor_get(TaskHandle_t task, DeadlineStats_t *stats) {
+    MonitoredTask_t *m = slot_get(uxTaskGetTaskNumber(task));
+
+    if (m == NULL) {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    *stats = m->stats;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+void deadline_monitor_report(void) {
+    DeadlineStats_t stats;
+
+    for (uint32_t i = 0; i < monitored_count; i++) {
+        if (!deadline_monitor_get(monitored[i].task, &stats)) {
+            continue;
+        }
+        printf("{\"deadline\":\"%s\",\"period_us\":%lu,\"deadline_us\":%lu,\"jobs\":%lu,\"misses\":%lu,"
+               "\"overruns\":%lu,\"max_consecutive_misses\":%lu,\"response_us\":{\"mean\":%lu,\"max\":%lu},"
+               "\"max_start_us\":%lu}\n",
+               stats.name, (unsigned long) stats.period_us, (unsigned long) stats.deadline_us,
+               (unsigned long) stats.jobs, (unsigned long) stats.misses, (unsigned long) stats.overruns,
+               (unsigned long) stats.max_consecutive_misses,
+               (unsigned long) (stats.jobs ? stats.sum_response_us / stats.jobs : 0),
+               (unsigned long) stats.max_response_us, (unsigned long) stats.max_start_us);
+    }
+}
+
+#endif
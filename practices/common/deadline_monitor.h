@@ -0,0 +1,74 @@
+#ifndef DEADLINE_MONITOR_H
+#define DEADLINE_MONITOR_H
+
+/*
+ * Monitor de deadlines de tarefas periódicas.
+ *
+ * A tarefa se registra com o período e o deadline, e com DEADLINE_MONITOR = 1
+ * o trace_hooks.h acompanha cada job pelos hooks do kernel, sem mudar o laço:
+ * - liberação: o instante em que o xTaskDelayUntil/vTaskDelay anterior a
+ *   acorda (o tick nominal, não quando ela de fato volta a rodar);
+ * - início: a primeira troca para a tarefa depois da liberação;
+ * - conclusão: a entrada no próximo xTaskDelayUntil ou vTaskDelay.
+ * A resposta é conclusão - liberação. Um job que passa do deadline conta como
+ * perda já no tick em que o prazo vence, mesmo que ainda não tenha terminado,
+ * e enquanto não termina cada período que passa conta mais uma (as liberações
+ * que ele engoliu). O tratador de overrun é chamado quando o job termina, na
+ * própria tarefa, antes de ela bloquear. Um job que termina depois da
+ * liberação seguinte é também um overrun do período.
+ *
+ * Tarefas acordadas por eventos (fila, notificação) se registram com período
+ * 0 e chamam DEADLINE_JOB_DONE() antes de voltar a esperar; o job seguinte é
+ * liberado quando ela volta a rodar. A tarefa é marcada pelo uxTaskNumber,
+ * que precisa de configUSE_TRACE_FACILITY = 1.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifndef DEADLINE_MONITOR
+#define DEADLINE_MONITOR 0
+#endif
+
+#define DEADLINE_MONITOR_MAX_TASKS 8
+
+typedef struct {
+    const char *name;
+    uint32_t period_us;              // 0 = tarefa acordada por eventos
+    uint32_t deadline_us;
+    uint32_t jobs;                   // jobs concluídos
+    uint32_t misses;                 // jobs que passaram do deadline, inclusive o em andamento
+    uint32_t overruns;               // jobs concluídos depois da liberação seguinte
+    uint32_t consecutive_misses;
+    uint32_t max_consecutive_misses;
+    uint32_t last_response_us;
+    uint32_t max_response_us;
+    uint64_t sum_response_us;
+    uint32_t max_start_us;           // maior atraso entre a liberação e o início
+} DeadlineStats_t;
+
+// Chamado na tarefa que perdeu o deadline, ao concluir o job
+typedef void (*DeadlineOverrunHandler_t)(TaskHandle_t task, const DeadlineStats_t *stats);
+
+// Registra a tarefa que chama; o job atual é liberado agora. handler pode ser
+// NULL (só contagem). false se a tabela está cheia
+bool deadline_monitor_register(uint32_t period_ms, uint32_t deadline_ms, DeadlineOverrunHandler_t handler);
+
+// Fim do job de uma tarefa registrada com período 0; nas periódicas não faz nada
+void deadline_monitor_job_done(void);
+
+#if DEADLINE_MONITOR
+#define DEADLINE_JOB_DONE() deadline_monitor_job_done()
+#else
+#define DEADLINE_JOB_DONE()
+#endif
+
+// Cópia das estatísticas; false se a tarefa não foi registrada
+bool deadline_monitor_get(TaskHandle_t task, DeadlineStats_t *stats);
+
+// Uma linha JSON por tarefa; no host é chamada ao final da execução
+void deadline_monitor_report(void);
+
+#endif
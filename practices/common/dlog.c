@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "dlog.h"
+#include "core_affinity.h"
+#include "stdio_raw.h"
+#include "stack_profile.h"
+
+#define DLOG_CORES        2
+#define DLOG_MAX_FORMATS  64
+
+// Quadros do modo binário (stdio_raw_frame)
+#define DLOG_FRAME_FORMAT 1  // id (u16) + texto do formato
+#define DLOG_FRAME_RECORD 2  // id (u16), t_us (u32), core (u8), nargs (u8), args (u32 cada)
+#define DLOG_FRAME_DROP   3  // total de registros descartados (u32)
+
+// Buffer de um core; só o próprio core escreve em head e só a tarefa de dreno em tail
+typedef struct {
+    DlogRecord_t records[DLOG_RING_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;
+} DlogRing_t;
+
+static DlogRing_t rings[DLOG_CORES];
+
+void dlog_write(const char *fmt, const uint32_t *args, uint32_t nargs) {
+    uint32_t status = save_and_disable_interrupts();
+    DlogRing_t *ring = &rings[get_core_num()];
+    uint32_t head = ring->head;
+
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= DLOG_RING_SIZE) {
+        ring->dropped++;
+    } else {
+        DlogRecord_t *record = &ring->records[head & (DLOG_RING_SIZE - 1)];
+        record->fmt = fmt;
+        record->timestamp_us = time_us_32();
+        record->core = (uint8_t) get_core_num();
+        record->nargs = (uint8_t) nargs;
+        for (uint32_t i = 0; i < nargs; i++) {
+            record->args[i] = args[i];
+        }
+        __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    }
+
+    restore_interrupts(status);
+}
+
+uint32_t dlog_dropped(void) {
+    uint32_t total = 0;
+    for (int core = 0; core < DLOG_CORES; core++) {
+        total += rings[core].dropped;
+    }
+    return total;
+}
+
+#if DLOG_BINARY
+// Dicionário de formatos já enviados ao host
+static const char *formats[DLOG_MAX_FORMATS];
+static uint16_t format_count = 0;
+
+static void put_u16(uint8_t *out, uint16_t value) {
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+    put_u16(out, (uint16_t) value);
+    put_u16(out + 2, (uint16_t) (value >> 16));
+}
+
+// Retorna o ID do formato, enviando o texto na primeira vez que aparece
+static uint16_t format_id(const char *fmt) {
+    for (uint16_t id = 0; id < format_count; id++) {
+        if (formats[id] == fmt) {
+            return id;
+        }
+    }
+
+    uint8_t payload[255];
+    size_t length = strlen(fmt);
+    if (length > sizeof(payload) - 2) {
+        length = sizeof(payload) - 2;
+    }
+
+    uint16_t id = format_count < DLOG_MAX_FORMATS ? format_count++ : DLOG_MAX_FORMATS - 1;
+    formats[id] = fmt;
+    put_u16(payload, id);
+    memcpy(&payload[2], fmt, length);
+    stdio_raw_frame(DLOG_FRAME_FORMAT, payload, (uint8_t) (length + 2));
+    return id;
+}
+
+static void emit(const DlogRecord_t *record) {
+    uint8_t payload[8 + 4 * DLOG_MAX_ARGS];
+
+    put_u16(payload, format_id(record->fmt));
+    put_u32(&payload[2], record->timestamp_us);
+    payload[6] = record->core;
+    payload[7] = record->nargs;
+    for (uint8_t i = 0; i < record->nargs; i++) {
+        put_u32(&payload[8 + 4 * i], record->args[i]);
+    }
+    stdio_raw_frame(DLOG_FRAME_RECORD, payload, (uint8_t) (8 + 4 * record->nargs));
+}
+
+static void emit_dropped(uint32_t dropped) {
+    uint8_t payload[4];
+    put_u32(payload, dropped);
+    stdio_raw_frame(DLOG_FRAME_DROP, payload, sizeof(payload));
+}
+#else
+static void emit(const DlogRecord_t *record) {
+    // Os formatos usam %d/%u/%x/%c: cada argumento vai como unsigned, do mesmo
+    // tamanho que o int esperado tanto na placa quanto no host de 64 bits
+    const uint32_t *a = record->args;
+    printf(record->fmt, (unsigned) a[0], (unsigned) a[1], (unsigned) a[2],
+           (unsigned) a[3], (unsigned) a[4], (unsigned) a[5]);
+}
+
+static void emit_dropped(uint32_t dropped) {
+    printf("[dlog] %lu records dropped\n", (unsigned long) dropped);
+}
+#endif
+
+// Tarefa que formata e transmite os registros fora do caminho crítico
+static void dlog_drain_task(void *params) {
+    uint32_t reported_drops = 0;
+
+    while (1) {
+#if DLOG_BINARY
+        stdio_raw_begin();
+#endif
+        for (int core = 0; core < DLOG_CORES; core++) {
+            DlogRing_t *ring = &rings[core];
+            uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+            while (ring->tail != head) {
+                DlogRecord_t record = ring->records[ring->tail & (DLOG_RING_SIZE - 1)];
+                __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+                emit(&record);
+            }
+        }
+
+        uint32_t dropped = dlog_dropped();
+        if (dropped != reported_drops) {
+            reported_drops = dropped;
+            emit_dropped(dropped);
+        }
+
+#if DLOG_BINARY
+        stdio_raw_end();
+#else
+        fflush(stdout);
+#endif
+        vTaskDelay(pdMS_TO_TICKS(DLOG_DRAIN_MS));
+    }
+}
+
+BaseType_t dlog_init(UBaseType_t priority) {
+    TaskHandle_t task;
+    BaseType_t result = core_affinity_create(dlog_drain_task, "DlogDrain", 512, NULL, priority, CORE_ROLE_UI, &task);
+
+    if (result == pdPASS) {
+        STACK_PROFILE_OWNER(task, "common");
+    }
+    return result;
+}
@@ -0,0 +1,53 @@
+#ifndef DLOG_H
+#define DLOG_H
+
+/*
+ * Log diferido para tarefas com restrição de tempo.
+ *
+ * DLOG() não formata nada: grava o endereço da string de formato (que serve
+ * de ID), o instante e até DLOG_MAX_ARGS argumentos inteiros num buffer
+ * circular do core atual, com as interrupções desligadas só durante a cópia.
+ * Uma tarefa de baixa prioridade esvazia os buffers e formata as mensagens
+ * (DLOG_BINARY = 0) ou envia os registros crus para serem decodificados no
+ * host por tools/dlog_decode.py (DLOG_BINARY = 1). Se o buffer estiver cheio
+ * o registro é descartado e contado, nunca bloqueia.
+ *
+ * Os argumentos são guardados como uint32_t e impressos como unsigned: use só
+ * formatos inteiros sem modificador de tamanho (%d, %u, %x, %c, nunca %lu) e
+ * strings literais no próprio formato.
+ */
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+#define DLOG_MAX_ARGS     6
+#define DLOG_RING_SIZE    64   // registros por core (potência de 2)
+#define DLOG_DRAIN_MS     10
+
+#ifndef DLOG_BINARY
+#define DLOG_BINARY       0
+#endif
+
+typedef struct {
+    const char *fmt;          // ID da mensagem
+    uint32_t timestamp_us;
+    uint8_t core;
+    uint8_t nargs;
+    uint32_t args[DLOG_MAX_ARGS];
+} DlogRecord_t;
+
+#define DLOG(fmt, ...) do { \
+        const uint32_t dlog_args_[] = { 0, ##__VA_ARGS__ }; \
+        _Static_assert(sizeof(dlog_args_) / sizeof(dlog_args_[0]) - 1 <= DLOG_MAX_ARGS, "too many DLOG arguments"); \
+        dlog_write(fmt, &dlog_args_[1], sizeof(dlog_args_) / sizeof(dlog_args_[0]) - 1); \
+    } while (0)
+
+// Cria a tarefa que esvazia os buffers
+BaseType_t dlog_init(UBaseType_t priority);
+
+void dlog_write(const char *fmt, const uint32_t *args, uint32_t nargs);
+
+// Registros descartados por buffer cheio
+uint32_t dlog_dropped(void);
+
+#endif
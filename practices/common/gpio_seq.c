@@ -0,0 +1,93 @@
+#include "FreeRTOS.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "gpio_seq.h"
+#include "rtos_alloc.h"
+
+#if configUSE_TIMERS != 1
+#error "gpio_seq precisa de configUSE_TIMERS = 1"
+#endif
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+static void apply_step(GpioSequence_t *seq) {
+    const GpioSeqStep_t *step = &seq->steps[seq->step];
+
+    gpio_put_masked(seq->mask, step->level);
+    seq->remaining = step->duration_ms / seq->base_ms;
+}
+
+// Roda na tarefa do timer a cada base_ms
+static void step_callback(TimerHandle_t timer) {
+    GpioSequence_t *seq = pvTimerGetTimerID(timer);
+
+#if WAKE_BENCH
+    wake_stats_mark(&seq->wake);
+#endif
+
+    if (--seq->remaining > 0) {
+        return;
+    }
+
+    if (++seq->step == seq->step_count) {
+        seq->step = 0;
+        seq->rounds++;
+        if (seq->repeats != GPIO_SEQ_FOREVER && seq->rounds == seq->repeats) {
+            gpio_put_masked(seq->mask, 0);
+            xTimerStop(timer, 0);
+            seq->done = true;
+            return;
+        }
+    }
+    apply_step(seq);
+}
+
+bool gpio_seq_start(GpioSequence_t *seq, const char *name, const GpioSeqStep_t *steps,
+                    uint32_t step_count, uint32_t repeats) {
+    uint32_t mask = 0;
+    uint32_t base_ms = 0;
+
+    if (steps == NULL || step_count == 0) {
+        return false;
+    }
+    for (uint32_t i = 0; i < step_count; i++) {
+        if (steps[i].duration_ms == 0) {
+            return false;
+        }
+        mask |= steps[i].level;
+        base_ms = gcd(base_ms, steps[i].duration_ms);
+    }
+    if (pdMS_TO_TICKS(base_ms) == 0) {
+        return false; // Passo menor que um tick
+    }
+
+    *seq = (GpioSequence_t) {
+        .steps = steps,
+        .step_count = step_count,
+        .repeats = repeats,
+        .mask = mask,
+        .base_ms = base_ms,
+    };
+#if WAKE_BENCH
+    wake_stats_init(&seq->wake, name, base_ms);
+#endif
+
+    seq->timer = rtos_alloc_timer(name, pdMS_TO_TICKS(base_ms), pdTRUE, seq, step_callback);
+    if (seq->timer == NULL) {
+        return false;
+    }
+
+    apply_step(seq);
+    return xTimerStart(seq->timer, 0) == pdPASS;
+}
+
+bool gpio_seq_done(const GpioSequence_t *seq) {
+    return seq->done;
+}
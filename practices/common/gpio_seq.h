@@ -0,0 +1,60 @@
+#ifndef GPIO_SEQ_H
+#define GPIO_SEQ_H
+
+/*
+ * Sequenciador de padrões de GPIO sobre um software timer do FreeRTOS.
+ *
+ * O padrão é uma tabela de passos: os pinos em nível alto e a duração de
+ * cada passo. Os pinos da sequência são os que ficam altos em algum passo;
+ * em cada passo os que não estão em level ficam baixos, todos trocados de
+ * uma vez com gpio_put_masked(). Cada sequência usa um timer auto-reload com
+ * período igual ao MDC das durações: o kernel recarrega o timer a partir da
+ * expiração anterior, então os passos não acumulam desvio. Não há tarefa
+ * por padrão; os callbacks rodam na tarefa do timer do kernel, compartilhada
+ * com os outros timers do firmware.
+ *
+ * Com repeats > 0 a sequência dá esse número de voltas, desliga os pinos e
+ * para o timer. As durações precisam ser múltiplos do tick.
+ *
+ * Com WAKE_BENCH = 1 cada expiração do timer é marcada como o acordar de uma
+ * tarefa periódica, com o nome da sequência, e entra no mesmo relatório.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "timers.h"
+#include "wake_bench.h"
+
+#define GPIO_SEQ_FOREVER 0
+
+typedef struct {
+    uint32_t level;        // Máscara dos pinos em nível alto neste passo
+    uint32_t duration_ms;
+} GpioSeqStep_t;
+
+typedef struct {
+    const GpioSeqStep_t *steps;
+    uint32_t step_count;
+    uint32_t repeats;      // Voltas antes de parar; GPIO_SEQ_FOREVER não para
+    uint32_t mask;         // Pinos da sequência
+    uint32_t base_ms;      // Período do timer
+    uint32_t step;         // Passo atual
+    uint32_t remaining;    // Expirações até o fim do passo atual
+    uint32_t rounds;       // Voltas completas
+    volatile bool done;
+    TimerHandle_t timer;
+#if WAKE_BENCH
+    WakeStats_t wake;
+#endif
+} GpioSequence_t;
+
+// Aplica o primeiro passo e inicia o timer; pode ser chamada antes do
+// scheduler. steps precisa continuar válida enquanto a sequência roda
+bool gpio_seq_start(GpioSequence_t *seq, const char *name, const GpioSeqStep_t *steps,
+                    uint32_t step_count, uint32_t repeats);
+
+// A sequência deu todas as voltas e os pinos estão baixos
+bool gpio_seq_done(const GpioSequence_t *seq);
+
+#endif
@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "heap_profile.h"
+#include "stdio_raw.h"
+
+#if HEAP_PROFILE
+
+// Bloco vivo; address NULL = entrada livre
+typedef struct {
+    void *address;
+    uint32_t size;
+    TickType_t allocated_at;
+    uint8_t task;
+    uint8_t site;
+} LiveBlock_t;
+
+static LiveBlock_t live[HEAP_PROFILE_MAX_LIVE];
+static HeapProfileTask_t tasks[HEAP_PROFILE_MAX_TASKS];
+static HeapProfileSite_t sites[HEAP_PROFILE_MAX_SITES];
+static uint32_t task_count = 0;
+static uint32_t site_count = 0;
+static uint32_t untracked = 0;
+
+static uint32_t hash(const void *address) {
+    return ((uint32_t) ((uintptr_t) address >> 3) * 2654435761u) & (HEAP_PROFILE_MAX_LIVE - 1);
+}
+
+// Índice da tarefa atual; a última entrada absorve o excesso
+static uint8_t task_index(void) {
+    void *handle = NULL;
+    const char *name = "startup";
+
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+        handle = xTaskGetCurrentTaskHandle();
+        name = pcTaskGetName(handle);
+    }
+
+    for (uint32_t i = 0; i < task_count; i++) {
+        if (tasks[i].handle == handle && strncmp(tasks[i].name, name, HEAP_PROFILE_NAME_LEN) == 0) {
+            return (uint8_t) i;
+        }
+    }
+    if (task_count == HEAP_PROFILE_MAX_TASKS) {
+        return HEAP_PROFILE_MAX_TASKS - 1;
+    }
+
+    HeapProfileTask_t *task = &tasks[task_count];
+    task->handle = handle;
+    strncpy(task->name, name, HEAP_PROFILE_NAME_LEN - 1);
+    return (uint8_t) task_count++;
+}
+
+static uint8_t site_index(void *caller) {
+    for (uint32_t i = 0; i < site_count; i++) {
+        if (sites[i].caller == (uintptr_t) caller) {
+            return (uint8_t) i;
+        }
+    }
+    if (site_count == HEAP_PROFILE_MAX_SITES) {
+        return HEAP_PROFILE_MAX_SITES - 1;
+    }
+
+    sites[site_count].caller = (uintptr_t) caller;
+    return (uint8_t) site_count++;
+}
+
+void heap_profile_on_malloc(void *block, size_t size, void *caller) {
+    HeapProfileTask_t *task = &tasks[task_index()];
+
+    if (block == NULL) {
+        task->failures++;
+        return;
+    }
+
+    uint8_t site = site_index(caller);
+    task->allocs++;
+    task->bytes_allocated += size;
+    task->bytes_live += size;
+    if (task->bytes_live > task->bytes_peak) {
+        task->bytes_peak = task->bytes_live;
+    }
+    sites[site].allocs++;
+    sites[site].live++;
+    sites[site].bytes_live += size;
+
+    // Sondagem linear a partir do hash do endereço
+    uint32_t slot = hash(block);
+    for (uint32_t probe = 0; probe < HEAP_PROFILE_MAX_LIVE; probe++) {
+        LiveBlock_t *entry = &live[(slot + probe) & (HEAP_PROFILE_MAX_LIVE - 1)];
+        if (entry->address == NULL) {
+            entry->address = block;
+            entry->size = size;
+            entry->allocated_at = xTaskGetTickCount();
+            entry->task = (uint8_t) (task - tasks);
+            entry->site = site;
+            return;
+        }
+    }
+    untracked++;
+}
+
+// Remove a entrada puxando para trás as que colidiram depois dela
+static void remove_entry(uint32_t hole) {
+    uint32_t next = hole;
+
+    while (1) {
+        next = (next + 1) & (HEAP_PROFILE_MAX_LIVE - 1);
+        if (live[next].address == NULL) {
+            break;
+        }
+        uint32_t home = hash(live[next].address);
+        // A entrada pode ocupar o buraco se a sua posição ideal não está entre ele e ela
+        if (((next - home) & (HEAP_PROFILE_MAX_LIVE - 1)) >= ((next - hole) & (HEAP_PROFILE_MAX_LIVE - 1))) {
+            live[hole] = live[next];
+            hole = next;
+        }
+    }
+    live[hole].address = NULL;
+}
+
+void heap_profile_on_free(void *block, size_t size) {
+    uint32_t slot = hash(block);
+
+    for (uint32_t probe = 0; probe < HEAP_PROFILE_MAX_LIVE; probe++) {
+        uint32_t index = (slot + probe) & (HEAP_PROFILE_MAX_LIVE - 1);
+        LiveBlock_t *entry = &live[index];
+
+        if (entry->address == NULL) {
+            return; // Alocado quando a tabela estava cheia
+        }
+        if (entry->address == block) {
+            HeapProfileTask_t *task = &tasks[entry->task];
+            HeapProfileSite_t *site = &sites[entry->site];
+            TickType_t lifetime_ms = (xTaskGetTickCount() - entry->allocated_at) * portTICK_PERIOD_MS;
+            uint32_t bucket = 0;
+
+            while (bucket < HEAP_PROFILE_LIFETIME_BUCKETS - 1 && lifetime_ms >= (1u << bucket)) {
+                bucket++;
+            }
+            task->lifetime[bucket]++;
+            task->frees++;
+            task->bytes_live -= entry->size;
+            site->live--;
+            site->bytes_live -= entry->size;
+
+            remove_entry(index);
+            return;
+        }
+    }
+    (void) size;
+}
+
+uint32_t heap_profile_untracked(void) {
+    return untracked;
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t) (value >> (8 * i));
+    }
+}
+
+void heap_profile_emit(void) {
+    static HeapProfileTask_t task_copy[HEAP_PROFILE_MAX_TASKS];
+    static HeapProfileSite_t site_copy[HEAP_PROFILE_MAX_SITES];
+    uint8_t payload[16 + 6 * 4 + 2 * HEAP_PROFILE_LIFETIME_BUCKETS];
+    HeapStats_t heap;
+    uint32_t tasks_seen, sites_seen;
+
+    // Cópia com o escalonador suspenso, como o heap_4 faz ao chamar os hooks
+    vTaskSuspendAll();
+    memcpy(task_copy, tasks, sizeof(tasks));
+    memcpy(site_copy, sites, sizeof(sites));
+    tasks_seen = task_count;
+    sites_seen = site_count;
+    xTaskResumeAll();
+
+    vPortGetHeapStats(&heap);
+    const uint32_t heap_fields[] = {
+        xTaskGetTickCount() * portTICK_PERIOD_MS,
+        configTOTAL_HEAP_SIZE,
+        heap.xAvailableHeapSpaceInBytes,
+        heap.xMinimumEverFreeBytesRemaining,
+        heap.xSizeOfLargestFreeBlockInBytes,
+        heap.xSizeOfSmallestFreeBlockInBytes,
+        heap.xNumberOfFreeBlocks,
+        heap.xNumberOfSuccessfulAllocations,
+        heap.xNumberOfSuccessfulFrees,
+        untracked
+    };
+    for (uint32_t i = 0; i < sizeof(heap_fields) / sizeof(heap_fields[0]); i++) {
+        put_u32(&payload[4 * i], heap_fields[i]);
+    }
+    stdio_raw_begin();
+    stdio_raw_frame(HEAP_PROFILE_FRAME_HEAP, payload, sizeof(heap_fields));
+
+    for (uint32_t i = 0; i < tasks_seen; i++) {
+        const HeapProfileTask_t *task = &task_copy[i];
+        memcpy(payload, task->name, 16);
+        put_u32(&payload[16], task->allocs);
+        put_u32(&payload[20], task->frees);
+        put_u32(&payload[24], task->failures);
+        put_u32(&payload[28], task->bytes_allocated);
+        put_u32(&payload[32], task->bytes_live);
+        put_u32(&payload[36], task->bytes_peak);
+        for (uint32_t b = 0; b < HEAP_PROFILE_LIFETIME_BUCKETS; b++) {
+            payload[40 + 2 * b] = (uint8_t) task->lifetime[b];
+            payload[41 + 2 * b] = (uint8_t) (task->lifetime[b] >> 8);
+        }
+        stdio_raw_frame(HEAP_PROFILE_FRAME_TASK, payload, sizeof(payload));
+    }
+
+    for (uint32_t i = 0; i < sites_seen; i++) {
+        const HeapProfileSite_t *site = &site_copy[i];
+        put_u32(&payload[0], (uint32_t) site->caller);
+        put_u32(&payload[4], site->allocs);
+        put_u32(&payload[8], site->live);
+        put_u32(&payload[12], site->bytes_live);
+        stdio_raw_frame(HEAP_PROFILE_FRAME_SITE, payload, 16);
+    }
+    stdio_raw_end();
+}
+
+#endif
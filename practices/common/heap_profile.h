@@ -0,0 +1,64 @@
+#ifndef HEAP_PROFILE_H
+#define HEAP_PROFILE_H
+
+/*
+ * Profiler de alocações do heap do FreeRTOS.
+ *
+ * Com HEAP_PROFILE = 1 o trace_hooks.h liga traceMALLOC/traceFREE a este
+ * módulo. Cada bloco vivo fica numa tabela com tamanho, instante, tarefa e
+ * ponto de chamada; no free o tempo de vida entra no histograma da tarefa
+ * que alocou. Por ponto de chamada ficam as alocações e os blocos ainda
+ * vivos, que é onde um vazamento aparece: o número só cresce.
+ *
+ * heap_profile_emit() escreve tudo em quadros binários no stdout, com o mesmo
+ * enquadramento do dlog (0xD1 0x06, tipo, tamanho) para que os dois possam
+ * dividir a serial; tools/heap_decode.py converte para texto. Inteiros em
+ * little-endian:
+ *   0x10 heap:  t_ms, configTOTAL_HEAP_SIZE, livre, mínimo já visto, maior
+ *               bloco livre, menor bloco livre, blocos livres, alocações,
+ *               frees, não rastreados (u32)
+ *   0x11 task:  nome (16 bytes), alocações, frees, falhas, bytes alocados,
+ *               bytes vivos, pico de bytes vivos (u32), histograma do tempo
+ *               de vida (u16 cada, bucket i: < 2^i ms)
+ *   0x12 site:  endereço de retorno, alocações, blocos vivos, bytes vivos (u32)
+ */
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+#define HEAP_PROFILE_MAX_LIVE          256  // blocos vivos rastreados (potência de 2)
+#define HEAP_PROFILE_MAX_TASKS         16
+#define HEAP_PROFILE_MAX_SITES         32
+#define HEAP_PROFILE_NAME_LEN          16
+#define HEAP_PROFILE_LIFETIME_BUCKETS  12
+
+#define HEAP_PROFILE_FRAME_HEAP  0x10
+#define HEAP_PROFILE_FRAME_TASK  0x11
+#define HEAP_PROFILE_FRAME_SITE  0x12
+
+typedef struct {
+    void *handle;                  // NULL = antes do escalonador
+    char name[HEAP_PROFILE_NAME_LEN];
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t failures;
+    uint32_t bytes_allocated;
+    uint32_t bytes_live;
+    uint32_t bytes_peak;
+    uint16_t lifetime[HEAP_PROFILE_LIFETIME_BUCKETS];
+} HeapProfileTask_t;
+
+typedef struct {
+    uintptr_t caller;
+    uint32_t allocs;
+    uint32_t live;
+    uint32_t bytes_live;
+} HeapProfileSite_t;
+
+// Escreve o estado do heap, as tarefas e os pontos de chamada (quadros binários)
+void heap_profile_emit(void);
+
+// Blocos que não couberam na tabela e ficaram fora das estatísticas
+uint32_t heap_profile_untracked(void);
+
+#endif
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "pico/stdlib.h"
+#include "latency_trace.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#endif
+
+typedef struct {
+    uint32_t t[LT_STAGES];
+} LatencyEvent_t;
+
+typedef struct {
+    LatencyEvent_t events[LATENCY_TRACE_EVENTS];
+    uint32_t opened;              // eventos abertos pelo give
+    uint32_t next[LT_STAGES];     // próximo evento a receber cada etapa
+    uint32_t pending_edge;        // borda e entrada da ISR ainda sem give
+    uint32_t pending_entry;
+} LatencyChannel_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t histogram[LATENCY_TRACE_BUCKETS];
+} LatencyDist_t;
+
+static const char *const stage_names[LT_STAGES] = {
+    "edge", "isr_entry", "give", "task_wake", "queue_send", "led_receive", "gpio_put"
+};
+
+static const char *trace_mechanism = "";
+static LatencyChannel_t channels[LATENCY_TRACE_CHANNELS];
+static LatencyDist_t stage_dist[LT_STAGES];   // etapa s: t[s] - t[s - 1]
+static LatencyDist_t total_dist;              // borda -> gpio_put
+static uint32_t completed = 0;
+static uint32_t dropped = 0;
+static uint32_t collapsed = 0;
+static uint32_t overflowed = 0;
+
+static void dist_add(LatencyDist_t *dist, uint32_t value) {
+    uint32_t bucket = 0;
+
+    if (dist->count == 0 || value < dist->min) {
+        dist->min = value;
+    }
+    if (value > dist->max) {
+        dist->max = value;
+    }
+    dist->sum += value;
+    dist->count++;
+
+    while (bucket < LATENCY_TRACE_BUCKETS - 1 && value >= (1u << bucket)) {
+        bucket++;
+    }
+    dist->histogram[bucket]++;
+}
+
+void latency_trace_init(const char *mechanism) {
+    trace_mechanism = mechanism;
+#ifdef PICO_SIM
+    sim_at_exit(latency_trace_report);
+#endif
+}
+
+void latency_trace_isr_entry(uint channel, uint gpio) {
+    LatencyChannel_t *ch = &channels[channel];
+    uint32_t now = time_us_32();
+
+    ch->pending_entry = now;
+#ifdef PICO_SIM
+    ch->pending_edge = (uint32_t) sim_gpio_edge_time_us(gpio);
+#else
+    (void) gpio;
+    ch->pending_edge = now;
+#endif
+}
+
+void latency_trace_give(uint channel) {
+    LatencyChannel_t *ch = &channels[channel];
+    LatencyEvent_t *event = &ch->events[ch->opened & (LATENCY_TRACE_EVENTS - 1)];
+
+    event->t[LT_EDGE] = ch->pending_edge;
+    event->t[LT_ISR_ENTRY] = ch->pending_entry;
+    event->t[LT_GIVE] = time_us_32();
+    ch->opened++;
+}
+
+void latency_trace_collapsed(uint channel) {
+    (void) channel;
+    collapsed++;
+    dropped++;
+}
+
+static void complete(const LatencyEvent_t *event) {
+    for (int stage = LT_ISR_ENTRY; stage < LT_STAGES; stage++) {
+        dist_add(&stage_dist[stage], event->t[stage] - event->t[stage - 1]);
+    }
+    dist_add(&total_dist, event->t[LT_GPIO_PUT] - event->t[LT_EDGE]);
+    completed++;
+
+#ifndef PICO_SIM
+    if (completed % LATENCY_TRACE_REPORT_EVERY == 0) {
+        latency_trace_report();
+    }
+#endif
+}
+
+// Índice do evento que deve receber a etapa, descartando os que já foram sobrescritos
+static int32_t claim(LatencyChannel_t *ch, LatencyStage_t stage) {
+    uint32_t index = ch->next[stage];
+
+    if (index >= ch->opened) {
+        return -1; // Nenhum evento aberto esperando esta etapa
+    }
+    if (ch->opened - index > LATENCY_TRACE_EVENTS) {
+        overflowed += ch->opened - LATENCY_TRACE_EVENTS - index;
+        index = ch->opened - LATENCY_TRACE_EVENTS;
+    }
+    ch->next[stage] = index + 1;
+    return (int32_t) (index & (LATENCY_TRACE_EVENTS - 1));
+}
+
+void latency_trace_mark(uint channel, LatencyStage_t stage) {
+    LatencyChannel_t *ch = &channels[channel];
+    int32_t slot = claim(ch, stage);
+
+    if (slot >= 0) {
+        ch->events[slot].t[stage] = time_us_32();
+        if (stage == LT_GPIO_PUT) {
+            complete(&ch->events[slot]);
+        }
+    }
+}
+
+void latency_trace_drop(uint channel) {
+    LatencyChannel_t *ch = &channels[channel];
+
+    if (claim(ch, LT_GPIO_PUT) < 0) {
+        return;
+    }
+
+    // As etapas que o evento descartado não alcançou passam para o seguinte
+    for (int stage = LT_TASK_WAKE; stage < LT_GPIO_PUT; stage++) {
+        if (ch->next[stage] < ch->next[LT_GPIO_PUT]) {
+            ch->next[stage] = ch->next[LT_GPIO_PUT];
+        }
+    }
+    dropped++;
+}
+
+static void print_dist(const char *name, const LatencyDist_t *dist) {
+    printf("\"%s\":{\"min\":%lu,\"mean\":%lu,\"max\":%lu,\"histogram_log2_us\":[",
+           name, (unsigned long) dist->min,
+           (unsigned long) (dist->count ? dist->sum / dist->count : 0),
+           (unsigned long) dist->max);
+    for (int i = 0; i < LATENCY_TRACE_BUCKETS; i++) {
+        printf("%s%lu", i ? "," : "", (unsigned long) dist->histogram[i]);
+    }
+    printf("]}");
+}
+
+void latency_trace_report(void) {
+    printf("{\"mechanism\":\"%s\",\"events\":%lu,\"dropped\":%lu,\"collapsed\":%lu,\"overflowed\":%lu,",
+           trace_mechanism, (unsigned long) completed, (unsigned long) dropped, (unsigned long) collapsed,
+           (unsigned long) overflowed);
+    print_dist("edge_to_led_us", &total_dist);
+    printf(",\"stages_us\":{");
+    for (int stage = LT_ISR_ENTRY; stage < LT_STAGES; stage++) {
+        if (stage > LT_ISR_ENTRY) {
+            printf(",");
+        }
+        print_dist(stage_names[stage], &stage_dist[stage]);
+    }
+    printf("}}\n");
+}
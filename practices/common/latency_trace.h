@@ -0,0 +1,79 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+/*
+ * Rastreamento da latência borda -> LED nos caminhos de interrupção dos botões.
+ *
+ * Cada pressionamento aceito vira um evento com o instante de cada etapa:
+ * borda no pino, entrada na ISR, give/notify, tarefa acordada, envio na fila,
+ * recebimento pela tarefa do LED e gpio_put. As etapas depois do give são
+ * associadas ao evento mais antigo do mesmo canal que ainda não passou por
+ * elas, então eventos enfileirados continuam alinhados.
+ *
+ * No host o instante da borda vem do GPIO simulado; na placa a borda não é
+ * observável e vale o instante de entrada na ISR.
+ *
+ * Com LATENCY_TRACE = 1 as macros registram; o relatório (JSON com a
+ * distribuição de cada etapa e do total) sai ao final da execução no host ou
+ * a cada LATENCY_TRACE_REPORT_EVERY eventos na placa.
+ */
+
+#include <stdint.h>
+#include "pico/types.h"
+
+#ifndef LATENCY_TRACE
+#define LATENCY_TRACE 0
+#endif
+
+#define LATENCY_TRACE_CHANNELS      4
+#define LATENCY_TRACE_EVENTS        16   // eventos em voo por canal (potência de 2)
+#define LATENCY_TRACE_BUCKETS       20   // bucket i: latência < 2^i µs
+#define LATENCY_TRACE_REPORT_EVERY  20
+
+typedef enum {
+    LT_EDGE,
+    LT_ISR_ENTRY,
+    LT_GIVE,
+    LT_TASK_WAKE,
+    LT_QUEUE_SEND,
+    LT_LED_RECEIVE,
+    LT_GPIO_PUT,
+    LT_STAGES
+} LatencyStage_t;
+
+// mechanism identifica o caminho no relatório (ex.: "binary_semaphore")
+void latency_trace_init(const char *mechanism);
+
+// ISR: entrada, com o pino que disparou
+void latency_trace_isr_entry(uint channel, uint gpio);
+
+// ISR: o give/notify foi feito; abre o evento
+void latency_trace_give(uint channel);
+
+// ISR: o give/notify não acorda ninguém (semáforo já dado ou notificação
+// ainda pendente); a borda conta como descartada e não abre evento
+void latency_trace_collapsed(uint channel);
+
+// Demais etapas, em ordem
+void latency_trace_mark(uint channel, LatencyStage_t stage);
+
+// O evento mais antigo do canal terminou sem gpio_put (ex.: LED recusado)
+void latency_trace_drop(uint channel);
+
+void latency_trace_report(void);
+
+#if LATENCY_TRACE
+#define LATENCY_ISR_ENTRY(channel, gpio) latency_trace_isr_entry(channel, gpio)
+#define LATENCY_GIVE(channel)            latency_trace_give(channel)
+#define LATENCY_COLLAPSED(channel)       latency_trace_collapsed(channel)
+#define LATENCY_MARK(channel, stage)     latency_trace_mark(channel, stage)
+#define LATENCY_DROP(channel)            latency_trace_drop(channel)
+#else
+#define LATENCY_ISR_ENTRY(channel, gpio)
+#define LATENCY_GIVE(channel)
+#define LATENCY_COLLAPSED(channel)
+#define LATENCY_MARK(channel, stage)
+#define LATENCY_DROP(channel)
+#endif
+
+#endif
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "pico/stdlib.h"
+#include "msg_bench.h"
+#include "msg_pool.h"
+#include "cycle_count.h"
+#include "core_affinity.h"
+#include "rtos_alloc.h"
+#include "stack_profile.h"
+
+#define SIZE_COUNT 5
+
+typedef enum {
+    MODE_COPY,
+    MODE_POOL
+} BenchMode_t;
+
+static const uint32_t sizes[SIZE_COUNT] = { 4, 16, 64, 256, 1024 };
+static QueueHandle_t copyQueues[SIZE_COUNT];
+
+MSG_POOL_STORAGE(poolStorage, MSG_BENCH_MAX_SIZE, MSG_BENCH_DEPTH);
+static MsgPool_t pool;
+static QueueHandle_t pointerQueue;
+
+static TaskHandle_t producerHandle;
+static TaskHandle_t consumerHandle;
+
+// Rodada atual; escrita pelo produtor antes de acordar o consumidor
+static BenchMode_t runMode;
+static uint32_t runIndex;
+
+// Resultado da rodada, escrito pelo consumidor
+static uint64_t latencySumNs;
+static uint32_t latencyMaxNs;
+static volatile uint32_t checksum; // Garante que a carga é lida
+
+static void producer_task(void *params) {
+    static uint8_t payload[MSG_BENCH_MAX_SIZE];
+
+    for (uint32_t index = 0; index < SIZE_COUNT; index++) {
+        uint32_t size = sizes[index];
+
+        for (BenchMode_t mode = MODE_COPY; mode <= MODE_POOL; mode++) {
+            MsgPoolStats_t before;
+            MsgPoolStats_t after;
+
+            msg_pool_get_stats(&pool, &before);
+            runMode = mode;
+            runIndex = index;
+            xTaskNotifyGive(consumerHandle); // O consumidor passa a esperar na fila certa
+
+            uint64_t start = time_us_64();
+            for (uint32_t i = 0; i < MSG_BENCH_MESSAGES; i++) {
+                uint8_t *data = payload;
+
+                if (mode == MODE_POOL) {
+                    // O consumidor devolve cada buffer antes do próximo envio;
+                    // se faltar, a falta é contada e o produtor cede a vez
+                    while ((data = msg_alloc(&pool)) == NULL) {
+                        taskYIELD();
+                    }
+                }
+
+                memset(data, (int) i, size);
+                uint32_t stamp = cycle_count_now();
+                memcpy(data, &stamp, sizeof(stamp));
+
+                if (mode == MODE_COPY) {
+                    xQueueSend(copyQueues[index], data, portMAX_DELAY);
+                } else {
+                    msg_send(pointerQueue, data, portMAX_DELAY);
+                }
+            }
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Consumidor recebeu todas
+            uint64_t elapsed = time_us_64() - start;
+
+            msg_pool_get_stats(&pool, &after);
+            printf("{\"msg_bench\":\"%s\",\"size\":%lu,\"messages\":%u,\"msgs_per_s\":%lu,"
+                   "\"latency_ns\":{\"mean\":%lu,\"max\":%lu},\"exhausted\":%lu}\n",
+                   mode == MODE_COPY ? "copy" : "pool", (unsigned long) size, MSG_BENCH_MESSAGES,
+                   (unsigned long) (elapsed > 0 ? (uint64_t) MSG_BENCH_MESSAGES * 1000000u / elapsed : 0),
+                   (unsigned long) (latencySumNs / MSG_BENCH_MESSAGES), (unsigned long) latencyMaxNs,
+                   (unsigned long) (after.exhausted - before.exhausted));
+        }
+    }
+
+    vTaskDelete(consumerHandle);
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *params) {
+    static uint8_t payload[MSG_BENCH_MAX_SIZE];
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        BenchMode_t mode = runMode;
+        uint32_t index = runIndex;
+
+        latencySumNs = 0;
+        latencyMaxNs = 0;
+        for (uint32_t i = 0; i < MSG_BENCH_MESSAGES; i++) {
+            uint8_t *data;
+            uint32_t stamp;
+
+            if (mode == MODE_COPY) {
+                xQueueReceive(copyQueues[index], payload, portMAX_DELAY);
+                data = payload;
+            } else {
+                data = msg_receive(pointerQueue, portMAX_DELAY);
+            }
+
+            uint32_t received = cycle_count_now();
+            memcpy(&stamp, data, sizeof(stamp));
+            uint32_t ns = cycle_count_elapsed_ns(stamp, received);
+            latencySumNs += ns;
+            if (ns > latencyMaxNs) {
+                latencyMaxNs = ns;
+            }
+            checksum += data[sizes[index] - 1];
+
+            if (mode == MODE_POOL) {
+                msg_free(data);
+            }
+        }
+        xTaskNotifyGive(producerHandle);
+    }
+}
+
+bool msg_bench_init(void) {
+    for (uint32_t i = 0; i < SIZE_COUNT; i++) {
+        copyQueues[i] = rtos_alloc_queue("benchCopy", MSG_BENCH_DEPTH, sizes[i]);
+    }
+    pointerQueue = msg_queue_create("benchPointer", MSG_BENCH_DEPTH);
+
+    for (uint32_t i = 0; i < SIZE_COUNT; i++) {
+        if (copyQueues[i] == NULL) {
+            return false;
+        }
+    }
+    if (pointerQueue == NULL || !msg_pool_init(&pool, "benchPool", poolStorage, MSG_BENCH_MAX_SIZE, MSG_BENCH_DEPTH)) {
+        return false;
+    }
+
+    // O consumidor tem prioridade maior: cada envio acorda e troca de contexto
+    core_affinity_create(consumer_task, "MsgConsumer", 512, NULL, tskIDLE_PRIORITY + 3, CORE_ROLE_ANY, &consumerHandle);
+    core_affinity_create(producer_task, "MsgProducer", 512, NULL, tskIDLE_PRIORITY + 2, CORE_ROLE_ANY, &producerHandle);
+    if (consumerHandle == NULL || producerHandle == NULL) {
+        return false;
+    }
+    STACK_PROFILE_OWNER(consumerHandle, "common");
+    STACK_PROFILE_OWNER(producerHandle, "common");
+    return true;
+}
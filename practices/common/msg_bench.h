@@ -0,0 +1,30 @@
+#ifndef MSG_BENCH_H
+#define MSG_BENCH_H
+
+/*
+ * Comparação entre filas que copiam a carga (xQueueSend/xQueueReceive) e as
+ * mensagens sem cópia do msg_pool, para cargas de 4 B a 1 KB.
+ *
+ * Um produtor envia MSG_BENCH_MESSAGES mensagens de cada tamanho por cada
+ * caminho para um consumidor de prioridade maior, que acorda a cada uma. O
+ * produtor preenche a carga (no buffer local para a cópia, direto no buffer
+ * do pool no outro caminho) e carimba o instante do envio na primeira
+ * palavra; o consumidor lê a carga no lugar e mede a latência do envio até
+ * a recepção. O resultado é uma linha JSON por tamanho e caminho com
+ * mensagens por segundo e latência média e máxima.
+ */
+
+#include <stdbool.h>
+
+#ifndef MSG_BENCH
+#define MSG_BENCH 0
+#endif
+
+#define MSG_BENCH_MESSAGES  2000
+#define MSG_BENCH_DEPTH     4       // Comprimento das filas e buffers do pool
+#define MSG_BENCH_MAX_SIZE  1024
+
+// Cria as filas, o pool e as duas tarefas; chamar antes do scheduler
+bool msg_bench_init(void);
+
+#endif
@@ -0,0 +1,114 @@
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "msg_pool.h"
+#include "rtos_alloc.h"
+
+#define MSG_ALLOCATED 0x4d534741u  // "MSGA"
+#define MSG_FREE      0x4d534746u  // "MSGF"
+
+typedef struct {
+    MsgPool_t *pool;
+    uint32_t state;  // MSG_ALLOCATED enquanto está com o produtor ou o consumidor
+} MsgHeader_t;
+
+_Static_assert(sizeof(MsgHeader_t) <= MSG_POOL_HEADER, "cabeçalho maior que MSG_POOL_HEADER");
+
+static inline MsgHeader_t *header_of(void *msg) {
+    return (MsgHeader_t *) ((uint8_t *) msg - MSG_POOL_HEADER);
+}
+
+bool msg_pool_init(MsgPool_t *pool, const char *name, void *storage, uint32_t msg_size, uint32_t count) {
+    if (storage == NULL || msg_size == 0 || count == 0) {
+        return false;
+    }
+
+    pool->name = name;
+    pool->stride = MSG_POOL_HEADER + ((msg_size + 7) & ~7u);
+    pool->start = storage;
+    pool->end = pool->start + pool->stride * count;
+    pool->lock = spin_lock_init(spin_lock_claim_unused(true));
+    pool->stats = (MsgPoolStats_t) { .msg_size = msg_size, .count = count };
+
+    // Lista em ordem crescente de endereço; o cabeçalho de cada buffer é fixo
+    pool->free_list = NULL;
+    for (uint32_t n = count; n > 0; n--) {
+        uint8_t *slot = pool->start + (n - 1) * pool->stride;
+        void *msg = slot + MSG_POOL_HEADER;
+
+        ((MsgHeader_t *) slot)->pool = pool;
+        ((MsgHeader_t *) slot)->state = MSG_FREE;
+        *(void **) msg = pool->free_list;
+        pool->free_list = msg;
+    }
+    return true;
+}
+
+void *msg_alloc(MsgPool_t *pool) {
+    uint32_t saved = spin_lock_blocking(pool->lock);
+    void *msg = pool->free_list;
+
+    if (msg != NULL) {
+        pool->free_list = *(void **) msg;
+        header_of(msg)->state = MSG_ALLOCATED;
+        pool->stats.allocs++;
+        if (++pool->stats.in_use > pool->stats.high_water) {
+            pool->stats.high_water = pool->stats.in_use;
+        }
+    } else {
+        pool->stats.exhausted++;
+    }
+
+    spin_unlock(pool->lock, saved);
+    return msg;
+}
+
+void msg_free(void *msg) {
+    if (msg == NULL) {
+        return;
+    }
+
+    // Um ponteiro de fora não tem a marca; um já devolvido tem MSG_FREE
+    MsgHeader_t *header = header_of(msg);
+    configASSERT(header->state == MSG_ALLOCATED);
+
+    MsgPool_t *pool = header->pool;
+    configASSERT((uint8_t *) msg > pool->start && (uint8_t *) msg < pool->end);
+    configASSERT(((uint8_t *) msg - pool->start - MSG_POOL_HEADER) % pool->stride == 0);
+
+    uint32_t saved = spin_lock_blocking(pool->lock);
+    // De novo com o lock, para dois msg_free() simultâneos do mesmo buffer
+    configASSERT(header->state == MSG_ALLOCATED);
+    header->state = MSG_FREE;
+    *(void **) msg = pool->free_list;
+    pool->free_list = msg;
+    pool->stats.in_use--;
+    spin_unlock(pool->lock, saved);
+}
+
+QueueHandle_t msg_queue_create(const char *name, UBaseType_t length) {
+    return rtos_alloc_queue(name, length, sizeof(void *));
+}
+
+BaseType_t msg_send(QueueHandle_t queue, void *msg, TickType_t timeout) {
+    return xQueueSend(queue, &msg, timeout);
+}
+
+BaseType_t msg_send_from_isr(QueueHandle_t queue, void *msg, BaseType_t *pxHigherPriorityTaskWoken) {
+    return xQueueSendFromISR(queue, &msg, pxHigherPriorityTaskWoken);
+}
+
+void *msg_receive(QueueHandle_t queue, TickType_t timeout) {
+    void *msg;
+    return xQueueReceive(queue, &msg, timeout) == pdPASS ? msg : NULL;
+}
+
+bool msg_pool_get_stats(MsgPool_t *pool, MsgPoolStats_t *stats) {
+    if (pool->lock == NULL) {
+        return false;
+    }
+
+    uint32_t saved = spin_lock_blocking(pool->lock);
+    *stats = pool->stats;
+    spin_unlock(pool->lock, saved);
+    return true;
+}
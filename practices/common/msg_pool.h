@@ -0,0 +1,81 @@
+#ifndef MSG_POOL_H
+#define MSG_POOL_H
+
+/*
+ * Mensagens sem cópia: buffers de tamanho fixo tirados de um pool e filas
+ * que carregam só o ponteiro.
+ *
+ * O produtor pede um buffer com msg_alloc(), escreve a carga direto nele e o
+ * entrega com msg_send(); a partir daí o buffer é do consumidor, que o lê no
+ * lugar e o devolve com msg_free(). A fila copia 4 bytes (o ponteiro) seja
+ * qual for o tamanho da mensagem. Cada buffer tem um cabeçalho com o pool de
+ * origem, então msg_free() não precisa saber de onde ele veio, e com a marca
+ * de alocado: devolver duas vezes, ou um ponteiro que não veio de
+ * msg_alloc(), para no configASSERT. Para cargas do tamanho de um ponteiro
+ * a fila copiando o valor sai mais barata.
+ *
+ * O pool não cresce: com todos os buffers em trânsito msg_alloc() retorna
+ * NULL e conta a falta em "exhausted", sem bloquear. Uma fila com o mesmo
+ * comprimento do pool nunca enche, porque não existem mais mensagens que
+ * buffers. alloc e free valem em tarefas e ISRs (spin lock com as
+ * interrupções desligadas, como no block_pool).
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "hardware/sync.h"
+
+// Pool de origem e marca de alocado, antes da carga; múltiplo de 8 para manter
+// a carga alinhada (8 bytes na Pico, 16 no host de 64 bits)
+#define MSG_POOL_HEADER ((sizeof(void *) + sizeof(uint32_t) + 7) & ~(size_t) 7)
+
+// Bytes de armazenamento para count mensagens de msg_size bytes
+#define MSG_POOL_BYTES(msg_size, count) ((count) * (MSG_POOL_HEADER + (((msg_size) + 7) & ~7u)))
+
+// Vetor estático para msg_pool_init()
+#define MSG_POOL_STORAGE(name, msg_size, count) \
+    static uint8_t name[MSG_POOL_BYTES(msg_size, count)] __attribute__((aligned(8)))
+
+typedef struct {
+    uint32_t msg_size;
+    uint32_t count;        // Buffers do pool
+    uint32_t in_use;       // Alocados e ainda não devolvidos
+    uint32_t high_water;
+    uint32_t allocs;
+    uint32_t exhausted;    // Pedidos que acharam o pool vazio
+} MsgPoolStats_t;
+
+typedef struct {
+    const char *name;
+    uint8_t *start;
+    uint8_t *end;
+    uint32_t stride;       // Cabeçalho + carga arredondada
+    void *free_list;       // Encadeada pela primeira palavra da carga
+    spin_lock_t *lock;
+    MsgPoolStats_t stats;
+} MsgPool_t;
+
+// storage precisa de MSG_POOL_BYTES(msg_size, count) bytes alinhados em 8
+bool msg_pool_init(MsgPool_t *pool, const char *name, void *storage, uint32_t msg_size, uint32_t count);
+
+// Buffer de msg_size bytes ou NULL com o pool vazio; também em ISRs
+void *msg_alloc(MsgPool_t *pool);
+
+// Devolve o buffer ao pool de origem; também em ISRs
+void msg_free(void *msg);
+
+// Fila de ponteiros (rtos_alloc); use length igual ao count do pool
+QueueHandle_t msg_queue_create(const char *name, UBaseType_t length);
+
+// Entrega a mensagem; se falhar, ela continua com quem chamou
+BaseType_t msg_send(QueueHandle_t queue, void *msg, TickType_t timeout);
+BaseType_t msg_send_from_isr(QueueHandle_t queue, void *msg, BaseType_t *pxHigherPriorityTaskWoken);
+
+// Próxima mensagem ou NULL no timeout; quem recebe chama msg_free()
+void *msg_receive(QueueHandle_t queue, TickType_t timeout);
+
+bool msg_pool_get_stats(MsgPool_t *pool, MsgPoolStats_t *stats);
+
+#endif
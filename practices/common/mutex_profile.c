@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "mutex_profile.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#endif
+
+#if MUTEX_PROFILE
+
+typedef struct {
+    void *mutex;
+    void *holder;
+    void *last_holder;          // o kernel desfaz a herança logo depois do give
+    uint32_t taken_at;
+    MutexStats_t stats;
+} TrackedMutex_t;
+
+// Tarefa bloqueada esperando um mutex
+typedef struct {
+    void *task;
+    void *mutex;
+    uint32_t since;
+} Waiter_t;
+
+static TrackedMutex_t mutexes[MUTEX_PROFILE_MAX_MUTEXES];
+static Waiter_t waiters[MUTEX_PROFILE_MAX_WAITERS];
+#ifdef PICO_SIM
+static bool report_registered = false;
+#endif
+
+static TrackedMutex_t *find(void *mutex, bool allocate) {
+    for (int i = 0; i < MUTEX_PROFILE_MAX_MUTEXES; i++) {
+        if (mutexes[i].mutex == mutex) {
+            return &mutexes[i];
+        }
+        if (mutexes[i].mutex == NULL) {
+            if (!allocate) {
+                return NULL;
+            }
+            mutexes[i].mutex = mutex;
+            return &mutexes[i];
+        }
+    }
+    return NULL;
+}
+
+static void dist_add(MutexDist_t *dist, uint32_t us) {
+    uint32_t bucket = 0;
+
+    dist->count++;
+    dist->sum_us += us;
+    if (us > dist->max_us) {
+        dist->max_us = us;
+    }
+    while (bucket < MUTEX_PROFILE_BUCKETS - 1 && us >= (1u << bucket)) {
+        bucket++;
+    }
+    dist->histogram[bucket]++;
+}
+
+// Retira a tarefa atual da lista de espera; devolve o início da espera ou 0
+static bool take_waiter(void *mutex, uint32_t *since) {
+    void *task = xTaskGetCurrentTaskHandle();
+
+    for (int i = 0; i < MUTEX_PROFILE_MAX_WAITERS; i++) {
+        if (waiters[i].task == task && waiters[i].mutex == mutex) {
+            *since = waiters[i].since;
+            waiters[i].task = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+void mutex_profile_on_block(void *mutex) {
+    void *task = xTaskGetCurrentTaskHandle();
+    Waiter_t *free_slot = NULL;
+
+    // O take pode bloquear mais de uma vez na mesma chamada; vale o primeiro
+    for (int i = 0; i < MUTEX_PROFILE_MAX_WAITERS; i++) {
+        if (waiters[i].task == task && waiters[i].mutex == mutex) {
+            return;
+        }
+        if (waiters[i].task == NULL && free_slot == NULL) {
+            free_slot = &waiters[i];
+        }
+    }
+    if (free_slot != NULL) {
+        free_slot->task = task;
+        free_slot->mutex = mutex;
+        free_slot->since = time_us_32();
+    }
+}
+
+void mutex_profile_on_take(void *mutex) {
+    TrackedMutex_t *tracked = find(mutex, true);
+    uint32_t now = time_us_32();
+    uint32_t since;
+
+    if (tracked == NULL) {
+        return;
+    }
+
+#ifdef PICO_SIM
+    if (!report_registered) {
+        report_registered = sim_at_exit(mutex_profile_report);
+    }
+#endif
+
+    tracked->stats.acquisitions++;
+    if (take_waiter(mutex, &since)) {
+        tracked->stats.contended++;
+        dist_add(&tracked->stats.wait, now - since);
+    } else {
+        dist_add(&tracked->stats.wait, 0);
+    }
+    tracked->holder = xTaskGetCurrentTaskHandle();
+    tracked->taken_at = now;
+}
+
+void mutex_profile_on_take_failed(void *mutex) {
+    TrackedMutex_t *tracked = find(mutex, true);
+    uint32_t since;
+
+    if (tracked == NULL) {
+        return;
+    }
+    if (take_waiter(mutex, &since)) {
+        tracked->stats.timeouts++;
+    } else {
+        tracked->stats.trylock_failures++;
+    }
+}
+
+void mutex_profile_on_give(void *mutex) {
+    TrackedMutex_t *tracked = find(mutex, false);
+
+    if (tracked != NULL && tracked->holder != NULL) {
+        dist_add(&tracked->stats.hold, time_us_32() - tracked->taken_at);
+        tracked->last_holder = tracked->holder;
+        tracked->holder = NULL;
+    }
+}
+
+static TrackedMutex_t *held_by(void *holder, bool just_released) {
+    for (int i = 0; i < MUTEX_PROFILE_MAX_MUTEXES; i++) {
+        void *owner = just_released ? mutexes[i].last_holder : mutexes[i].holder;
+        if (mutexes[i].mutex != NULL && owner == holder) {
+            return &mutexes[i];
+        }
+    }
+    return NULL;
+}
+
+void mutex_profile_on_inherit(void *holder, unsigned long priority) {
+    TrackedMutex_t *tracked = held_by(holder, false);
+
+    if (tracked != NULL) {
+        tracked->stats.inherits++;
+        if (priority > tracked->stats.max_inherited_priority) {
+            tracked->stats.max_inherited_priority = priority;
+        }
+    }
+}
+
+void mutex_profile_on_disinherit(void *holder, unsigned long priority) {
+    TrackedMutex_t *tracked = held_by(holder, false);
+
+    (void) priority;
+    if (tracked == NULL) {
+        tracked = held_by(holder, true);
+    }
+    if (tracked != NULL) {
+        tracked->stats.disinherits++;
+    }
+}
+
+void mutex_profile_name(SemaphoreHandle_t mutex, const char *name) {
+    taskENTER_CRITICAL();
+    TrackedMutex_t *tracked = find(mutex, true);
+    if (tracked != NULL) {
+        tracked->stats.name = name;
+    }
+    taskEXIT_CRITICAL();
+}
+
+bool mutex_profile_get(SemaphoreHandle_t mutex, MutexStats_t *stats) {
+    bool found = false;
+
+    taskENTER_CRITICAL();
+    TrackedMutex_t *tracked = find(mutex, false);
+    if (tracked != NULL && tracked->stats.acquisitions + tracked->stats.trylock_failures > 0) {
+        *stats = tracked->stats;
+        found = true;
+    }
+    taskEXIT_CRITICAL();
+
+    return found;
+}
+
+static void print_dist(const char *name, const MutexDist_t *dist) {
+    printf("\"%s\":{\"mean\":%lu,\"max\":%lu,\"histogram_log2_us\":[", name,
+           (unsigned long) (dist->count ? dist->sum_us / dist->count : 0), (unsigned long) dist->max_us);
+    for (int i = 0; i < MUTEX_PROFILE_BUCKETS; i++) {
+        printf("%s%lu", i ? "," : "", (unsigned long) dist->histogram[i]);
+    }
+    printf("]}");
+}
+
+void mutex_profile_report(void) {
+    MutexStats_t stats;
+
+    for (int i = 0; i < MUTEX_PROFILE_MAX_MUTEXES && mutexes[i].mutex != NULL; i++) {
+        if (!mutex_profile_get(mutexes[i].mutex, &stats)) {
+            continue;
+        }
+        if (stats.name != NULL) {
+            printf("{\"mutex\":\"%s\",", stats.name);
+        } else {
+            printf("{\"mutex\":\"%p\",", mutexes[i].mutex);
+        }
+        printf("\"acquisitions\":%lu,\"contended\":%lu,\"trylock_failures\":%lu,\"timeouts\":%lu,"
+               "\"inherits\":%lu,\"disinherits\":%lu,\"max_inherited_priority\":%lu,",
+               (unsigned long) stats.acquisitions, (unsigned long) stats.contended,
+               (unsigned long) stats.trylock_failures, (unsigned long) stats.timeouts,
+               (unsigned long) stats.inherits, (unsigned long) stats.disinherits,
+               (unsigned long) stats.max_inherited_priority);
+        print_dist("hold_us", &stats.hold);
+        printf(",");
+        print_dist("wait_us", &stats.wait);
+        printf("}\n");
+    }
+}
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef MUTEX_PROFILE_H
+#define MUTEX_PROFILE_H
+
+/*
+ * Profiler de contenção de mutexes.
+ *
+ * Com MUTEX_PROFILE = 1 o trace_hooks.h liga as macros de trace das filas e
+ * da herança de prioridade a este módulo, então todo xSemaphoreTake/Give num
+ * mutex é medido sem mudar o código da prática. Por mutex ficam:
+ * - aquisições, quantas precisaram bloquear, try-locks que falharam e
+ *   timeouts;
+ * - histogramas do tempo de posse e do tempo de espera (bucket i: < 2^i µs);
+ * - eventos de herança de prioridade, com a maior prioridade herdada.
+ *
+ * A herança é atribuída ao mutex que o dono está segurando; com mais de um
+ * ao mesmo tempo vale o primeiro da tabela.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#ifndef MUTEX_PROFILE
+#define MUTEX_PROFILE 0
+#endif
+
+#define MUTEX_PROFILE_MAX_MUTEXES  8
+#define MUTEX_PROFILE_MAX_WAITERS  8
+#define MUTEX_PROFILE_BUCKETS      24
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t histogram[MUTEX_PROFILE_BUCKETS];
+} MutexDist_t;
+
+typedef struct {
+    const char *name;
+    uint32_t acquisitions;
+    uint32_t contended;         // aquisições que bloquearam antes
+    uint32_t trylock_failures;  // take com timeout 0 e mutex ocupado
+    uint32_t timeouts;          // bloqueou e desistiu
+    uint32_t inherits;
+    uint32_t disinherits;
+    uint32_t max_inherited_priority;
+    MutexDist_t hold;
+    MutexDist_t wait;
+} MutexStats_t;
+
+// Nome do mutex no relatório (opcional; sem nome sai o endereço)
+void mutex_profile_name(SemaphoreHandle_t mutex, const char *name);
+
+// Cópia das estatísticas; false se o mutex nunca foi usado
+bool mutex_profile_get(SemaphoreHandle_t mutex, MutexStats_t *stats);
+
+// Uma linha JSON por mutex; no host é chamada ao final da execução
+void mutex_profile_report(void);
+
+#endif
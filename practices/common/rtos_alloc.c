@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "rtos_alloc.h"
+#include "trace_recorder.h"
+
+#if STATIC_ALLOCATION && configSUPPORT_STATIC_ALLOCATION != 1
+#error "STATIC_ALLOCATION precisa de configSUPPORT_STATIC_ALLOCATION = 1"
+#endif
+#if !STATIC_ALLOCATION && configSUPPORT_DYNAMIC_ALLOCATION != 1
+#error "sem configSUPPORT_DYNAMIC_ALLOCATION compile com STATIC_ALLOCATION = 1"
+#endif
+
+#if configNUMBER_OF_CORES > 1 && configUSE_CORE_AFFINITY == 1
+#define RTOS_ALLOC_SMP 1
+#else
+#define RTOS_ALLOC_SMP 0
+#endif
+
+typedef struct {
+    const char *name;
+    const char *kind;
+    uint32_t bytes;        // Pilha, controle e armazenamento do objeto
+    uint32_t heap_bytes;   // Queda do heap livre na criação
+    uint32_t create_us;
+} RtosObject_t;
+
+// Início de uma criação, para medir tempo e heap
+typedef struct {
+    uint64_t start_us;
+    size_t free_before;
+} Mark_t;
+
+static RtosObject_t objects[RTOS_ALLOC_MAX_OBJECTS];
+static UBaseType_t object_count = 0;
+static uint32_t failures = 0;
+
+#if STATIC_ALLOCATION
+static uint8_t arena[RTOS_ALLOC_ARENA_BYTES] __attribute__((aligned(8)));
+static size_t arena_used = 0;
+
+static void *arena_take(size_t size) {
+    void *block = NULL;
+
+    size = (size + 7) & ~(size_t) 7;
+    taskENTER_CRITICAL();
+    if (arena_used + size <= sizeof(arena)) {
+        block = &arena[arena_used];
+        arena_used += size;
+    }
+    taskEXIT_CRITICAL();
+    return block;
+}
+#endif
+
+// Filas e semáforos aparecem no trace do kernel com o nome dado aqui
+static void name_queue(void *queue, const char *name) {
+#if TRACE_RECORDER
+    if (queue != NULL) {
+        trace_recorder_name_queue(queue, name);
+    }
+#else
+    (void) queue;
+    (void) name;
+#endif
+}
+
+static void begin(Mark_t *mark) {
+#if configSUPPORT_DYNAMIC_ALLOCATION == 1
+    mark->free_before = xPortGetFreeHeapSize();
+#else
+    mark->free_before = 0;
+#endif
+    mark->start_us = time_us_64();
+}
+
+static void record(const Mark_t *mark, const char *name, const char *kind, uint32_t bytes, bool ok) {
+    uint32_t elapsed = (uint32_t) (time_us_64() - mark->start_us);
+    uint32_t heap_bytes = 0;
+
+#if configSUPPORT_DYNAMIC_ALLOCATION == 1
+    heap_bytes = (uint32_t) (mark->free_before - xPortGetFreeHeapSize());
+#endif
+
+    taskENTER_CRITICAL();
+    if (!ok) {
+        failures++;
+    } else if (object_count < RTOS_ALLOC_MAX_OBJECTS) {
+        RtosObject_t *object = &objects[object_count++];
+        object->name = name;
+        object->kind = kind;
+        object->bytes = bytes;
+        object->heap_bytes = heap_bytes;
+        object->create_us = elapsed;
+    }
+    taskEXIT_CRITICAL();
+}
+
+BaseType_t rtos_alloc_task(TaskFunction_t code, const char *name, configSTACK_DEPTH_TYPE depth, void *params,
+                           UBaseType_t priority, UBaseType_t core_mask, TaskHandle_t *handle) {
+    TaskHandle_t created = NULL;
+    BaseType_t result;
+    Mark_t mark;
+
+    (void) core_mask;
+    begin(&mark);
+
+#if STATIC_ALLOCATION
+    StackType_t *stack = arena_take(depth * sizeof(StackType_t));
+    StaticTask_t *tcb = arena_take(sizeof(StaticTask_t));
+    if (stack != NULL && tcb != NULL) {
+#if RTOS_ALLOC_SMP
+        created = xTaskCreateStaticAffinitySet(code, name, depth, params, priority, stack, tcb, core_mask);
+#else
+        created = xTaskCreateStatic(code, name, depth, params, priority, stack, tcb);
+#endif
+    }
+    result = created != NULL ? pdPASS : errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+#elif RTOS_ALLOC_SMP
+    result = xTaskCreateAffinitySet(code, name, depth, params, priority, core_mask, &created);
+#else
+    result = xTaskCreate(code, name, depth, params, priority, &created);
+#endif
+
+    record(&mark, name, "task", depth * sizeof(StackType_t) + sizeof(StaticTask_t), result == pdPASS);
+    if (handle != NULL) {
+        *handle = created;
+    }
+    return result;
+}
+
+QueueHandle_t rtos_alloc_queue(const char *name, UBaseType_t length, UBaseType_t item_size) {
+    QueueHandle_t queue = NULL;
+    Mark_t mark;
+
+    begin(&mark);
+#if STATIC_ALLOCATION
+    uint8_t *storage = item_size > 0 ? arena_take(length * item_size) : NULL;
+    StaticQueue_t *control = arena_take(sizeof(StaticQueue_t));
+    if (control != NULL && (storage != NULL || item_size == 0)) {
+        queue = xQueueCreateStatic(length, item_size, storage, control);
+    }
+#else
+    queue = xQueueCreate(length, item_size);
+#endif
+
+    name_queue(queue, name);
+    record(&mark, name, "queue", sizeof(StaticQueue_t) + length * item_size, queue != NULL);
+    return queue;
+}
+
+SemaphoreHandle_t rtos_alloc_binary(const char *name) {
+    SemaphoreHandle_t semaphore = NULL;
+    Mark_t mark;
+
+    begin(&mark);
+#if STATIC_ALLOCATION
+    StaticSemaphore_t *control = arena_take(sizeof(StaticSemaphore_t));
+    if (control != NULL) {
+        semaphore = xSemaphoreCreateBinaryStatic(control);
+    }
+#else
+    semaphore = xSemaphoreCreateBinary();
+#endif
+
+    name_queue(semaphore, name);
+    record(&mark, name, "binary", sizeof(StaticSemaphore_t), semaphore != NULL);
+    return semaphore;
+}
+
+SemaphoreHandle_t rtos_alloc_counting(const char *name, UBaseType_t max_count, UBaseType_t initial_count) {
+    SemaphoreHandle_t semaphore = NULL;
+    Mark_t mark;
+
+    begin(&mark);
+#if STATIC_ALLOCATION
+    StaticSemaphore_t *control = arena_take(sizeof(StaticSemaphore_t));
+    if (control != NULL) {
+        semaphore = xSemaphoreCreateCountingStatic(max_count, initial_count, control);
+    }
+#else
+    semaphore = xSemaphoreCreateCounting(max_count, initial_count);
+#endif
+
+    name_queue(semaphore, name);
+    record(&mark, name, "counting", sizeof(StaticSemaphore_t), semaphore != NULL);
+    return semaphore;
+}
+
+SemaphoreHandle_t rtos_alloc_mutex(const char *name) {
+    SemaphoreHandle_t mutex = NULL;
+    Mark_t mark;
+
+    begin(&mark);
+#if STATIC_ALLOCATION
+    StaticSemaphore_t *control = arena_take(sizeof(StaticSemaphore_t));
+    if (control != NULL) {
+        mutex = xSemaphoreCreateMutexStatic(control);
+    }
+#else
+    mutex = xSemaphoreCreateMutex();
+#endif
+
+    name_queue(mutex, name);
+    record(&mark, name, "mutex", sizeof(StaticSemaphore_t), mutex != NULL);
+    return mutex;
+}
+
+TimerHandle_t rtos_alloc_timer(const char *name, TickType_t period, BaseType_t auto_reload, void *id,
+                               TimerCallbackFunction_t callback) {
+    TimerHandle_t timer = NULL;
+    Mark_t mark;
+
+    begin(&mark);
+#if STATIC_ALLOCATION
+    StaticTimer_t *control = arena_take(sizeof(StaticTimer_t));
+    if (control != NULL) {
+        timer = xTimerCreateStatic(name, period, auto_reload, id, callback, control);
+    }
+#else
+    timer = xTimerCreate(name, period, auto_reload, id, callback);
+#endif
+
+    record(&mark, name, "timer", sizeof(StaticTimer_t), timer != NULL);
+    return timer;
+}
+
+void rtos_alloc_get_totals(uint32_t *count, uint32_t *bytes) {
+    uint32_t sum = 0;
+
+    taskENTER_CRITICAL();
+    for (UBaseType_t i = 0; i < object_count; i++) {
+        sum += objects[i].bytes;
+    }
+    *count = (uint32_t) object_count;
+    taskEXIT_CRITICAL();
+    *bytes = sum;
+}
+
+void rtos_alloc_report(void) {
+    uint32_t bytes = 0;
+    uint32_t heap_bytes = 0;
+    uint32_t create_us = 0;
+    uint32_t used = 0;
+
+    for (UBaseType_t i = 0; i < object_count; i++) {
+        const RtosObject_t *object = &objects[i];
+        printf("{\"object\":\"%s\",\"kind\":\"%s\",\"bytes\":%lu,\"heap_bytes\":%lu,\"create_us\":%lu}\n",
+               object->name, object->kind, (unsigned long) object->bytes,
+               (unsigned long) object->heap_bytes, (unsigned long) object->create_us);
+        bytes += object->bytes;
+        heap_bytes += object->heap_bytes;
+        create_us += object->create_us;
+    }
+
+#if STATIC_ALLOCATION
+    used = (uint32_t) arena_used;
+#endif
+    printf("{\"ram\":\"%s\",\"objects\":%lu,\"bytes\":%lu,\"heap_bytes\":%lu,"
+           "\"arena_used\":%lu,\"arena_bytes\":%lu,\"failures\":%lu,\"create_us\":%lu}\n",
+           STATIC_ALLOCATION ? "static" : "heap", (unsigned long) object_count, (unsigned long) bytes,
+           (unsigned long) heap_bytes, (unsigned long) used,
+           (unsigned long) (STATIC_ALLOCATION ? RTOS_ALLOC_ARENA_BYTES : 0),
+           (unsigned long) failures, (unsigned long) create_us);
+}
@@ -0,0 +1,61 @@
+#ifndef RTOS_ALLOC_H
+#define RTOS_ALLOC_H
+
+/*
+ * Criação das tarefas, filas, semáforos e timers das práticas.
+ *
+ * Com STATIC_ALLOCATION = 0 as funções chamam as versões dinâmicas do
+ * FreeRTOS. Com STATIC_ALLOCATION = 1 usam as versões *Static, com a pilha,
+ * o TCB e o armazenamento de cada objeto tirados em sequência de uma arena
+ * estática de RTOS_ALLOC_ARENA_BYTES: a memória aparece no mapa do linker,
+ * a criação não passa pelo heap e a mesma sequência de chamadas sempre dá o
+ * mesmo resultado. Nada volta para a arena, nem de tarefas deletadas. Junto
+ * com configSUPPORT_DYNAMIC_ALLOCATION = 0 (e sem heap_4.c no build) o
+ * kernel não tem heap nenhum; a prática do heap exige a alocação dinâmica.
+ *
+ * Cada objeto criado é registrado com o nome, os bytes que ocupa e o tempo
+ * de criação. Com RAM_REPORT = 1 a prática imprime o relatório antes de
+ * iniciar o escalonador; no build dinâmico os bytes de heap são medidos pela
+ * queda do xPortGetFreeHeapSize, incluindo o cabeçalho de cada bloco.
+ *
+ * O FreeRTOSConfig.h precisa de configSUPPORT_STATIC_ALLOCATION = 1 e de
+ * configKERNEL_PROVIDED_STATIC_MEMORY = 1 (memória da idle e do timer).
+ */
+
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+
+#ifndef STATIC_ALLOCATION
+#define STATIC_ALLOCATION 0
+#endif
+
+#ifndef RAM_REPORT
+#define RAM_REPORT 0
+#endif
+
+#ifndef RTOS_ALLOC_ARENA_BYTES
+#define RTOS_ALLOC_ARENA_BYTES (48 * 1024)
+#endif
+#define RTOS_ALLOC_MAX_OBJECTS 40
+
+// core_mask só vale no build SMP; tskNO_AFFINITY deixa o núcleo livre
+BaseType_t rtos_alloc_task(TaskFunction_t code, const char *name, configSTACK_DEPTH_TYPE depth, void *params,
+                           UBaseType_t priority, UBaseType_t core_mask, TaskHandle_t *handle);
+QueueHandle_t rtos_alloc_queue(const char *name, UBaseType_t length, UBaseType_t item_size);
+SemaphoreHandle_t rtos_alloc_binary(const char *name);
+SemaphoreHandle_t rtos_alloc_counting(const char *name, UBaseType_t max_count, UBaseType_t initial_count);
+SemaphoreHandle_t rtos_alloc_mutex(const char *name);
+TimerHandle_t rtos_alloc_timer(const char *name, TickType_t period, BaseType_t auto_reload, void *id,
+                               TimerCallbackFunction_t callback);
+
+// Uma linha JSON por objeto e uma com os totais
+void rtos_alloc_report(void);
+
+// Os mesmos totais do relatório: objetos criados e bytes somados
+void rtos_alloc_get_totals(uint32_t *count, uint32_t *bytes);
+
+#endif
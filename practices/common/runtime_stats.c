@@ -0,0 +1,234 @@
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "runtime_stats.h"
+#include "rtos_alloc.h"
+#include "hardware/sync.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#endif
+
+#if configGENERATE_RUN_TIME_STATS != 1 || configUSE_TRACE_FACILITY != 1
+#error "runtime_stats precisa de configGENERATE_RUN_TIME_STATS e configUSE_TRACE_FACILITY"
+#endif
+
+#define HISTORY (RUNTIME_STATS_WINDOW + 1)
+
+// Histórico dos contadores de uma tarefa
+typedef struct {
+    TaskHandle_t handle;
+    const char *name;
+    configRUN_TIME_COUNTER_TYPE counter[HISTORY];
+} TrackedTask_t;
+
+static TrackedTask_t tracked[RUNTIME_STATS_MAX_TASKS];
+static configRUN_TIME_COUNTER_TYPE total[HISTORY];
+static UBaseType_t head = 0;
+static UBaseType_t samples = 0;
+
+static TaskStatus_t status[RUNTIME_STATS_MAX_TASKS];
+
+#if SWITCH_COUNT
+// Tarefa que saiu em cada núcleo e trocas contadas
+static void *switched_out[configNUMBER_OF_CORES];
+static volatile uint32_t switches = 0;
+
+void runtime_stats_on_switch_out(void *task) {
+    switched_out[get_core_num()] = task;
+}
+
+void runtime_stats_on_switch_in(void *task) {
+    if (task != switched_out[get_core_num()]) {
+        switches++;
+    }
+}
+#endif
+
+static void sample_timer_callback(TimerHandle_t timer) {
+    (void) timer;
+    runtime_stats_sample();
+}
+
+static TrackedTask_t *find_slot(TaskHandle_t handle, bool allocate) {
+    TrackedTask_t *free_slot = NULL;
+
+    for (int i = 0; i < RUNTIME_STATS_MAX_TASKS; i++) {
+        if (tracked[i].handle == handle) {
+            return &tracked[i];
+        }
+        if (tracked[i].handle == NULL && free_slot == NULL) {
+            free_slot = &tracked[i];
+        }
+    }
+
+    if (allocate && free_slot != NULL) {
+        // O contador do kernel começa em zero quando a tarefa é criada
+        memset(free_slot, 0, sizeof(*free_slot));
+        free_slot->handle = handle;
+    }
+    return allocate ? free_slot : NULL;
+}
+
+void runtime_stats_sample(void) {
+    configRUN_TIME_COUNTER_TYPE now;
+    bool seen[RUNTIME_STATS_MAX_TASKS] = { false };
+
+    UBaseType_t count = uxTaskGetSystemState(status, RUNTIME_STATS_MAX_TASKS, &now);
+    if (count == 0) {
+        return; // Mais tarefas que RUNTIME_STATS_MAX_TASKS
+    }
+
+    taskENTER_CRITICAL();
+
+    head = (head + 1) % HISTORY;
+    total[head] = now;
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        TrackedTask_t *slot = find_slot(status[i].xHandle, true);
+        if (slot != NULL) {
+            slot->name = status[i].pcTaskName;
+            slot->counter[head] = status[i].ulRunTimeCounter;
+            seen[slot - tracked] = true;
+        }
+    }
+
+    // Libera as entradas de tarefas que foram deletadas
+    for (int i = 0; i < RUNTIME_STATS_MAX_TASKS; i++) {
+        if (!seen[i]) {
+            tracked[i].handle = NULL;
+        }
+    }
+
+    if (samples < HISTORY) {
+        samples++;
+    }
+
+    taskEXIT_CRITICAL();
+}
+
+bool runtime_stats_init(void) {
+    TimerHandle_t timer = rtos_alloc_timer("RtStats", pdMS_TO_TICKS(RUNTIME_STATS_PERIOD_MS),
+                                       pdTRUE, NULL, sample_timer_callback);
+    if (timer == NULL) {
+        return false;
+    }
+
+    runtime_stats_sample();
+    return xTimerStart(timer, 0) == pdPASS;
+}
+
+static float percent(configRUN_TIME_COUNTER_TYPE part, configRUN_TIME_COUNTER_TYPE whole) {
+    return whole == 0 ? 0.0f : (float) part * 100.0f / (float) whole;
+}
+
+// Calcula uso na janela e o menor/maior uso por período; chamar em seção crítica
+static bool compute(const TrackedTask_t *slot, RuntimeStats_t *stats, float *min_period) {
+    if (samples < 2) {
+        return false;
+    }
+
+    UBaseType_t periods = samples - 1;
+    UBaseType_t oldest = (head + HISTORY - periods) % HISTORY;
+
+    stats->name = slot->name;
+    stats->usage = percent(slot->counter[head] - slot->counter[oldest], total[head] - total[oldest]);
+    stats->peak = 0.0f;
+    *min_period = 100.0f;
+
+    for (UBaseType_t k = 1; k <= periods; k++) {
+        UBaseType_t cur = (oldest + k) % HISTORY;
+        UBaseType_t prev = (oldest + k - 1) % HISTORY;
+        float usage = percent(slot->counter[cur] - slot->counter[prev], total[cur] - total[prev]);
+
+        if (usage > stats->peak) {
+            stats->peak = usage;
+        }
+        if (usage < *min_period) {
+            *min_period = usage;
+        }
+    }
+    return true;
+}
+
+bool runtime_stats_get_task(TaskHandle_t task, RuntimeStats_t *stats) {
+    float min_period;
+    bool ok = false;
+
+    if (task == NULL) {
+        task = xTaskGetCurrentTaskHandle();
+    }
+
+    taskENTER_CRITICAL();
+    const TrackedTask_t *slot = find_slot(task, false);
+    if (slot != NULL) {
+        ok = compute(slot, stats, &min_period);
+    }
+    taskEXIT_CRITICAL();
+
+    return ok;
+}
+
+static TaskHandle_t idle_handle(BaseType_t core) {
+#if configNUMBER_OF_CORES > 1
+    return xTaskGetIdleTaskHandleForCore(core);
+#elif defined(PICO_SIM)
+    // Com o tempo virtual o relógio só anda na tarefa SimClock
+    return core == 0 ? sim_idle_task() : NULL;
+#else
+    return core == 0 ? xTaskGetIdleTaskHandle() : NULL;
+#endif
+}
+
+bool runtime_stats_get_core(BaseType_t core, RuntimeStats_t *stats) {
+    RuntimeStats_t idle;
+    float idle_min;
+    bool ok = false;
+    TaskHandle_t handle = idle_handle(core);
+
+    if (handle == NULL) {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    const TrackedTask_t *slot = find_slot(handle, false);
+    if (slot != NULL) {
+        ok = compute(slot, &idle, &idle_min);
+    }
+    taskEXIT_CRITICAL();
+
+    if (ok) {
+        // O pico de uso da CPU é o período em que a idle menos rodou
+        stats->name = "CPU";
+        stats->usage = 100.0f - idle.usage;
+        stats->peak = 100.0f - idle_min;
+    }
+    return ok;
+}
+
+bool runtime_stats_get_cpu(RuntimeStats_t *stats) {
+    RuntimeStats_t core;
+    float usage = 0.0f;
+    float peak = 0.0f;
+
+    for (BaseType_t i = 0; i < configNUMBER_OF_CORES; i++) {
+        if (!runtime_stats_get_core(i, &core)) {
+            return false;
+        }
+        usage += core.usage;
+        peak += core.peak; // Limite superior: os picos podem cair em períodos diferentes
+    }
+
+    stats->name = "CPU";
+    stats->usage = usage / configNUMBER_OF_CORES;
+    stats->peak = peak / configNUMBER_OF_CORES;
+    return true;
+}
+
+uint32_t runtime_stats_get_switches(void) {
+#if SWITCH_COUNT
+    return switches;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,62 @@
+#ifndef RUNTIME_STATS_H
+#define RUNTIME_STATS_H
+
+/*
+ * Contabilidade de tempo de CPU por tarefa.
+ *
+ * Usa o contador de runtime do próprio kernel (configGENERATE_RUN_TIME_STATS),
+ * que soma o tempo de cada tarefa a cada troca de contexto. Um software timer
+ * tira uma amostra dos contadores a cada RUNTIME_STATS_PERIOD_MS e guarda as
+ * últimas RUNTIME_STATS_WINDOW amostras; o uso e o pico de cada tarefa são
+ * calculados só na consulta, então o custo no caminho crítico é a leitura do
+ * timer que o kernel já faz na troca de contexto.
+ *
+ * O FreeRTOSConfig.h precisa de uma base de tempo de alta resolução:
+ *   Pico:  #define configGENERATE_RUN_TIME_STATS 1
+ *          #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+ *          #define portGET_RUN_TIME_COUNTER_VALUE() time_us_32()
+ *   Host:  já configurado em host_sim/FreeRTOSConfig.h (relógio monotônico)
+ *
+ * Com SWITCH_COUNT = 1 o trace_hooks.h também conta as trocas de contexto:
+ * só entram as vezes em que o escalonador escolhe uma tarefa diferente da
+ * que estava rodando, não os ticks que devolvem a CPU à mesma tarefa.
+ */
+
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifndef SWITCH_COUNT
+#define SWITCH_COUNT 0
+#endif
+
+#define RUNTIME_STATS_MAX_TASKS  16
+#define RUNTIME_STATS_WINDOW     5     // períodos na janela deslizante
+#define RUNTIME_STATS_PERIOD_MS  1000
+
+typedef struct {
+    const char *name;
+    float usage; // % de CPU na janela deslizante
+    float peak;  // maior % em um único período dentro da janela
+} RuntimeStats_t;
+
+// Cria o timer de amostragem; chamar antes de vTaskStartScheduler()
+bool runtime_stats_init(void);
+
+// Tira uma amostra dos contadores (chamado pelo timer)
+void runtime_stats_sample(void);
+
+// Uso de CPU de uma tarefa (NULL para a tarefa atual)
+bool runtime_stats_get_task(TaskHandle_t task, RuntimeStats_t *stats);
+
+// Uso total de CPU (100% menos o tempo da tarefa idle; média dos núcleos no SMP)
+bool runtime_stats_get_cpu(RuntimeStats_t *stats);
+
+// Uso de um núcleo a partir da idle desse núcleo. No SMP as idles só ficam
+// presas ao seu núcleo depois de core_affinity_pin_idle_tasks()
+bool runtime_stats_get_core(BaseType_t core, RuntimeStats_t *stats);
+
+// Trocas de contexto desde o boot, somando os núcleos; 0 sem SWITCH_COUNT
+uint32_t runtime_stats_get_switches(void);
+
+#endif
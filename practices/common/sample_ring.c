@@ -0,0 +1,86 @@
+#include "sample_ring.h"
+
+// A ordem das escritas importa entre o produtor (ISR do DMA) e os consumidores
+static inline uint32_t load_head(const SampleRing_t *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+}
+
+void sample_ring_init(SampleRing_t *ring, uint16_t *buffer, uint32_t size, uint32_t inflight) {
+    configASSERT(size != 0 && (size & (size - 1)) == 0);
+    configASSERT(inflight < size);
+
+    ring->buffer = buffer;
+    ring->size = size;
+    ring->mask = size - 1;
+    ring->capacity = size - inflight;
+    ring->head = 0;
+    ring->consumer_count = 0;
+}
+
+int sample_ring_add_consumer(SampleRing_t *ring, TaskHandle_t task) {
+    if (ring->consumer_count >= SAMPLE_RING_MAX_CONSUMERS) {
+        return -1;
+    }
+
+    SampleRingConsumer_t *consumer = &ring->consumers[ring->consumer_count];
+    consumer->task = task;
+    consumer->cursor = load_head(ring);
+    consumer->overruns = 0;
+    consumer->dropped_samples = 0;
+    return (int) ring->consumer_count++;
+}
+
+void sample_ring_commit(SampleRing_t *ring, uint32_t count) {
+    __atomic_store_n(&ring->head, ring->head + count, __ATOMIC_RELEASE);
+
+    for (uint32_t i = 0; i < ring->consumer_count; i++) {
+        xTaskNotifyGive(ring->consumers[i].task);
+    }
+}
+
+void sample_ring_commit_from_isr(SampleRing_t *ring, uint32_t count, BaseType_t *pxHigherPriorityTaskWoken) {
+    __atomic_store_n(&ring->head, ring->head + count, __ATOMIC_RELEASE);
+
+    for (uint32_t i = 0; i < ring->consumer_count; i++) {
+        vTaskNotifyGiveFromISR(ring->consumers[i].task, pxHigherPriorityTaskWoken);
+    }
+}
+
+bool sample_ring_wait(SampleRing_t *ring, int consumer, TickType_t timeout) {
+    if (load_head(ring) != ring->consumers[consumer].cursor) {
+        return true;
+    }
+    return ulTaskNotifyTake(pdTRUE, timeout) != 0;
+}
+
+uint32_t sample_ring_peek(SampleRing_t *ring, int consumer, const uint16_t **data) {
+    SampleRingConsumer_t *c = &ring->consumers[consumer];
+    uint32_t head = load_head(ring);
+    uint32_t available = head - c->cursor;
+
+    if (available > ring->capacity) {
+        // Ficou mais de um buffer para trás: descarta tudo e segue da amostra mais nova
+        c->overruns++;
+        c->dropped_samples += available;
+        c->cursor = head;
+        return 0;
+    }
+
+    uint32_t offset = c->cursor & ring->mask;
+    uint32_t contiguous = ring->size - offset;
+
+    *data = &ring->buffer[offset];
+    return available < contiguous ? available : contiguous;
+}
+
+bool sample_ring_release(SampleRing_t *ring, int consumer, uint32_t count) {
+    SampleRingConsumer_t *c = &ring->consumers[consumer];
+    bool valid = load_head(ring) - c->cursor <= ring->capacity;
+
+    if (!valid) {
+        c->overruns++;
+        c->dropped_samples += count;
+    }
+    c->cursor += count;
+    return valid;
+}
@@ -0,0 +1,65 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+/*
+ * Buffer circular de amostras com um produtor e vários consumidores.
+ *
+ * O produtor (DMA do ADC na placa, ADC simulado no host) escreve blocos
+ * direto no buffer e publica com sample_ring_commit(). Cada consumidor tem o
+ * seu próprio cursor, lê as amostras no lugar (sem cópia) e é acordado por
+ * notificação de tarefa. O produtor nunca espera: se um consumidor ficar mais
+ * de um buffer inteiro para trás, ele é ressincronizado na amostra mais nova e
+ * a perda é contada só para ele.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define SAMPLE_RING_MAX_CONSUMERS 4
+
+typedef struct {
+    TaskHandle_t task;
+    uint32_t cursor;          // próxima amostra a ler (contador absoluto)
+    uint32_t overruns;        // vezes em que o produtor passou o consumidor
+    uint32_t dropped_samples; // amostras perdidas nessas ocasiões
+} SampleRingConsumer_t;
+
+typedef struct {
+    uint16_t *buffer;
+    uint32_t size;          // potência de 2
+    uint32_t mask;
+    uint32_t capacity;      // amostras legíveis sem risco de o produtor sobrescrever
+    uint32_t head;          // total de amostras publicadas
+    SampleRingConsumer_t consumers[SAMPLE_RING_MAX_CONSUMERS];
+    uint32_t consumer_count;
+} SampleRing_t;
+
+// size precisa ser potência de 2; inflight é quanto o produtor pode estar
+// escrevendo além da última amostra publicada (os blocos em curso no DMA)
+void sample_ring_init(SampleRing_t *ring, uint16_t *buffer, uint32_t size, uint32_t inflight);
+
+// Registra a tarefa como consumidora; retorna o índice ou -1
+int sample_ring_add_consumer(SampleRing_t *ring, TaskHandle_t task);
+
+// Produtor: posição offset amostras à frente da última publicada
+static inline uint16_t *sample_ring_write_ptr(SampleRing_t *ring, uint32_t offset) {
+    return &ring->buffer[(ring->head + offset) & ring->mask];
+}
+
+// Produtor: publica count amostras e acorda os consumidores
+void sample_ring_commit(SampleRing_t *ring, uint32_t count);
+void sample_ring_commit_from_isr(SampleRing_t *ring, uint32_t count, BaseType_t *pxHigherPriorityTaskWoken);
+
+// Consumidor: bloqueia até haver amostras novas ou estourar o timeout
+bool sample_ring_wait(SampleRing_t *ring, int consumer, TickType_t timeout);
+
+// Consumidor: trecho contíguo disponível para leitura; retorna o tamanho
+uint32_t sample_ring_peek(SampleRing_t *ring, int consumer, const uint16_t **data);
+
+// Consumidor: libera count amostras lidas com sample_ring_peek(). Retorna false
+// se o produtor sobrescreveu o trecho durante a leitura (dados inválidos).
+bool sample_ring_release(SampleRing_t *ring, int consumer, uint32_t count);
+
+#endif
@@ -0,0 +1,47 @@
+#include <string.h>
+#include "hardware/sync.h"
+#include "seqlock.h"
+
+void seqlock_write(Seqlock_t *lock, const void *value) {
+    uint32_t buffer[SEQLOCK_MAX_WORDS];
+    uint32_t words = (lock->size + 3) / 4;
+
+    memcpy(buffer, value, lock->size);
+
+    uint32_t status = save_and_disable_interrupts();
+    uint32_t sequence = lock->sequence;
+
+    __atomic_store_n(&lock->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (uint32_t i = 0; i < words; i++) {
+        __atomic_store_n(&lock->words[i], buffer[i], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&lock->sequence, sequence + 2, __ATOMIC_RELEASE);
+
+    restore_interrupts(status);
+}
+
+uint32_t seqlock_read(const Seqlock_t *lock, void *value) {
+    uint32_t buffer[SEQLOCK_MAX_WORDS];
+    uint32_t words = (lock->size + 3) / 4;
+    uint32_t retries = 0;
+    uint32_t before, after;
+
+    while (1) {
+        before = __atomic_load_n(&lock->sequence, __ATOMIC_ACQUIRE);
+        if ((before & 1) == 0) {
+            for (uint32_t i = 0; i < words; i++) {
+                buffer[i] = __atomic_load_n(&lock->words[i], __ATOMIC_RELAXED);
+            }
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            after = __atomic_load_n(&lock->sequence, __ATOMIC_RELAXED);
+            if (after == before) {
+                break;
+            }
+        }
+        retries++;
+    }
+
+    memcpy(value, buffer, lock->size);
+    return retries;
+}
@@ -0,0 +1,41 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+/*
+ * Publicação de structs pequenas com um escritor e vários leitores (seqlock).
+ *
+ * O escritor incrementa a sequência (fica ímpar), copia o valor e incrementa
+ * de novo; o leitor copia e confere se a sequência era par e não mudou, senão
+ * repete. A escrita roda com as interrupções do core desligadas, então um
+ * leitor no mesmo core nunca encontra uma escrita pela metade e um leitor no
+ * outro core espera no máximo a cópia. Nenhum dos dois lados bloqueia no
+ * escalonador.
+ *
+ * Os dados são copiados em palavras de 32 bits com acesso atômico, então o
+ * valor lido é sempre uma das versões publicadas inteira.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SEQLOCK_MAX_WORDS 16   // maior valor publicado: 64 bytes
+
+typedef struct {
+    uint32_t sequence;   // par = estável, ímpar = escrita em curso
+    uint32_t size;
+    uint32_t *words;
+} Seqlock_t;
+
+// Declara um seqlock com armazenamento para o tipo, já inicializado
+#define SEQLOCK_DEFINE(name, type) \
+    static uint32_t name##_words[(sizeof(type) + 3) / 4]; \
+    _Static_assert(sizeof(type) <= 4 * SEQLOCK_MAX_WORDS, "type too large for a seqlock"); \
+    Seqlock_t name = { 0, sizeof(type), name##_words }
+
+// Só um escritor por seqlock (tarefa ou ISR)
+void seqlock_write(Seqlock_t *lock, const void *value);
+
+// Qualquer tarefa, ISR ou core; devolve quantas vezes a leitura foi repetida
+uint32_t seqlock_read(const Seqlock_t *lock, void *value);
+
+#endif
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "pico/stdlib.h"
+#include "seqlock.h"
+#include "seqlock_bench.h"
+#include "core_affinity.h"
+#include "rtos_alloc.h"
+#include "stack_profile.h"
+
+// Par com invariante: value é sempre stamp truncado
+typedef struct {
+    uint16_t value;
+    uint32_t stamp;
+} BenchPair_t;
+
+SEQLOCK_DEFINE(pairSnapshot, BenchPair_t);
+
+#if SEQLOCK_STRESS
+#define STRESS_READERS 2
+
+static volatile BenchPair_t plainPair;
+static volatile bool stressDone = false;
+static TaskHandle_t writerHandle;
+
+typedef struct {
+    const char *name;
+    uint32_t reads;
+    uint32_t torn;
+    uint32_t retries;
+} StressResult_t;
+
+static StressResult_t stressResults[2] = { { "plain", 0, 0, 0 }, { "seqlock", 0, 0, 0 } };
+
+// Escritor: a cada tick publica uma rajada nas duas cópias, a sem proteção campo a campo
+static void stress_writer_task(void *params) {
+    TickType_t xLastWake = xTaskGetTickCount();
+    TickType_t xEnd = xLastWake + pdMS_TO_TICKS(SEQLOCK_STRESS_MS);
+    uint32_t n = 0;
+
+    while ((int32_t) (xLastWake - xEnd) < 0) {
+        for (int i = 0; i < SEQLOCK_STRESS_BURST; i++) {
+            n++;
+            BenchPair_t pair = { (uint16_t) n, n };
+
+            plainPair.value = pair.value;
+            plainPair.stamp = pair.stamp;
+            seqlock_write(&pairSnapshot, &pair);
+        }
+        vTaskDelayUntil(&xLastWake, 1);
+    }
+
+    // Espera cada leitor somar as suas contagens
+    stressDone = true;
+    for (int i = 0; i < STRESS_READERS; i++) {
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    }
+    for (int i = 0; i < 2; i++) {
+        printf("{\"stress\":\"%s\",\"writes\":%lu,\"reads\":%lu,\"torn\":%lu,\"retries\":%lu}\n",
+               stressResults[i].name, (unsigned long) n, (unsigned long) stressResults[i].reads,
+               (unsigned long) stressResults[i].torn, (unsigned long) stressResults[i].retries);
+    }
+    vTaskDelete(NULL);
+}
+
+// Leitores abaixo do escritor; na placa em SMP rodam também no outro core
+static void stress_reader_task(void *params) {
+    StressResult_t local[2] = { { "plain", 0, 0, 0 }, { "seqlock", 0, 0, 0 } };
+    BenchPair_t pair;
+
+    while (!stressDone) {
+        for (int i = 0; i < SEQLOCK_STRESS_READS; i++) {
+            pair.value = plainPair.value;
+            pair.stamp = plainPair.stamp;
+            local[0].reads++;
+            if (pair.value != (uint16_t) pair.stamp) {
+                local[0].torn++;
+            }
+
+            local[1].retries += seqlock_read(&pairSnapshot, &pair);
+            local[1].reads++;
+            if (pair.value != (uint16_t) pair.stamp) {
+                local[1].torn++;
+            }
+        }
+        vTaskDelay(1); // Bloqueia entre os lotes, o relógio virtual só anda assim
+    }
+
+    // Soma as contagens deste leitor às dos demais
+    taskENTER_CRITICAL();
+    for (int i = 0; i < 2; i++) {
+        stressResults[i].reads += local[i].reads;
+        stressResults[i].torn += local[i].torn;
+        stressResults[i].retries += local[i].retries;
+    }
+    taskEXIT_CRITICAL();
+    xTaskNotifyGive(writerHandle);
+    vTaskDelete(NULL);
+}
+
+bool seqlock_stress_init(UBaseType_t priority) {
+    static const char *const names[STRESS_READERS] = { "StressReader1", "StressReader2" };
+
+    TaskHandle_t reader;
+
+    if (core_affinity_create(stress_writer_task, "StressWriter", 512, NULL, priority + 1, CORE_ROLE_ANY,
+                             &writerHandle) != pdPASS) {
+        return false;
+    }
+    STACK_PROFILE_OWNER(writerHandle, "common");
+    for (int i = 0; i < STRESS_READERS; i++) {
+        if (core_affinity_create(stress_reader_task, names[i], 256, NULL, priority, CORE_ROLE_ANY, &reader) != pdPASS) {
+            return false;
+        }
+        STACK_PROFILE_OWNER(reader, "common");
+    }
+    return true;
+}
+#endif
+
+#if SEQLOCK_BENCH
+static BenchPair_t mutexPair;
+static SemaphoreHandle_t benchMutex;
+
+static void bench_report(const char *name, uint64_t start) {
+    uint64_t elapsed = time_us_64() - start;
+    printf("{\"bench\":\"%s\",\"iterations\":%u,\"mean_ns\":%lu}\n", name, SEQLOCK_BENCH_ITERATIONS,
+           (unsigned long) (elapsed * 1000 / SEQLOCK_BENCH_ITERATIONS));
+}
+
+// Custo médio de publicar e ler o par, sem contenção
+static void seqlock_bench_task(void *params) {
+    BenchPair_t pair = { 0, 0 };
+    volatile uint16_t sink;
+    uint64_t start;
+
+    start = time_us_64();
+    for (uint32_t i = 0; i < SEQLOCK_BENCH_ITERATIONS; i++) {
+        pair.value = (uint16_t) i;
+        seqlock_write(&pairSnapshot, &pair);
+    }
+    bench_report("seqlock_write", start);
+
+    start = time_us_64();
+    for (uint32_t i = 0; i < SEQLOCK_BENCH_ITERATIONS; i++) {
+        seqlock_read(&pairSnapshot, &pair);
+        sink = pair.value;
+    }
+    bench_report("seqlock_read", start);
+
+    start = time_us_64();
+    for (uint32_t i = 0; i < SEQLOCK_BENCH_ITERATIONS; i++) {
+        xSemaphoreTake(benchMutex, portMAX_DELAY);
+        mutexPair.value = (uint16_t) i;
+        mutexPair.stamp = i;
+        xSemaphoreGive(benchMutex);
+    }
+    bench_report("mutex_write", start);
+
+    start = time_us_64();
+    for (uint32_t i = 0; i < SEQLOCK_BENCH_ITERATIONS; i++) {
+        xSemaphoreTake(benchMutex, portMAX_DELAY);
+        pair = mutexPair;
+        xSemaphoreGive(benchMutex);
+        sink = pair.value;
+    }
+    bench_report("mutex_read", start);
+
+    (void) sink;
+    vTaskDelete(NULL);
+}
+
+bool seqlock_bench_init(UBaseType_t priority) {
+    TaskHandle_t task;
+
+    benchMutex = rtos_alloc_mutex("benchMutex");
+    if (benchMutex == NULL ||
+        core_affinity_create(seqlock_bench_task, "SeqlockBench", 512, NULL, priority, CORE_ROLE_ANY, &task) != pdPASS) {
+        return false;
+    }
+    STACK_PROFILE_OWNER(task, "common");
+    return true;
+}
+#endif
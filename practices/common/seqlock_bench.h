@@ -0,0 +1,42 @@
+#ifndef SEQLOCK_BENCH_H
+#define SEQLOCK_BENCH_H
+
+/*
+ * Teste de leituras rasgadas e medida de custo do seqlock contra o mutex.
+ *
+ * Estresse (SEQLOCK_STRESS = 1): um escritor acorda a cada tick e publica uma
+ * rajada de pares cujos dois campos precisam sempre bater, uma vez campo a
+ * campo numa global sem proteção e outra pelo seqlock. Dois leitores de
+ * prioridade menor leem as duas cópias em lotes e contam os pares
+ * misturados; o tick que acorda o escritor os interrompe no meio de uma
+ * leitura. Todas as tarefas bloqueiam entre uma rajada ou lote e outro, então
+ * o teste roda também com o relógio virtual do simulador. Ao final sai uma
+ * linha JSON por cópia: "plain" mostra leituras rasgadas e "seqlock" precisa
+ * mostrar zero.
+ *
+ * Custo (SEQLOCK_BENCH = 1): escrita e leitura de um par pelo seqlock e pelo
+ * par xSemaphoreTake/Give em volta da mesma cópia, sem contenção.
+ */
+
+#include <stdbool.h>
+#include "FreeRTOS.h"
+
+#ifndef SEQLOCK_STRESS
+#define SEQLOCK_STRESS 0
+#endif
+#ifndef SEQLOCK_BENCH
+#define SEQLOCK_BENCH 0
+#endif
+
+#define SEQLOCK_STRESS_MS          2000
+#define SEQLOCK_STRESS_BURST       16      // Pares publicados a cada tick
+#define SEQLOCK_STRESS_READS       20000   // Leituras de cada cópia antes de o leitor ceder o tick
+#define SEQLOCK_BENCH_ITERATIONS   10000
+
+// Cria o escritor (priority + 1) e os dois leitores (priority); antes do scheduler
+bool seqlock_stress_init(UBaseType_t priority);
+
+// Cria a tarefa da medida, que roda uma vez e se remove
+bool seqlock_bench_init(UBaseType_t priority);
+
+#endif
@@ -0,0 +1,225 @@
+#ifdef PICO_SIM
+#define _GNU_SOURCE // pthread_getattr_np
+#include <pthread.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "stack_profile.h"
+#include "core_affinity.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#endif
+
+#if STACK_PROFILE
+
+#if configRECORD_STACK_HIGH_ADDRESS != 1
+#error "stack_profile precisa de configRECORD_STACK_HIGH_ADDRESS = 1"
+#endif
+
+#define STACK_PAINT 0xa5
+
+#ifndef configIDLE_TASK_NAME
+#define configIDLE_TASK_NAME "IDLE"
+#endif
+#ifndef configTIMER_SERVICE_TASK_NAME
+#define configTIMER_SERVICE_TASK_NAME "Tmr Svc"
+#endif
+
+typedef struct {
+    void *task;
+    char name[16];
+    uint32_t words;         // Profundidade pedida no xTaskCreate
+    uint32_t used_bytes;    // Uso final das tarefas deletadas
+    const char *owner;
+    bool deleted;
+#ifdef PICO_SIM
+    const uint8_t *paint_low;   // Faixa pintada da pilha da thread
+    const uint8_t *paint_high;
+    const uint8_t *top;         // Início (endereço mais alto) da pilha da thread
+#endif
+} StackEntry_t;
+
+static StackEntry_t entries[STACK_PROFILE_MAX_TASKS];
+static UBaseType_t entry_count = 0;
+
+static StackEntry_t *find(void *task) {
+    // As deletadas ficam na tabela; o mesmo TCB pode voltar numa tarefa nova
+    for (UBaseType_t i = 0; i < entry_count; i++) {
+        if (entries[i].task == task && !entries[i].deleted) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+// Chamada pelo kernel dentro de seção crítica, ao criar a tarefa
+void stack_profile_on_create(void *task, const char *name, void *stack_low, void *stack_high) {
+    if (entry_count >= STACK_PROFILE_MAX_TASKS) {
+        return;
+    }
+
+    StackEntry_t *entry = &entries[entry_count++];
+    memset(entry, 0, sizeof(*entry));
+    entry->task = task;
+    strncpy(entry->name, name, sizeof(entry->name) - 1);
+    entry->words = (uint32_t) ((StackType_t *) stack_high - (StackType_t *) stack_low) + 1;
+
+    // No SMP as ociosas levam o número do core depois do nome
+    bool kernel = strncmp(name, configIDLE_TASK_NAME, strlen(configIDLE_TASK_NAME)) == 0 ||
+                  strcmp(name, configTIMER_SERVICE_TASK_NAME) == 0;
+    entry->owner = kernel ? "kernel" : "practice";
+}
+
+void stack_profile_set_owner(void *task, const char *owner) {
+    taskENTER_CRITICAL();
+    // A mais recente com o TCB, mesmo que a tarefa já tenha terminado
+    for (UBaseType_t i = entry_count; i-- > 0;) {
+        if (entries[i].task == task) {
+            entries[i].owner = owner;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+static uint32_t used_bytes(const StackEntry_t *entry) {
+#ifdef PICO_SIM
+    if (entry->paint_low != NULL) {
+        // O ponto mais fundo já escrito é o primeiro byte sem a pintura
+        const uint8_t *p = entry->paint_low;
+        while (p < entry->paint_high && *p == STACK_PAINT) {
+            p++;
+        }
+        return (uint32_t) (entry->top - p);
+    }
+#endif
+    UBaseType_t free_words = uxTaskGetStackHighWaterMark((TaskHandle_t) entry->task);
+    return (entry->words - free_words) * sizeof(StackType_t);
+}
+
+// Chamada pelo kernel antes de liberar a pilha da tarefa
+void stack_profile_on_delete(void *task) {
+    StackEntry_t *entry = find(task);
+
+    if (entry != NULL) {
+        entry->used_bytes = used_bytes(entry);
+        entry->deleted = true;
+    }
+}
+
+#ifdef PICO_SIM
+static __thread bool thread_painted = false;
+
+// Pinta a pilha da thread da tarefa atual abaixo do quadro corrente. O uso
+// conta a partir do quadro da função da tarefa, não do topo da thread, onde
+// ficam a TLS e a partida da thread do port POSIX
+__attribute__((no_instrument_function))
+static bool paint_current_thread(const uint8_t *task_frame) {
+    pthread_attr_t attr;
+    void *low;
+    size_t size;
+    size_t guard;
+    StackEntry_t *entry;
+
+    taskENTER_CRITICAL();
+    entry = find(xTaskGetCurrentTaskHandle());
+    taskEXIT_CRITICAL();
+    if (entry == NULL || pthread_getattr_np(pthread_self(), &attr) != 0) {
+        return false;
+    }
+    pthread_attr_getstack(&attr, &low, &size);
+    pthread_attr_getguardsize(&attr, &guard);
+    pthread_attr_destroy(&attr);
+
+    // A página de guarda, quando há, fica no começo da faixa informada
+    low = (uint8_t *) low + guard;
+
+    // Deixa uma margem abaixo do quadro para a red zone e o próprio memset
+    uint8_t *high = (uint8_t *) __builtin_frame_address(0) - 512;
+    memset(low, STACK_PAINT, (size_t) (high - (uint8_t *) low));
+
+    // Acima do ponteiro de quadro estão o quadro anterior salvo e o retorno
+    entry->top = task_frame + 2 * sizeof(void *);
+    entry->paint_high = high;
+    entry->paint_low = low;
+    return true;
+}
+
+// Com -finstrument-functions o GCC chama esta função na entrada de cada função;
+// o quadro de quem chamou só é confiável com -fno-omit-frame-pointer
+__attribute__((no_instrument_function))
+void __cyg_profile_func_enter(void *fn, void *site) {
+    (void) fn;
+    (void) site;
+    if (thread_painted || xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        return;
+    }
+    // Marca antes de pintar: as funções chamadas daqui também passam por aqui
+    thread_painted = true;
+    thread_painted = paint_current_thread(__builtin_frame_address(1));
+}
+
+__attribute__((no_instrument_function))
+void __cyg_profile_func_exit(void *fn, void *site) {
+    (void) fn;
+    (void) site;
+}
+#endif
+
+void stack_profile_report(void) {
+    for (UBaseType_t i = 0; i < entry_count; i++) {
+        const StackEntry_t *entry = &entries[i];
+        uint32_t used = entry->deleted ? entry->used_bytes : used_bytes(entry);
+        uint32_t limit = entry->words * STACK_PROFILE_WORD_BYTES;
+        bool risk = (uint64_t) used * 100 > (uint64_t) limit * (100 - STACK_PROFILE_MARGIN_PCT);
+        const char *source = "kernel";
+
+#ifdef PICO_SIM
+        if (entry->paint_low != NULL) {
+            source = "host";
+        }
+#endif
+        printf("{\"stack\":\"%s\",\"owner\":\"%s\",\"words\":%lu,\"used_bytes\":%lu,\"source\":\"%s\","
+               "\"deleted\":%s,\"risk\":%s}\n",
+               entry->name, entry->owner, (unsigned long) entry->words, (unsigned long) used, source,
+               entry->deleted ? "true" : "false", risk ? "true" : "false");
+    }
+}
+
+#ifndef PICO_SIM
+static void report_loop_task(void *params) {
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(STACK_PROFILE_REPORT_MS));
+        stack_profile_report();
+    }
+}
+#endif
+
+void stack_profile_init(void) {
+#ifdef PICO_SIM
+    sim_at_exit(stack_profile_report);
+#else
+    TaskHandle_t task;
+    if (core_affinity_create(report_loop_task, "StackReport", 512, NULL, tskIDLE_PRIORITY + 1, CORE_ROLE_UI, &task) == pdPASS) {
+        stack_profile_set_owner(task, "common");
+    }
+#endif
+}
+
+#endif
+
+#if configCHECK_FOR_STACK_OVERFLOW > 0
+// A pilha já passou do fim e corrompeu memória vizinha: avisa e para
+void vApplicationStackOverflowHook(TaskHandle_t task, char *name) {
+    (void) task;
+    printf("{\"stack_overflow\":\"%s\"}\n", name);
+#ifdef PICO_SIM
+    sim_exit(1);
+#else
+    panic("stack overflow in %s", name);
+#endif
+}
+#endif
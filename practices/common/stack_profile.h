@@ -0,0 +1,58 @@
+#ifndef STACK_PROFILE_H
+#define STACK_PROFILE_H
+
+/*
+ * Uso de pilha de todas as tarefas, para dimensionar o stack_sizes.h de
+ * cada prática com tools/stack_sizes.py.
+ *
+ * Com STACK_PROFILE = 1 o traceTASK_CREATE (trace_hooks.h) registra o
+ * tamanho da pilha de cada tarefa criada e o traceTASK_DELETE guarda o uso
+ * das que terminam. O relatório é uma linha JSON por tarefa com o tamanho
+ * configurado (palavras), os bytes usados e "risk" quando sobra menos que
+ * STACK_PROFILE_MARGIN_PCT; no host ao final da execução, na placa a cada
+ * STACK_PROFILE_REPORT_MS. Precisa de configRECORD_STACK_HIGH_ADDRESS = 1.
+ *
+ * Na placa o uso vem do uxTaskGetStackHighWaterMark. No host as tarefas
+ * rodam em threads do port POSIX, e a marca do kernel não enxerga a pilha
+ * da thread: compilando com -finstrument-functions -fno-omit-frame-pointer,
+ * a primeira função da prática chamada em cada tarefa pinta a pilha da
+ * thread abaixo dela e o relatório procura o ponto mais fundo escrito.
+ * O código x86-64 usa mais pilha que o Thumb do RP2040, então a medida do
+ * host é folgada.
+ *
+ * Cada linha diz também o dono da tarefa: "practice" por padrão, "kernel"
+ * para a ociosa e a dos timers, e o que o módulo que a criou marcou com
+ * STACK_PROFILE_OWNER ("common" nos módulos de common/, "sim" no simulador).
+ * O tools/stack_sizes.py só dimensiona as da prática.
+ *
+ * Com configCHECK_FOR_STACK_OVERFLOW > 0 este módulo também define o
+ * vApplicationStackOverflowHook, que informa a tarefa e para o sistema.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef STACK_PROFILE
+#define STACK_PROFILE 0
+#endif
+
+#define STACK_PROFILE_MAX_TASKS   24
+#define STACK_PROFILE_MARGIN_PCT  25     // Folga mínima antes de marcar "risk"
+#define STACK_PROFILE_WORD_BYTES  4      // StackType_t da Pico, também usado no host
+#define STACK_PROFILE_REPORT_MS   10000
+
+// Liga o relatório; chamar antes do scheduler
+void stack_profile_init(void);
+
+// Escreve o uso de pilha de todas as tarefas, vivas e já deletadas, em JSON
+void stack_profile_report(void);
+
+#if STACK_PROFILE
+// Dono da tarefa no relatório; chamar logo depois de criá-la
+void stack_profile_set_owner(void *task, const char *owner);
+#define STACK_PROFILE_OWNER(task, owner) stack_profile_set_owner((task), (owner))
+#else
+#define STACK_PROFILE_OWNER(task, owner)
+#endif
+
+#endif
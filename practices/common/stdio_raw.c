@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "stdio_raw.h"
+#ifndef PICO_SIM
+#if LIB_PICO_STDIO_UART
+#include "pico/stdio_uart.h"
+#endif
+#if LIB_PICO_STDIO_USB
+#include "pico/stdio_usb.h"
+#endif
+#endif
+
+// Trechos binários abertos; a tradução só volta quando o último fecha
+static uint32_t open_count = 0;
+
+static void set_translate_crlf(bool translate) {
+#if !defined(PICO_SIM) && PICO_STDIO_ENABLE_CRLF_SUPPORT
+#if LIB_PICO_STDIO_UART
+    stdio_set_translate_crlf(&stdio_uart, translate);
+#endif
+#if LIB_PICO_STDIO_USB
+    stdio_set_translate_crlf(&stdio_usb, translate);
+#endif
+#else
+    (void) translate;
+#endif
+}
+
+void stdio_raw_begin(void) {
+    fflush(stdout); // O texto que já estava no buffer sai ainda com CRLF
+
+    taskENTER_CRITICAL();
+    if (open_count++ == 0) {
+        set_translate_crlf(false);
+    }
+    taskEXIT_CRITICAL();
+}
+
+void stdio_raw_write(const void *data, size_t length) {
+    fwrite(data, 1, length, stdout);
+}
+
+void stdio_raw_frame(uint8_t type, const void *payload, uint8_t length) {
+    const uint8_t header[4] = { DLOG_SYNC0, DLOG_SYNC1, type, length };
+    stdio_raw_write(header, sizeof(header));
+    stdio_raw_write(payload, length);
+}
+
+void stdio_raw_end(void) {
+    fflush(stdout);
+
+    taskENTER_CRITICAL();
+    if (open_count > 0 && --open_count == 0) {
+        set_translate_crlf(true);
+    }
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,34 @@
+#ifndef STDIO_RAW_H
+#define STDIO_RAW_H
+
+/*
+ * Saída binária pelo stdout.
+ *
+ * O stdio do Pico troca cada LF por CRLF, então um byte 0x0A num tamanho,
+ * timestamp ou payload ganharia um 0x0D na frente. Os módulos que mandam
+ * quadros binários ao host (dlog, heap_profile, telemetry, trace_recorder)
+ * escrevem entre stdio_raw_begin() e stdio_raw_end(), que desligam essa
+ * tradução nos drivers de UART e USB só durante o trecho binário; o texto
+ * das outras tarefas continua com CRLF. No host não há tradução.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Quadro binário comum: DLOG_SYNC0 DLOG_SYNC1, tipo, tamanho do payload, payload
+#define DLOG_SYNC0 0xD1
+#define DLOG_SYNC1 0x06
+
+// Esvazia o texto pendente e desliga a tradução LF -> CRLF
+void stdio_raw_begin(void);
+
+// Bytes crus; só entre stdio_raw_begin() e stdio_raw_end()
+void stdio_raw_write(const void *data, size_t length);
+
+// Um quadro com o cabeçalho acima
+void stdio_raw_frame(uint8_t type, const void *payload, uint8_t length);
+
+// Esvazia o que foi escrito e religa a tradução quando o último trecho fecha
+void stdio_raw_end(void);
+
+#endif
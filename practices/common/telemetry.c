@@ -0,0 +1,527 @@
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#if TELEMETRY_UART_DMA && !defined(PICO_SIM)
+#include "hardware/dma.h"
+#include "hardware/uart.h"
+#endif
+#include "telemetry.h"
+#include "cycle_count.h"
+#include "stdio_raw.h"
+#include "core_affinity.h"
+#include "stack_profile.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#endif
+
+#ifndef TELEMETRY_UART
+#define TELEMETRY_UART uart0
+#endif
+
+#define HEADER_BYTES  6    // tipo, sequência, instante
+#define CRC_BYTES     2
+#define MAX_PAYLOAD   64
+#define MAX_RAW       (HEADER_BYTES + MAX_PAYLOAD + CRC_BYTES)
+#define MAX_FRAME     (MAX_RAW + 2)   // Um byte de código COBS (registro < 254 bytes) e o 0x00
+
+_Static_assert(2 + 2 * TELEMETRY_ADC_SAMPLES <= MAX_PAYLOAD, "registro adc maior que MAX_PAYLOAD");
+_Static_assert(MAX_RAW < 254, "o COBS de um registro precisa de um só byte de código");
+
+// Lote: um 0x00 inicial e os quadros
+typedef struct {
+    uint8_t data[TELEMETRY_BUFFER_BYTES];
+    uint32_t length;
+} TxBuffer_t;
+
+static TxBuffer_t buffers[2];
+static uint32_t filling = 0;      // Buffer que recebe os quadros
+static bool pending = false;      // O outro buffer espera o envio
+static bool sending = false;
+static uint8_t sequence = 0;
+static spin_lock_t *lock;
+static TaskHandle_t txTask;
+static TelemetryStats_t stats;
+static uint64_t startUs;
+
+// Dicionário de nomes dos eventos
+static const char *names[TELEMETRY_MAX_NAMES];
+static bool nameSent[TELEMETRY_MAX_NAMES];
+static uint16_t nameCount = 0;
+
+#if TELEMETRY_UART_DMA && !defined(PICO_SIM)
+static int dmaChannel;
+#endif
+
+// CRC-16/CCITT (polinômio 0x1021, início 0xFFFF), meio byte por vez
+static uint16_t crc16(const uint8_t *data, uint32_t length) {
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+        0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+    };
+    uint16_t crc = 0xFFFF;
+
+    for (uint32_t i = 0; i < length; i++) {
+        crc = (uint16_t) (crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (uint16_t) (crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+static void put_u16(uint8_t *out, uint16_t value) {
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+    put_u16(out, (uint16_t) value);
+    put_u16(out + 2, (uint16_t) (value >> 16));
+}
+
+// Sequência, CRC e COBS de um registro já montado; retorna os bytes do quadro
+static uint32_t frame_record(uint8_t *raw, uint32_t payload_length, uint8_t seq, uint8_t *out) {
+    uint32_t length = HEADER_BYTES + payload_length;
+    uint32_t code_at = 0;
+    uint32_t n = 1;
+    uint8_t code = 1;
+
+    raw[1] = seq;
+    put_u16(&raw[length], crc16(raw, length));
+    length += CRC_BYTES;
+
+    // Cada zero vira a distância até o próximo; o registro nunca chega a 254 bytes
+    for (uint32_t i = 0; i < length; i++) {
+        if (raw[i] == 0) {
+            out[code_at] = code;
+            code_at = n++;
+            code = 1;
+        } else {
+            out[n++] = raw[i];
+            code++;
+        }
+    }
+    out[code_at] = code;
+    out[n++] = 0;
+    return n;
+}
+
+// Tipo e instante; a sequência é escrita só na hora de enfileirar
+static void begin_record(uint8_t *raw, uint8_t type) {
+    raw[0] = type;
+    put_u32(&raw[2], time_us_32());
+}
+
+static bool send_record(uint8_t *raw, uint32_t payload_length, uint32_t start) {
+    uint32_t frame_length = HEADER_BYTES + payload_length + CRC_BYTES + 2;
+    bool ok = false;
+    bool wake = false;
+
+    if (lock == NULL) {
+        return false;
+    }
+
+    // O quadro é montado direto no buffer, com as interrupções desligadas
+    // (no máximo MAX_FRAME bytes), para a sequência seguir a ordem do fluxo
+    uint32_t saved = spin_lock_blocking(lock);
+    TxBuffer_t *buffer = &buffers[filling];
+    if (buffer->length + frame_length > sizeof(buffer->data) && !pending) {
+        pending = true;
+        filling ^= 1;
+        buffer = &buffers[filling];
+        wake = true;
+    }
+    if (buffer->length + frame_length <= sizeof(buffer->data)) {
+        buffer->length += frame_record(raw, payload_length, sequence++, &buffer->data[buffer->length]);
+        stats.records++;
+        stats.encode_ns += cycle_count_elapsed_ns(start, cycle_count_now());
+        ok = true;
+    } else {
+        stats.dropped++;
+    }
+    spin_unlock(lock, saved);
+
+    if (wake && txTask != NULL) {
+        xTaskNotifyGive(txTask);
+    }
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Registros
+
+static uint32_t task_payload(uint8_t *payload, const char *name, uint32_t usage_centi, uint32_t peak_centi) {
+    memset(payload, 0, TELEMETRY_NAME_LEN);
+    strncpy((char *) payload, name, TELEMETRY_NAME_LEN);
+    put_u16(&payload[TELEMETRY_NAME_LEN], (uint16_t) (usage_centi > 0xFFFF ? 0xFFFF : usage_centi));
+    put_u16(&payload[TELEMETRY_NAME_LEN + 2], (uint16_t) (peak_centi > 0xFFFF ? 0xFFFF : peak_centi));
+    return TELEMETRY_NAME_LEN + 4;
+}
+
+static uint32_t adc_payload(uint8_t *payload, uint8_t channel, const uint16_t *samples, uint32_t count) {
+    payload[0] = channel;
+    payload[1] = (uint8_t) count;
+    for (uint32_t i = 0; i < count; i++) {
+        put_u16(&payload[2 + 2 * i], samples[i]);
+    }
+    return 2 + 2 * count;
+}
+
+static uint32_t heap_payload(uint8_t *payload, const TelemetryHeap_t *heap) {
+    const uint32_t fields[] = {
+        heap->total, heap->free, heap->min_ever, heap->pool_in_use,
+        heap->pool_blocks, heap->pool_failures, heap->fallback_in_use,
+    };
+
+    for (uint32_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        put_u32(&payload[4 * i], fields[i]);
+    }
+    return sizeof(fields);
+}
+
+static uint32_t event_payload(uint8_t *payload, uint16_t id, uint32_t value) {
+    put_u16(payload, id);
+    put_u32(&payload[2], value);
+    return 6;
+}
+
+bool telemetry_task(const char *name, uint32_t usage_centi, uint32_t peak_centi) {
+    uint32_t start = cycle_count_now();
+    uint8_t raw[MAX_RAW];
+
+    begin_record(raw, TELEMETRY_RECORD_TASK);
+    return send_record(raw, task_payload(&raw[HEADER_BYTES], name, usage_centi, peak_centi), start);
+}
+
+bool telemetry_adc(uint8_t channel, const uint16_t *samples, uint32_t count) {
+    bool ok = true;
+
+    // Blocos maiores viram vários registros
+    while (count > 0) {
+        uint32_t start = cycle_count_now();
+        uint32_t n = count < TELEMETRY_ADC_SAMPLES ? count : TELEMETRY_ADC_SAMPLES;
+        uint8_t raw[MAX_RAW];
+
+        begin_record(raw, TELEMETRY_RECORD_ADC);
+        ok &= send_record(raw, adc_payload(&raw[HEADER_BYTES], channel, samples, n), start);
+        samples += n;
+        count -= n;
+    }
+    return ok;
+}
+
+bool telemetry_heap(const TelemetryHeap_t *heap) {
+    uint32_t start = cycle_count_now();
+    uint8_t raw[MAX_RAW];
+
+    begin_record(raw, TELEMETRY_RECORD_HEAP);
+    return send_record(raw, heap_payload(&raw[HEADER_BYTES], heap), start);
+}
+
+// ID do nome; na primeira vez (ou até o nome conseguir lugar num lote) envia o texto
+static uint16_t name_id(const char *name) {
+    uint16_t id = 0xFFFF;
+    bool send_name = false;
+
+    uint32_t saved = spin_lock_blocking(lock);
+    for (uint16_t i = 0; i < nameCount; i++) {
+        if (names[i] == name) {
+            id = i;
+            break;
+        }
+    }
+    if (id == 0xFFFF && nameCount < TELEMETRY_MAX_NAMES) {
+        id = nameCount++;
+        names[id] = name;
+    }
+    send_name = id != 0xFFFF && !nameSent[id];
+    spin_unlock(lock, saved);
+
+    if (send_name) {
+        uint32_t start = cycle_count_now();
+        uint8_t raw[MAX_RAW];
+        size_t length = strlen(name);
+
+        if (length > MAX_PAYLOAD - 2) {
+            length = MAX_PAYLOAD - 2;
+        }
+        begin_record(raw, TELEMETRY_RECORD_NAME);
+        put_u16(&raw[HEADER_BYTES], id);
+        memcpy(&raw[HEADER_BYTES + 2], name, length);
+        if (send_record(raw, (uint32_t) (2 + length), start)) {
+            nameSent[id] = true;
+        }
+    }
+    return id;
+}
+
+bool telemetry_event(const char *name, uint32_t value) {
+    if (lock == NULL) {
+        return false;
+    }
+
+    uint16_t id = name_id(name);
+    uint32_t start = cycle_count_now();
+    uint8_t raw[MAX_RAW];
+
+    begin_record(raw, TELEMETRY_RECORD_EVENT);
+    return send_record(raw, event_payload(&raw[HEADER_BYTES], id, value), start);
+}
+
+// ---------------------------------------------------------------------------
+// Envio
+
+static void transmit(const uint8_t *data, uint32_t length) {
+#if TELEMETRY_UART_DMA && !defined(PICO_SIM)
+    dma_channel_transfer_from_buffer_now(dmaChannel, data, length);
+    while (dma_channel_is_busy(dmaChannel)) {
+        vTaskDelay(1);
+    }
+#else
+    stdio_raw_begin();
+    stdio_raw_write(data, length);
+    stdio_raw_end();
+#endif
+}
+
+// Envia o buffer pendente; sem nenhum pendente, fecha o lote em curso antes
+static void transmit_pending(void) {
+    uint32_t saved = spin_lock_blocking(lock);
+    if (sending) {
+        spin_unlock(lock, saved);
+        return;
+    }
+    if (!pending && buffers[filling].length > 1) {
+        pending = true;
+        filling ^= 1;
+    }
+    sending = pending;
+    spin_unlock(lock, saved);
+
+    if (!sending) {
+        return;
+    }
+
+    // Enquanto pending estiver ligado ninguém troca o buffer em preenchimento
+    TxBuffer_t *buffer = &buffers[filling ^ 1];
+    transmit(buffer->data, buffer->length);
+
+    saved = spin_lock_blocking(lock);
+    stats.bytes += buffer->length;
+    stats.batches++;
+    buffer->length = 1;
+    pending = false;
+    sending = false;
+    spin_unlock(lock, saved);
+}
+
+static void telemetry_tx_task(void *params) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TELEMETRY_FLUSH_MS));
+        transmit_pending();
+    }
+}
+
+void telemetry_flush(void) {
+    if (lock == NULL) {
+        return;
+    }
+    transmit_pending(); // O lote já fechado
+    transmit_pending(); // O que estava em preenchimento
+}
+
+void telemetry_get_stats(TelemetryStats_t *out) {
+    uint32_t saved = spin_lock_blocking(lock);
+    *out = stats;
+    spin_unlock(lock, saved);
+}
+
+void telemetry_report(void) {
+    TelemetryStats_t current;
+    uint64_t elapsed = time_us_64() - startUs;
+
+    telemetry_get_stats(&current);
+    printf("{\"telemetry\":{\"records\":%lu,\"dropped\":%lu,\"bytes\":%lu,\"batches\":%lu,"
+           "\"bytes_per_s\":%lu,\"encode_ns_per_record\":%lu}}\n",
+           (unsigned long) current.records, (unsigned long) current.dropped,
+           (unsigned long) current.bytes, (unsigned long) current.batches,
+           (unsigned long) (elapsed > 0 ? (uint64_t) current.bytes * 1000000u / elapsed : 0),
+           (unsigned long) (current.records ? current.encode_ns / current.records : 0));
+}
+
+#ifdef PICO_SIM
+// No fim da execução os quadros pendentes saem antes do relatório em texto
+static void telemetry_exit(void) {
+    telemetry_flush();
+    telemetry_report();
+}
+#endif
+
+bool telemetry_init(UBaseType_t priority) {
+    lock = spin_lock_init(spin_lock_claim_unused(true));
+    for (int i = 0; i < 2; i++) {
+        buffers[i].data[0] = 0;
+        buffers[i].length = 1;
+    }
+    startUs = time_us_64();
+
+#if TELEMETRY_UART_DMA && !defined(PICO_SIM)
+    dmaChannel = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(dmaChannel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, uart_get_dreq(TELEMETRY_UART, true));
+    dma_channel_configure(dmaChannel, &config, &uart_get_hw(TELEMETRY_UART)->dr, NULL, 0, false);
+#endif
+
+#ifdef PICO_SIM
+    sim_at_exit(telemetry_exit);
+#endif
+    if (core_affinity_create(telemetry_tx_task, "TelemetryTx", 512, NULL, priority, CORE_ROLE_UI, &txTask) != pdPASS) {
+        return false;
+    }
+    STACK_PROFILE_OWNER(txTask, "common");
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Comparação com texto
+
+// Na placa o stdio põe um CR antes de cada LF do texto; os quadros saem sem tradução
+#if !defined(PICO_SIM) && PICO_STDIO_ENABLE_CRLF_SUPPORT && PICO_STDIO_DEFAULT_CRLF
+#define TEXT_CR_PER_LINE 1
+#else
+#define TEXT_CR_PER_LINE 0
+#endif
+
+typedef struct {
+    uint64_t bytes;  // Bytes que saem no fio
+    uint64_t us;     // Codificação ou formatação mais a escrita no stdout, do lote inteiro
+} BenchCost_t;
+
+static void bench_print(const char *record, const BenchCost_t *binary, const BenchCost_t *text) {
+    printf("{\"telemetry_bench\":\"%s\",\"records\":%u,"
+           "\"binary\":{\"bytes\":%lu,\"ns\":%lu},\"text\":{\"bytes\":%lu,\"ns\":%lu}}\n",
+           record, TELEMETRY_BENCH_RECORDS,
+           (unsigned long) (binary->bytes / TELEMETRY_BENCH_RECORDS),
+           (unsigned long) (binary->us * 1000u / TELEMETRY_BENCH_RECORDS),
+           (unsigned long) (text->bytes / TELEMETRY_BENCH_RECORDS),
+           (unsigned long) (text->us * 1000u / TELEMETRY_BENCH_RECORDS));
+}
+
+// Quadro pronto até o fim da escrita, entre stdio_raw_begin() e stdio_raw_end()
+static void bench_binary(BenchCost_t *cost, uint8_t *raw, uint32_t payload_length, uint8_t seq) {
+    static uint8_t frame[MAX_FRAME];
+    uint32_t length = frame_record(raw, payload_length, seq, frame);
+
+    stdio_raw_write(frame, length);
+    cost->bytes += length;
+}
+
+// printf devolve os bytes entregues ao stdio, sem os CRs que o driver acrescenta
+static void bench_text(BenchCost_t *cost, int written, uint32_t lines) {
+    cost->bytes += (uint64_t) (written > 0 ? written : 0) + lines * TEXT_CR_PER_LINE;
+}
+
+// Cada lote leva vários ms pela UART, bem mais que um tick: mede com o timer
+void telemetry_bench(void) {
+    uint8_t raw[MAX_RAW];
+    uint16_t samples[TELEMETRY_ADC_SAMPLES];
+    const TelemetryHeap_t heap = { 131072, 101376, 98304, 11, 64, 0, 2 };
+    BenchCost_t binary;
+    BenchCost_t text;
+    uint64_t start;
+
+    for (uint32_t i = 0; i < TELEMETRY_ADC_SAMPLES; i++) {
+        samples[i] = (uint16_t) (1950 + 7 * i);
+    }
+
+    // Uso de CPU de uma tarefa, como nas práticas do Idle Hook e do ADC
+    binary = (BenchCost_t) { 0 };
+    text = (BenchCost_t) { 0 };
+    stdio_raw_begin();
+    start = time_us_64();
+    for (uint32_t i = 0; i < TELEMETRY_BENCH_RECORDS; i++) {
+        begin_record(raw, TELEMETRY_RECORD_TASK);
+        bench_binary(&binary, raw, task_payload(&raw[HEADER_BYTES], "Blink LED1 Task", 1200 + i % 100, 1500),
+                     (uint8_t) i);
+    }
+    binary.us = time_us_64() - start;
+    stdio_raw_end();
+    start = time_us_64();
+    for (uint32_t i = 0; i < TELEMETRY_BENCH_RECORDS; i++) {
+        uint32_t usage = 1200 + i % 100;
+        int written = printf("%s Task CPU: %lu.%02lu%% (peak %lu.%02lu%%)\n", "Blink LED1 Task",
+                             (unsigned long) (usage / 100), (unsigned long) (usage % 100), 15ul, 0ul);
+        bench_text(&text, written, 1);
+    }
+    text.us = time_us_64() - start;
+    bench_print("task", &binary, &text);
+
+    // Um registro de amostras contra uma linha por amostra
+    binary = (BenchCost_t) { 0 };
+    text = (BenchCost_t) { 0 };
+    stdio_raw_begin();
+    start = time_us_64();
+    for (uint32_t i = 0; i < TELEMETRY_BENCH_RECORDS; i++) {
+        begin_record(raw, TELEMETRY_RECORD_ADC);
+        bench_binary(&binary, raw, adc_payload(&raw[HEADER_BYTES], 0, samples, TELEMETRY_ADC_SAMPLES),
+                     (uint8_t) i);
+    }
+    binary.us = time_us_64() - start;
+    stdio_raw_end();
+    start = time_us_64();
+    for (uint32_t i = 0; i < TELEMETRY_BENCH_RECORDS; i++) {
+        int written = 0;
+        for (uint32_t s = 0; s < TELEMETRY_ADC_SAMPLES; s++) {
+            written += printf("ADC Value: %u\n", (unsigned) samples[s]);
+        }
+        bench_text(&text, written, TELEMETRY_ADC_SAMPLES);
+    }
+    text.us = time_us_64() - start;
+    bench_print("adc", &binary, &text);
+
+    // Estado do heap e dos pools, como no monitor da prática do heap
+    binary = (BenchCost_t) { 0 };
+    text = (BenchCost_t) { 0 };
+    stdio_raw_begin();
+    start = time_us_64();
+    for (uint32_t i = 0; i < TELEMETRY_BENCH_RECORDS; i++) {
+        begin_record(raw, TELEMETRY_RECORD_HEAP);
+        bench_binary(&binary, raw, heap_payload(&raw[HEADER_BYTES], &heap), (uint8_t) i);
+    }
+    binary.us = time_us_64() - start;
+    stdio_raw_end();
+    start = time_us_64();
+    for (uint32_t i = 0; i < TELEMETRY_BENCH_RECORDS; i++) {
+        int written = printf("Heap livre: %lu bytes (mínimo %lu de %lu)\nPools: %lu/%lu em uso, falhas %lu\n"
+                             "Fallback para o heap: %lu em uso\n",
+                             (unsigned long) heap.free, (unsigned long) heap.min_ever, (unsigned long) heap.total,
+                             (unsigned long) heap.pool_in_use, (unsigned long) heap.pool_blocks,
+                             (unsigned long) heap.pool_failures, (unsigned long) heap.fallback_in_use);
+        bench_text(&text, written, 3);
+    }
+    text.us = time_us_64() - start;
+    bench_print("heap", &binary, &text);
+
+    // Evento com nome já no dicionário
+    binary = (BenchCost_t) { 0 };
+    text = (BenchCost_t) { 0 };
+    stdio_raw_begin();
+    start = time_us_64();
+    for (uint32_t i = 0; i < TELEMETRY_BENCH_RECORDS; i++) {
+        begin_record(raw, TELEMETRY_RECORD_EVENT);
+        bench_binary(&binary, raw, event_payload(&raw[HEADER_BYTES], 0, i & 1), (uint8_t) i);
+    }
+    binary.us = time_us_64() - start;
+    stdio_raw_end();
+    start = time_us_64();
+    for (uint32_t i = 0; i < TELEMETRY_BENCH_RECORDS; i++) {
+        int written = printf("LED State: %s\n", (i & 1) ? "ON" : "OFF");
+        bench_text(&text, written, 1);
+    }
+    text.us = time_us_64() - start;
+    bench_print("event", &binary, &text);
+}
@@ -0,0 +1,104 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/*
+ * Telemetria binária: registros de tamanho fixo em vez de texto formatado.
+ *
+ * Cada registro é tipo (u8), sequência (u8), instante (u32 µs) e a carga,
+ * seguidos de um CRC-16/CCITT (u16) de tudo isso. O registro vai codificado
+ * em COBS e terminado por 0x00, então um byte perdido estraga só o próprio
+ * quadro e o decodificador se realinha no próximo zero. Inteiros em
+ * little-endian.
+ *
+ * Os quadros são acumulados em um de dois buffers de TELEMETRY_BUFFER_BYTES.
+ * Quando o buffer enche, ou a cada TELEMETRY_FLUSH_MS, a tarefa TelemetryTx
+ * envia o buffer inteiro de uma vez (um fwrite no stdio, USB CDC ou host, ou
+ * uma transferência de DMA para a UART com TELEMETRY_UART_DMA = 1) enquanto
+ * o outro recebe os quadros seguintes. Cada lote começa com um 0x00, o que
+ * separa os quadros de qualquer texto impresso antes. Com os dois buffers
+ * ocupados o registro é descartado e contado, nunca bloqueia.
+ *
+ * Registros:
+ *   0x01 task:  nome (16 bytes), uso e pico de CPU em centésimos de % (u16)
+ *   0x02 adc:   canal (u8), n (u8), n amostras (u16)
+ *   0x03 heap:  total, livre, mínimo já visto, blocos de pool em uso, blocos
+ *               de pool, falhas de pool, blocos no fallback (u32)
+ *   0x04 event: id (u16), valor (u32)
+ *   0x05 name:  id (u16), texto; enviado antes do primeiro evento com o nome
+ *
+ * tools/telemetry_decode.py converte o fluxo para JSON ou CSV.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+#ifndef TELEMETRY
+#define TELEMETRY 0
+#endif
+
+#ifndef TELEMETRY_BENCH
+#define TELEMETRY_BENCH 0
+#endif
+
+#ifndef TELEMETRY_UART_DMA
+#define TELEMETRY_UART_DMA 0
+#endif
+
+#define TELEMETRY_BUFFER_BYTES  512
+#define TELEMETRY_FLUSH_MS      50
+#define TELEMETRY_NAME_LEN      16
+#define TELEMETRY_ADC_SAMPLES   24     // Amostras por registro adc
+#define TELEMETRY_MAX_NAMES     32
+#define TELEMETRY_BENCH_RECORDS 1000
+
+#define TELEMETRY_RECORD_TASK   0x01
+#define TELEMETRY_RECORD_ADC    0x02
+#define TELEMETRY_RECORD_HEAP   0x03
+#define TELEMETRY_RECORD_EVENT  0x04
+#define TELEMETRY_RECORD_NAME   0x05
+
+typedef struct {
+    uint32_t total;
+    uint32_t free;
+    uint32_t min_ever;
+    uint32_t pool_in_use;
+    uint32_t pool_blocks;
+    uint32_t pool_failures;
+    uint32_t fallback_in_use;
+} TelemetryHeap_t;
+
+typedef struct {
+    uint32_t records;      // Registros aceitos
+    uint32_t dropped;      // Registros descartados com os dois buffers ocupados
+    uint32_t bytes;        // Bytes entregues ao transmissor
+    uint32_t batches;
+    uint64_t encode_ns;    // Tempo montando e codificando os registros
+} TelemetryStats_t;
+
+// Cria a tarefa de envio; chamar antes do scheduler
+bool telemetry_init(UBaseType_t priority);
+
+// Publicação, só em tarefas. Retornam false se o registro foi descartado
+bool telemetry_task(const char *name, uint32_t usage_centi, uint32_t peak_centi);
+bool telemetry_adc(uint8_t channel, const uint16_t *samples, uint32_t count);
+bool telemetry_heap(const TelemetryHeap_t *heap);
+
+// name precisa ser uma string com endereço fixo (o ponteiro é a chave)
+bool telemetry_event(const char *name, uint32_t value);
+
+// Envia na hora o que estiver nos buffers (fim da execução no host)
+void telemetry_flush(void);
+
+void telemetry_get_stats(TelemetryStats_t *stats);
+
+// Uma linha JSON com os totais e a taxa desde o boot
+void telemetry_report(void);
+
+// Compara cada registro, codificado e escrito no stdout, com o texto
+// equivalente saindo por printf: tempo até o fim da escrita e bytes no fio.
+// Os quadros e o texto do teste vão para o stdout; uma linha JSON por tipo.
+// Chamar de uma tarefa, com o scheduler rodando
+void telemetry_bench(void);
+
+#endif
@@ -0,0 +1,255 @@
+#ifdef PICO_SIM
+#define _GNU_SOURCE // clock_nanosleep
+#include <errno.h>
+#include <sys/time.h>
+#include <time.h>
+#endif
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "tickless.h"
+#include "core_affinity.h"
+#include "stack_profile.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#else
+#include "hardware/clocks.h"
+#include "hardware/structs/scb.h"
+#include "hardware/structs/systick.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#endif
+
+#if TICKLESS_IDLE
+
+#if configUSE_TICKLESS_IDLE != 1
+#error "TICKLESS_IDLE precisa de configUSE_TICKLESS_IDLE = 1"
+#endif
+#if configNUMBER_OF_CORES > 1
+#error "tickless só no build de um núcleo (configNUMBER_OF_CORES = 1)"
+#endif
+
+static TicklessStats_t stats;
+static uint64_t init_us = 0;
+
+// Fase do tick: instante em que o tick 0 teria ocorrido no relógio
+static bool phase_known = false;
+static int64_t phase_min_us;
+static int64_t phase_max_us;
+
+// Ticks cujas fronteiras passaram entre next_tick_us e woke_us, até expected
+static TickType_t ticks_passed(uint64_t next_tick_us, uint64_t woke_us, TickType_t expected) {
+    if (woke_us < next_tick_us) {
+        return 0;
+    }
+    uint64_t ticks = 1 + (woke_us - next_tick_us) / TICKLESS_TICK_US;
+    return ticks < expected ? (TickType_t) ticks : expected;
+}
+
+// Chamado com o escalonador suspenso, depois de acordar
+static void account(TickType_t count, uint64_t next_tick_us, uint64_t start_us, uint64_t wake_at_us,
+                    uint64_t woke_us, TickType_t ticks) {
+    int64_t phase = (int64_t) next_tick_us - (int64_t) (count + 1) * TICKLESS_TICK_US;
+
+    if (!phase_known || phase < phase_min_us) {
+        phase_min_us = phase;
+    }
+    if (!phase_known || phase > phase_max_us) {
+        phase_max_us = phase;
+    }
+    phase_known = true;
+
+    stats.sleeps++;
+    stats.asleep_us += woke_us - start_us;
+    stats.suppressed_ticks += ticks;
+    if (ticks > 0) {
+        stats.avoided_wakeups += ticks - 1; // Um despertar no lugar de ticks
+    }
+    if (woke_us < wake_at_us) {
+        stats.early_wakes++;
+    } else if (woke_us - wake_at_us > stats.max_late_us) {
+        stats.max_late_us = (uint32_t) (woke_us - wake_at_us);
+    }
+}
+
+#ifdef PICO_SIM
+
+static uint64_t timeval_us(const struct timeval *tv) {
+    return (uint64_t) tv->tv_sec * 1000000ULL + (uint64_t) tv->tv_usec;
+}
+
+// Dorme até o instante wake_at_us do relógio simulado; o sinal do tick pode interromper
+static void sleep_until(uint64_t wake_at_us) {
+    uint64_t now;
+    while ((now = sim_time_us()) < wake_at_us) {
+        struct timespec ts = {
+            .tv_sec = (time_t) ((wake_at_us - now) / 1000000ULL),
+            .tv_nsec = (long) ((wake_at_us - now) % 1000000ULL) * 1000L,
+        };
+        if (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, NULL) != 0 && errno != EINTR) {
+            return;
+        }
+    }
+}
+
+void tickless_sleep(TickType_t expected_ticks) {
+    struct itimerval off = { 0 };
+    struct itimerval tick;
+
+    // A SimIRQ é uma tarefa, então o despertar dela já limita expected_ticks
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        return;
+    }
+
+    uint64_t start = sim_time_us();
+    setitimer(ITIMER_REAL, &off, &tick);
+    TickType_t count = xTaskGetTickCount();
+    bool stopped = tick.it_value.tv_sec != 0 || tick.it_value.tv_usec != 0;
+    stats.tick_stopped = stopped;
+
+    if (!stopped) {
+        // O tick continua numa thread do port e fica pendente até a idle
+        // retomar o escalonador; acorda um tick antes para não atrasar ninguém
+        uint64_t wake_at = start + (uint64_t) (expected_ticks - 1) * TICKLESS_TICK_US;
+        sleep_until(wake_at);
+        uint64_t woke = sim_time_us();
+        account(count, start, start, wake_at, woke, ticks_passed(start, woke, expected_ticks));
+        return;
+    }
+
+    uint64_t next_tick = start + timeval_us(&tick.it_value);
+    uint64_t wake_at = next_tick + (uint64_t) (expected_ticks - 1) * TICKLESS_TICK_US;
+    sleep_until(wake_at);
+
+    uint64_t woke = sim_time_us();
+    TickType_t ticks = ticks_passed(next_tick, woke, expected_ticks);
+    uint64_t boundary = next_tick + (uint64_t) ticks * TICKLESS_TICK_US;
+    uint64_t now = sim_time_us();
+    uint64_t remaining = boundary > now ? boundary - now : 1;
+
+    // Religa o timer alinhado à próxima fronteira do tick, medida de novo
+    // para o tempo gasto aqui não se acumular a cada sono
+    tick.it_value.tv_sec = (time_t) (remaining / 1000000ULL);
+    tick.it_value.tv_usec = (suseconds_t) (remaining % 1000000ULL);
+    setitimer(ITIMER_REAL, &tick, NULL);
+    vTaskStepTick(ticks);
+
+    account(count, next_tick, start, wake_at, woke, ticks);
+}
+
+void tickless_init(void) {
+    init_us = time_us_64();
+    sim_at_exit(tickless_report);
+}
+
+#else
+
+static int alarm_num = -1;
+
+// Só tira o núcleo do WFI; os ticks são contados em tickless_sleep()
+static void alarm_callback(uint alarm) {
+    (void) alarm;
+}
+
+void tickless_sleep(TickType_t expected_ticks) {
+    uint32_t status = save_and_disable_interrupts();
+
+    if (alarm_num < 0 || eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        restore_interrupts(status);
+        return;
+    }
+
+    // O port do RP2040 alimenta o SysTick com o clk_sys
+    uint32_t reload = systick_hw->rvr + 1;
+    uint32_t cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+
+    systick_hw->csr &= ~M0PLUS_SYST_CSR_ENABLE_BITS;
+    uint64_t start = time_us_64();
+    TickType_t count = xTaskGetTickCount();
+    uint64_t next_tick = start + systick_hw->cvr / cycles_per_us;
+
+    // O SysTick pode ter zerado antes de ser parado, com a interrupção ainda
+    // pendente: esse tick já passou e entra na conta daqui, como no port
+    TickType_t pending = 0;
+    if (scb_hw->icsr & M0PLUS_ICSR_PENDSTSET_BITS) {
+        scb_hw->icsr = M0PLUS_ICSR_PENDSTCLR_BITS;
+        pending = 1;
+    }
+    uint64_t wake_at = next_tick + (uint64_t) (expected_ticks - 1 - pending) * TICKLESS_TICK_US;
+
+    // Com interrupções desabilitadas o WFI ainda acorda com uma pendente
+    if (!hardware_alarm_set_target(alarm_num, from_us_since_boot(wake_at))) {
+        __wfi();
+    }
+
+    uint64_t woke = time_us_64();
+    hardware_alarm_cancel(alarm_num);
+
+    TickType_t ticks = ticks_passed(next_tick, woke, expected_ticks - pending);
+    uint64_t boundary = next_tick + (uint64_t) ticks * TICKLESS_TICK_US;
+    uint32_t remaining = boundary > woke ? (uint32_t) (boundary - woke) : 1;
+    ticks += pending;
+
+    // O primeiro período vai até a fronteira; o reload normal vale a partir do seguinte
+    systick_hw->rvr = remaining * cycles_per_us - 1;
+    systick_hw->cvr = 0;
+    systick_hw->csr |= M0PLUS_SYST_CSR_ENABLE_BITS;
+    systick_hw->rvr = reload - 1;
+    vTaskStepTick(ticks);
+
+    // Com um tick pendente, next_tick é a fronteira do tick count + 2
+    account(count + pending, next_tick, start, wake_at, woke, ticks);
+    restore_interrupts(status);
+}
+
+static void report_loop_task(void *params) {
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(TICKLESS_REPORT_MS));
+        tickless_report();
+    }
+}
+
+void tickless_init(void) {
+    init_us = time_us_64();
+    stats.tick_stopped = true;
+    alarm_num = hardware_alarm_claim_unused(true);
+    hardware_alarm_set_callback(alarm_num, alarm_callback);
+    TaskHandle_t task;
+    if (core_affinity_create(report_loop_task, "TicklessReport", 512, NULL, tskIDLE_PRIORITY + 1, CORE_ROLE_UI, &task) == pdPASS) {
+        STACK_PROFILE_OWNER(task, "common");
+    }
+}
+
+#endif
+
+bool tickless_get_stats(TicklessStats_t *out) {
+    if (init_us == 0) {
+        return false;
+    }
+
+    vTaskSuspendAll(); // tickless_sleep() roda com o escalonador suspenso
+    *out = stats;
+    out->max_drift_us = phase_known ? (uint32_t) (phase_max_us - phase_min_us) : 0;
+    (void) xTaskResumeAll();
+    out->elapsed_us = time_us_64() - init_us;
+    return true;
+}
+
+void tickless_report(void) {
+    TicklessStats_t s;
+
+    if (!tickless_get_stats(&s)) {
+        return;
+    }
+    printf("{\"tickless\":\"%s\",\"sleeps\":%lu,\"asleep_us\":%llu,\"residency\":%.2f,"
+           "\"suppressed_ticks\":%lu,\"avoided_wakeups\":%lu,\"early_wakes\":%lu,"
+           "\"max_late_us\":%lu,\"max_drift_us\":%lu}\n",
+           s.tick_stopped ? "stopped" : "pended", (unsigned long) s.sleeps,
+           (unsigned long long) s.asleep_us,
+           s.elapsed_us > 0 ? 100.0 * (double) s.asleep_us / (double) s.elapsed_us : 0.0,
+           (unsigned long) s.suppressed_ticks, (unsigned long) s.avoided_wakeups,
+           (unsigned long) s.early_wakes, (unsigned long) s.max_late_us, (unsigned long) s.max_drift_us);
+}
+
+#endif
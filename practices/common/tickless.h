@@ -0,0 +1,68 @@
+#ifndef TICKLESS_H
+#define TICKLESS_H
+
+/*
+ * Tickless idle: quando todas as tarefas estão bloqueadas a idle para o tick
+ * e dorme até a próxima tarefa precisar acordar, em vez de acordar a cada
+ * 1 ms só para incrementar o contador de ticks.
+ *
+ * Com TICKLESS_IDLE = 1 o trace_hooks.h troca o portSUPPRESS_TICKS_AND_SLEEP
+ * do port por tickless_sleep(); o FreeRTOSConfig.h precisa de
+ *   #define configUSE_TICKLESS_IDLE                 TICKLESS_IDLE
+ *   #define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   2
+ * Só no build de um núcleo: com SMP o tick do núcleo 1 continuaria rodando.
+ *
+ * Na placa o SysTick é parado, um alarme do timer do RP2040 é armado para o
+ * tick em que a próxima tarefa acorda e o núcleo entra em WFI. Ao acordar
+ * (pelo alarme ou por outra interrupção) o kernel avança os ticks que
+ * passaram com vTaskStepTick e o SysTick volta alinhado à fronteira do tick.
+ * O modo dormant não serve aqui: ele para o oscilador que alimenta o timer,
+ * e sem o timer não há como saber quantos ticks se passaram.
+ *
+ * No host o timer de intervalo do port POSIX (setitimer) é parado e a thread
+ * da idle dorme no relógio simulado até o mesmo instante. Ports POSIX que
+ * geram o tick numa thread própria não podem ser parados; os ticks então
+ * ficam pendentes no kernel e o relatório marca "tickless":"pended".
+ *
+ * O relatório é uma linha JSON com o tempo dormindo, os ticks suprimidos,
+ * os despertares evitados e a deriva máxima entre o contador de ticks e o
+ * relógio (deve ficar em poucos µs com o tick parado): no host ao final da
+ * execução, na placa a cada TICKLESS_REPORT_MS.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifndef TICKLESS_IDLE
+#define TICKLESS_IDLE 0
+#endif
+
+#define TICKLESS_TICK_US     (1000000UL / configTICK_RATE_HZ)
+#define TICKLESS_REPORT_MS   10000
+
+typedef struct {
+    uint32_t sleeps;            // Entradas no sono
+    uint32_t early_wakes;       // Acordou por interrupção antes do alarme
+    uint32_t suppressed_ticks;  // Ticks que passaram com o tick parado
+    uint32_t avoided_wakeups;   // Ticks suprimidos menos os despertares de fato
+    uint64_t asleep_us;
+    uint64_t elapsed_us;        // Desde o tickless_init()
+    uint32_t max_late_us;       // Maior atraso do despertar em relação ao alarme
+    uint32_t max_drift_us;      // Variação da fase do tick em relação ao relógio
+    bool tick_stopped;          // false quando o port não deixa parar o tick (host)
+} TicklessStats_t;
+
+// Prepara o alarme e o relatório; chamar antes do scheduler
+void tickless_init(void);
+
+// portSUPPRESS_TICKS_AND_SLEEP; chamada pela idle com o escalonador suspenso
+void tickless_sleep(TickType_t expected_ticks);
+
+bool tickless_get_stats(TicklessStats_t *stats);
+
+// Uma linha JSON com a residência no sono e os ticks suprimidos
+void tickless_report(void);
+
+#endif
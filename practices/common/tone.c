@@ -0,0 +1,105 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/pwm.h"
+#include "tone.h"
+#include "rtos_alloc.h"
+
+static uint tonePin;
+static uint toneSlice;
+static TimerHandle_t toneTimer = NULL;
+static volatile bool playing = false;
+static uint64_t cpuTimeUs = 0;
+
+// Fim do tom com duração; o callback só desliga se esse instante já chegou,
+// então uma expiração de um tom anterior não corta o tom novo
+static volatile bool timed = false;
+static volatile TickType_t toneEnd;
+
+static void tone_off(void) {
+    pwm_set_gpio_level(tonePin, 0);
+    pwm_set_enabled(toneSlice, false);
+    playing = false;
+    timed = false;
+}
+
+static void tone_timer_callback(TimerHandle_t timer) {
+    (void) timer;
+    taskENTER_CRITICAL();
+    if (timed && (int32_t) (xTaskGetTickCount() - toneEnd) >= 0) {
+        tone_off();
+    }
+    taskEXIT_CRITICAL();
+}
+
+bool tone_init(uint pin) {
+    tonePin = pin;
+    toneSlice = pwm_gpio_to_slice_num(pin);
+
+    gpio_set_function(pin, GPIO_FUNC_PWM);
+    pwm_set_gpio_level(pin, 0);
+    pwm_set_enabled(toneSlice, false);
+
+    toneTimer = rtos_alloc_timer("Tone", 1, pdFALSE, NULL, tone_timer_callback);
+    return toneTimer != NULL;
+}
+
+void tone_play(uint32_t freq_hz, uint32_t duration_ms) {
+    uint64_t start = time_us_64();
+
+    if (freq_hz == 0) {
+        tone_stop();
+        return;
+    }
+
+    // Menor divisor inteiro que deixa o período caber nos 16 bits do contador
+    uint32_t clock_hz = clock_get_hz(clk_sys);
+    uint32_t divider = (clock_hz / freq_hz + 65535) / 65536;
+    if (divider < 1) {
+        divider = 1;
+    } else if (divider > 255) {
+        divider = 255;
+    }
+    uint32_t wrap = clock_hz / (divider * freq_hz) - 1;
+    if (wrap > 65535) {
+        wrap = 65535;
+    }
+
+    taskENTER_CRITICAL();
+    pwm_set_enabled(toneSlice, false);
+    pwm_set_clkdiv(toneSlice, (float) divider);
+    pwm_set_wrap(toneSlice, (uint16_t) wrap);
+    pwm_set_gpio_level(tonePin, (uint16_t) ((wrap + 1) / 2)); // duty cycle de 50%
+    pwm_set_enabled(toneSlice, true);
+    playing = true;
+    timed = duration_ms > 0;
+    toneEnd = xTaskGetTickCount() + pdMS_TO_TICKS(duration_ms);
+    taskEXIT_CRITICAL();
+
+    if (duration_ms > 0) {
+        xTimerChangePeriod(toneTimer, pdMS_TO_TICKS(duration_ms), 0);
+    } else {
+        xTimerStop(toneTimer, 0);
+    }
+
+    cpuTimeUs += time_us_64() - start;
+}
+
+void tone_stop(void) {
+    taskENTER_CRITICAL();
+    tone_off();
+    taskEXIT_CRITICAL();
+    if (toneTimer != NULL) {
+        xTimerStop(toneTimer, 0);
+    }
+}
+
+bool tone_is_playing(void) {
+    return playing;
+}
+
+uint64_t tone_cpu_time_us(void) {
+    return cpuTimeUs;
+}
@@ -0,0 +1,30 @@
+#ifndef TONE_H
+#define TONE_H
+
+/*
+ * Gerador de tom para buzzer passivo.
+ *
+ * A onda quadrada sai de um slice de PWM e a duração é controlada por um
+ * software timer one-shot, então tone_play() apenas configura o hardware e
+ * retorna: a CPU fica livre durante todo o tom. No host o PWM simulado
+ * registra as bordas no trace de GPIO com o instante exato de cada uma.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/types.h"
+
+// Configura o pino para PWM e cria o timer de duração
+bool tone_init(uint pin);
+
+// Toca freq_hz por duration_ms (0 = até tone_stop()); substitui o tom atual
+void tone_play(uint32_t freq_hz, uint32_t duration_ms);
+
+void tone_stop(void);
+
+bool tone_is_playing(void);
+
+// Tempo de CPU gasto dentro da API, em µs (para comparar com a espera ocupada)
+uint64_t tone_cpu_time_us(void);
+
+#endif
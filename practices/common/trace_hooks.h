@@ -0,0 +1,225 @@
+#ifndef TRACE_HOOKS_H
+#define TRACE_HOOKS_H
+
+/*
+ * Macros de trace do kernel usadas pelos módulos de common/.
+ *
+ * Incluir no final do FreeRTOSConfig.h (o do host já inclui). Cada módulo é
+ * ligado pela sua flag; com todas em 0 nenhuma macro é definida e o kernel
+ * compila igual ao original. Este arquivo é lido pelo próprio kernel, antes
+ * dos tipos do FreeRTOS existirem, então as funções usam só tipos de C.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef HEAP_PROFILE
+#define HEAP_PROFILE 0
+#endif
+
+#if HEAP_PROFILE
+// Chamadas pelo heap_4 com o escalonador suspenso
+void heap_profile_on_malloc(void *block, size_t size, void *caller);
+void heap_profile_on_free(void *block, size_t size);
+
+// Dentro do pvPortMalloc o endereço de retorno é o ponto de chamada
+#define traceMALLOC(pvAddress, uiSize) heap_profile_on_malloc(pvAddress, uiSize, __builtin_return_address(0))
+#define traceFREE(pvAddress, uiSize)   heap_profile_on_free(pvAddress, uiSize)
+#endif
+
+#ifndef MUTEX_PROFILE
+#define MUTEX_PROFILE 0
+#endif
+
+#if MUTEX_PROFILE
+// Chamadas pelo queue.c/tasks.c dentro de seção crítica
+void mutex_profile_on_block(void *mutex);
+void mutex_profile_on_take(void *mutex);
+void mutex_profile_on_take_failed(void *mutex);
+void mutex_profile_on_give(void *mutex);
+void mutex_profile_on_inherit(void *holder, unsigned long priority);
+void mutex_profile_on_disinherit(void *holder, unsigned long priority);
+
+// Só filas do tipo mutex; o tipo existe com configUSE_TRACE_FACILITY = 1
+#define MUTEX_PROFILE_IS_MUTEX(pxQueue) \
+    ((pxQueue)->ucQueueType == queueQUEUE_TYPE_MUTEX || (pxQueue)->ucQueueType == queueQUEUE_TYPE_RECURSIVE_MUTEX)
+
+// traceBLOCKING_ON_QUEUE_RECEIVE, traceQUEUE_RECEIVE e traceQUEUE_SEND são
+// compartilhadas com o TRACE_RECORDER e montadas no final do arquivo
+#define MUTEX_PROFILE_BLOCK(pxQueue) \
+    do { if (MUTEX_PROFILE_IS_MUTEX(pxQueue)) mutex_profile_on_block(pxQueue); } while (0)
+#define MUTEX_PROFILE_TAKE(pxQueue) \
+    do { if (MUTEX_PROFILE_IS_MUTEX(pxQueue)) mutex_profile_on_take(pxQueue); } while (0)
+#define MUTEX_PROFILE_GIVE(pxQueue) \
+    do { if (MUTEX_PROFILE_IS_MUTEX(pxQueue)) mutex_profile_on_give(pxQueue); } while (0)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue) \
+    do { if (MUTEX_PROFILE_IS_MUTEX(pxQueue)) mutex_profile_on_take_failed(pxQueue); } while (0)
+#define traceTASK_PRIORITY_INHERIT(pxTCBOfMutexHolder, uxInheritedPriority) \
+    mutex_profile_on_inherit(pxTCBOfMutexHolder, uxInheritedPriority)
+#define traceTASK_PRIORITY_DISINHERIT(pxTCBOfMutexHolder, uxOriginalPriority) \
+    mutex_profile_on_disinherit(pxTCBOfMutexHolder, uxOriginalPriority)
+#endif
+
+#ifndef STACK_PROFILE
+#define STACK_PROFILE 0
+#endif
+
+#if STACK_PROFILE
+// Chamadas pelo tasks.c dentro de seção crítica
+void stack_profile_on_create(void *task, const char *name, void *stack_low, void *stack_high);
+void stack_profile_on_delete(void *task);
+
+// O pxEndOfStack só existe com configRECORD_STACK_HIGH_ADDRESS = 1
+#define traceTASK_CREATE(pxNewTCB) \
+    stack_profile_on_create(pxNewTCB, (pxNewTCB)->pcTaskName, (pxNewTCB)->pxStack, (pxNewTCB)->pxEndOfStack)
+#define traceTASK_DELETE(pxTCB) stack_profile_on_delete(pxTCB)
+#endif
+
+#ifndef SWITCH_COUNT
+#define SWITCH_COUNT 0
+#endif
+
+#if SWITCH_COUNT
+// Chamadas pelo vTaskSwitchContext com a tarefa do núcleo que troca
+void runtime_stats_on_switch_out(void *task);
+void runtime_stats_on_switch_in(void *task);
+
+#define SWITCH_COUNT_OUT() runtime_stats_on_switch_out(pxCurrentTCB)
+#define SWITCH_COUNT_IN()  runtime_stats_on_switch_in(pxCurrentTCB)
+#endif
+
+#ifndef TICKLESS_IDLE
+#define TICKLESS_IDLE 0
+#endif
+
+#if TICKLESS_IDLE
+// Chamada pela idle com o escalonador suspenso; TickType_t é de 32 bits
+void tickless_sleep(uint32_t expected_ticks);
+
+// Definida antes do portmacro.h, substitui o sono do port
+#define portSUPPRESS_TICKS_AND_SLEEP(xExpectedIdleTime) tickless_sleep(xExpectedIdleTime)
+#endif
+
+#ifndef TRACE_RECORDER
+#define TRACE_RECORDER 0
+#endif
+
+#if TRACE_RECORDER
+// Tipos de evento do common/trace_recorder; o núcleo vai no bit 7
+#define TRACE_EVENT_SWITCH_IN          0x01
+#define TRACE_EVENT_QUEUE_SEND         0x02
+#define TRACE_EVENT_QUEUE_RECEIVE      0x03
+#define TRACE_EVENT_QUEUE_BLOCK        0x04
+#define TRACE_EVENT_QUEUE_SEND_ISR     0x05
+#define TRACE_EVENT_QUEUE_RECEIVE_ISR  0x06
+#define TRACE_EVENT_QUEUE_GIVE_ISR     0x07
+#define TRACE_EVENT_NOTIFY             0x08
+#define TRACE_EVENT_NOTIFY_ISR         0x09
+#define TRACE_EVENT_NOTIFY_GIVE_ISR    0x0A
+#define TRACE_EVENT_ISR_ENTER          0x0B
+#define TRACE_EVENT_ISR_EXIT           0x0C
+
+// Chamadas dentro das seções críticas do kernel
+void trace_recorder_event(uint32_t type, uint32_t id, uint32_t arg);
+void trace_recorder_on_switch_in(uint32_t task, const char *name);
+uint32_t trace_recorder_on_new_queue(void *queue, uint32_t queue_type);
+
+// uxTCBNumber e uxQueueNumber existem com configUSE_TRACE_FACILITY = 1; a
+// fila ganha número no primeiro evento, e pxTCB é a tarefa notificada
+#define TRACE_RECORDER_SWITCH_IN() \
+    trace_recorder_on_switch_in(pxCurrentTCB->uxTCBNumber, pxCurrentTCB->pcTaskName)
+#define TRACE_RECORDER_QUEUE(type, pxQueue) \
+    do { \
+        if ((pxQueue)->uxQueueNumber == 0) { \
+            (pxQueue)->uxQueueNumber = trace_recorder_on_new_queue(pxQueue, (pxQueue)->ucQueueType); \
+        } \
+        trace_recorder_event(type, (pxQueue)->uxQueueNumber, (pxQueue)->uxMessagesWaiting); \
+    } while (0)
+
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)    TRACE_RECORDER_QUEUE(TRACE_EVENT_QUEUE_SEND_ISR, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue) TRACE_RECORDER_QUEUE(TRACE_EVENT_QUEUE_RECEIVE_ISR, pxQueue)
+#define traceQUEUE_GIVE_FROM_ISR(pxQueue)    TRACE_RECORDER_QUEUE(TRACE_EVENT_QUEUE_GIVE_ISR, pxQueue)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue) TRACE_RECORDER_QUEUE(TRACE_EVENT_QUEUE_BLOCK, pxQueue)
+#define traceTASK_NOTIFY(uxIndexToNotify) \
+    trace_recorder_event(TRACE_EVENT_NOTIFY, pxTCB->uxTCBNumber, uxIndexToNotify)
+#define traceTASK_NOTIFY_FROM_ISR(uxIndexToNotify) \
+    trace_recorder_event(TRACE_EVENT_NOTIFY_ISR, pxTCB->uxTCBNumber, uxIndexToNotify)
+#define traceTASK_NOTIFY_GIVE_FROM_ISR(uxIndexToNotify) \
+    trace_recorder_event(TRACE_EVENT_NOTIFY_GIVE_ISR, pxTCB->uxTCBNumber, uxIndexToNotify)
+#endif
+
+#ifndef DEADLINE_MONITOR
+#define DEADLINE_MONITOR 0
+#endif
+
+#if DEADLINE_MONITOR
+// Chamadas pelo tasks.c; slot é o uxTaskNumber dado no registro (0 = tarefa
+// fora do monitor). Os delays entram no início da chamada, ainda na tarefa;
+// o tick vem da interrupção com o valor antes do incremento
+void deadline_monitor_on_delay_until(uint32_t slot, uint32_t previous_wake, uint32_t increment);
+void deadline_monitor_on_delay(uint32_t slot, uint32_t ticks);
+void deadline_monitor_on_switch_in(uint32_t slot);
+void deadline_monitor_on_tick(uint32_t tick);
+
+#define traceENTER_xTaskDelayUntil(pxPreviousWakeTime, xTimeIncrement) \
+    do { \
+        if (pxCurrentTCB->uxTaskNumber != 0) \
+            deadline_monitor_on_delay_until(pxCurrentTCB->uxTaskNumber, *(pxPreviousWakeTime), xTimeIncrement); \
+    } while (0)
+#define traceENTER_vTaskDelay(xTicksToDelay) \
+    do { \
+        if (pxCurrentTCB->uxTaskNumber != 0) \
+            deadline_monitor_on_delay(pxCurrentTCB->uxTaskNumber, xTicksToDelay); \
+    } while (0)
+#define traceTASK_INCREMENT_TICK(xTickCount) deadline_monitor_on_tick(xTickCount)
+#define DEADLINE_MONITOR_SWITCH_IN() \
+    do { if (pxCurrentTCB->uxTaskNumber != 0) deadline_monitor_on_switch_in(pxCurrentTCB->uxTaskNumber); } while (0)
+#endif
+
+#ifndef SIM_VIRTUAL_TIME
+#define SIM_VIRTUAL_TIME 0
+#endif
+
+#if defined(PICO_SIM) && SIM_VIRTUAL_TIME
+// Chamada no início do vTaskSuspendAll; o SimClock do host_sim lê dela o
+// próximo desbloqueio e quantas tarefas estão prontas na prioridade da idle
+void sim_kernel_snapshot(uint32_t next_unblock, uint32_t idle_ready);
+
+#define traceENTER_vTaskSuspendAll() \
+    sim_kernel_snapshot(xNextTaskUnblockTime, listCURRENT_LIST_LENGTH(&pxReadyTasksLists[tskIDLE_PRIORITY]))
+#endif
+
+// Macros pedidas por mais de um módulo: cada um entra com a sua parte
+#ifndef MUTEX_PROFILE_BLOCK
+#define MUTEX_PROFILE_BLOCK(pxQueue)
+#define MUTEX_PROFILE_TAKE(pxQueue)
+#define MUTEX_PROFILE_GIVE(pxQueue)
+#endif
+#ifndef SWITCH_COUNT_IN
+#define SWITCH_COUNT_OUT()
+#define SWITCH_COUNT_IN()
+#endif
+#ifndef TRACE_RECORDER_SWITCH_IN
+#define TRACE_RECORDER_SWITCH_IN()
+#define TRACE_RECORDER_QUEUE(type, pxQueue)
+#endif
+#ifndef DEADLINE_MONITOR_SWITCH_IN
+#define DEADLINE_MONITOR_SWITCH_IN()
+#endif
+
+#if MUTEX_PROFILE || TRACE_RECORDER
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) \
+    do { MUTEX_PROFILE_BLOCK(pxQueue); TRACE_RECORDER_QUEUE(TRACE_EVENT_QUEUE_BLOCK, pxQueue); } while (0)
+#define traceQUEUE_RECEIVE(pxQueue) \
+    do { MUTEX_PROFILE_TAKE(pxQueue); TRACE_RECORDER_QUEUE(TRACE_EVENT_QUEUE_RECEIVE, pxQueue); } while (0)
+#define traceQUEUE_SEND(pxQueue) \
+    do { MUTEX_PROFILE_GIVE(pxQueue); TRACE_RECORDER_QUEUE(TRACE_EVENT_QUEUE_SEND, pxQueue); } while (0)
+#endif
+
+#if SWITCH_COUNT || TRACE_RECORDER || DEADLINE_MONITOR
+#define traceTASK_SWITCHED_OUT() SWITCH_COUNT_OUT()
+#define traceTASK_SWITCHED_IN() \
+    do { SWITCH_COUNT_IN(); TRACE_RECORDER_SWITCH_IN(); DEADLINE_MONITOR_SWITCH_IN(); } while (0)
+#endif
+
+#endif
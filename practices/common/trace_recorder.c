@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "trace_recorder.h"
+#include "cycle_count.h"
+#include "rtos_alloc.h"
+#include "stdio_raw.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#else
+#include "hardware/clocks.h"
+#endif
+#if defined(PICO_SIM) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define TRACE_BENCH_TSC 1
+#else
+#define TRACE_BENCH_TSC 0
+#endif
+
+#if TRACE_RECORDER
+
+#if configUSE_TRACE_FACILITY != 1
+#error "trace_recorder precisa de configUSE_TRACE_FACILITY = 1"
+#endif
+#if (TRACE_RECORDER_EVENTS & (TRACE_RECORDER_EVENTS - 1)) != 0
+#error "TRACE_RECORDER_EVENTS precisa ser potência de 2"
+#endif
+
+#define EVENTS_PER_FRAME (255 / sizeof(TraceEvent_t))
+
+typedef struct {
+    void *handle;
+    const char *name;    // Dado ao rtos_alloc, se houver
+    uint8_t queue_type;
+} TracedQueue_t;
+
+static TraceEvent_t ring[TRACE_RECORDER_EVENTS];
+static volatile uint32_t head = 0;
+static volatile bool recording = true;
+
+static char task_names[TRACE_RECORDER_MAX_TASKS][TRACE_RECORDER_NAME_LEN];
+
+// Índice = uxQueueNumber; a entrada 0 fica vazia (0 = ainda sem número)
+static TracedQueue_t queues[TRACE_RECORDER_MAX_QUEUES];
+static uint32_t queue_count = 0;
+
+// Nomes registrados pelo rtos_alloc, casados com as filas no dump
+static TracedQueue_t named[TRACE_RECORDER_MAX_QUEUES];
+static uint32_t named_count = 0;
+
+void trace_recorder_event(uint32_t type, uint32_t id, uint32_t arg) {
+    if (!recording) {
+        return;
+    }
+    TraceEvent_t *event = &ring[head++ & (TRACE_RECORDER_EVENTS - 1)];
+    event->t_us = time_us_32();
+    event->id = (uint16_t) id;
+    event->type = (uint8_t) (type | (get_core_num() << 7));
+    event->arg = (uint8_t) (arg < 0xFF ? arg : 0xFF);
+}
+
+void trace_recorder_on_switch_in(uint32_t task, const char *name) {
+    if (task < TRACE_RECORDER_MAX_TASKS && task_names[task][0] == '\0') {
+        strncpy(task_names[task], name, TRACE_RECORDER_NAME_LEN - 1);
+    }
+    trace_recorder_event(TRACE_EVENT_SWITCH_IN, task, 0);
+}
+
+uint32_t trace_recorder_on_new_queue(void *queue, uint32_t queue_type) {
+    uint32_t id = ++queue_count;
+
+    if (id < TRACE_RECORDER_MAX_QUEUES) {
+        queues[id].handle = queue;
+        queues[id].queue_type = (uint8_t) queue_type;
+    }
+    return id;
+}
+
+void trace_recorder_name_queue(void *queue, const char *name) {
+    UBaseType_t status = taskENTER_CRITICAL_FROM_ISR();
+    if (named_count < TRACE_RECORDER_MAX_QUEUES) {
+        named[named_count].handle = queue;
+        named[named_count].name = name;
+        named_count++;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(status);
+}
+
+// Fora dos hooks, então entra na seção crítica como eles
+void trace_recorder_isr_enter(uint32_t irq) {
+    UBaseType_t status = taskENTER_CRITICAL_FROM_ISR();
+    trace_recorder_event(TRACE_EVENT_ISR_ENTER, irq, 0);
+    taskEXIT_CRITICAL_FROM_ISR(status);
+}
+
+void trace_recorder_isr_exit(uint32_t irq) {
+    UBaseType_t status = taskENTER_CRITICAL_FROM_ISR();
+    trace_recorder_event(TRACE_EVENT_ISR_EXIT, irq, 0);
+    taskEXIT_CRITICAL_FROM_ISR(status);
+}
+
+uint32_t trace_recorder_count(void) {
+    return head;
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t) (value >> (8 * i));
+    }
+}
+
+static void put_name(uint8_t kind, uint32_t id, uint8_t queue_type, const char *name) {
+    uint8_t payload[4 + TRACE_RECORDER_NAME_LEN];
+    size_t length = strnlen(name, TRACE_RECORDER_NAME_LEN);
+
+    payload[0] = kind;
+    payload[1] = (uint8_t) id;
+    payload[2] = (uint8_t) (id >> 8);
+    payload[3] = queue_type;
+    memcpy(&payload[4], name, length);
+    stdio_raw_frame(TRACE_RECORDER_FRAME_NAME, payload, (uint8_t) (4 + length));
+}
+
+static const char *queue_name(void *handle) {
+    for (uint32_t i = 0; i < named_count; i++) {
+        if (named[i].handle == handle) {
+            return named[i].name;
+        }
+    }
+    return "";
+}
+
+void trace_recorder_dump(void) {
+    uint8_t payload[EVENTS_PER_FRAME * sizeof(TraceEvent_t)];
+
+    recording = false; // O próprio dump troca de tarefa e escreve em filas
+
+    uint32_t total = head;
+    uint32_t count = total < TRACE_RECORDER_EVENTS ? total : TRACE_RECORDER_EVENTS;
+
+    put_u32(&payload[0], time_us_32());
+    put_u32(&payload[4], total);
+    put_u32(&payload[8], count);
+    put_u32(&payload[12], TRACE_RECORDER_EVENTS);
+    payload[16] = configNUMBER_OF_CORES;
+    stdio_raw_begin();
+    stdio_raw_frame(TRACE_RECORDER_FRAME_HEADER, payload, 17);
+
+    for (uint32_t i = 0; i < TRACE_RECORDER_MAX_TASKS; i++) {
+        if (task_names[i][0] != '\0') {
+            put_name(0, i, 0, task_names[i]);
+        }
+    }
+    for (uint32_t i = 1; i <= queue_count && i < TRACE_RECORDER_MAX_QUEUES; i++) {
+        put_name(1, i, queues[i].queue_type, queue_name(queues[i].handle));
+    }
+
+    // Do mais antigo ao mais novo
+    for (uint32_t done = 0; done < count;) {
+        uint32_t n = count - done < EVENTS_PER_FRAME ? count - done : EVENTS_PER_FRAME;
+        for (uint32_t k = 0; k < n; k++) {
+            const TraceEvent_t *event = &ring[(total - count + done + k) & (TRACE_RECORDER_EVENTS - 1)];
+            uint8_t *out = &payload[k * sizeof(TraceEvent_t)];
+            put_u32(out, event->t_us);
+            out[4] = (uint8_t) event->id;
+            out[5] = (uint8_t) (event->id >> 8);
+            out[6] = event->type;
+            out[7] = event->arg;
+        }
+        stdio_raw_frame(TRACE_RECORDER_FRAME_EVENTS, payload, (uint8_t) (n * sizeof(TraceEvent_t)));
+        done += n;
+    }
+    stdio_raw_end();
+}
+
+#ifndef PICO_SIM
+static void dump_timer_callback(TimerHandle_t timer) {
+    (void) timer;
+    trace_recorder_dump();
+}
+#endif
+
+bool trace_recorder_init(void) {
+#ifdef PICO_SIM
+    return sim_at_exit(trace_recorder_dump);
+#else
+    TimerHandle_t timer = rtos_alloc_timer("TraceDump", pdMS_TO_TICKS(TRACE_RECORDER_DUMP_MS), pdFALSE, NULL,
+                                           dump_timer_callback);
+    return timer != NULL && xTimerStart(timer, 0) == pdPASS;
+#endif
+}
+
+// Cada medida cabe num tick e roda numa seção crítica, sem ISR nem o outro
+// núcleo no meio; no fim os eventos que ela sobrescreveu voltam ao anel
+void trace_recorder_bench(void) {
+    static TraceEvent_t saved[TRACE_RECORDER_BENCH_EVENTS];
+    uint64_t ns = 0;
+    uint64_t cycles = 0;
+
+    for (uint32_t round = 0; round < TRACE_RECORDER_BENCH_ROUNDS; round++) {
+        taskENTER_CRITICAL();
+        uint32_t first = head;
+        for (uint32_t i = 0; i < TRACE_RECORDER_BENCH_EVENTS; i++) {
+            saved[i] = ring[(first + i) & (TRACE_RECORDER_EVENTS - 1)];
+        }
+
+        uint32_t start = cycle_count_now();
+#if TRACE_BENCH_TSC
+        uint64_t tsc_start = __rdtsc();
+#endif
+        for (uint32_t i = 0; i < TRACE_RECORDER_BENCH_EVENTS; i++) {
+            trace_recorder_event(TRACE_EVENT_QUEUE_SEND, i, i);
+        }
+#if TRACE_BENCH_TSC
+        cycles += __rdtsc() - tsc_start;
+#endif
+        ns += cycle_count_elapsed_ns(start, cycle_count_now());
+
+        for (uint32_t i = 0; i < TRACE_RECORDER_BENCH_EVENTS; i++) {
+            ring[(first + i) & (TRACE_RECORDER_EVENTS - 1)] = saved[i];
+        }
+        head = first; // Os eventos do benchmark não entram no trace
+        taskEXIT_CRITICAL();
+    }
+
+    uint32_t total = TRACE_RECORDER_BENCH_EVENTS * TRACE_RECORDER_BENCH_ROUNDS;
+#ifndef PICO_SIM
+    cycles = ns * (clock_get_hz(clk_sys) / 1000000u) / 1000u;
+#endif
+    printf("{\"trace_recorder_bench\":{\"events\":%lu,\"ns_per_event\":%.2f,\"cycles_per_event\":%.2f,"
+           "\"bytes_per_event\":%u}}\n",
+           (unsigned long) total, (double) ns / total, (double) cycles / total, (unsigned) sizeof(TraceEvent_t));
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+/*
+ * Gravador de eventos do kernel: trocas de contexto, filas e semáforos,
+ * notificações e ISRs, para ver como tarefas e interrupções se intercalam.
+ *
+ * Com TRACE_RECORDER = 1 o trace_hooks.h liga as macros de trace do kernel a
+ * este módulo (precisa de configUSE_TRACE_FACILITY = 1). Cada evento ocupa
+ * 8 bytes num anel em RAM: instante (u32 µs do timer), objeto (u16), tipo
+ * com o núcleo no bit 7 (u8) e um argumento (u8). O anel sobrescreve os mais
+ * antigos e guarda sempre os últimos TRACE_RECORDER_EVENTS. Gravar é a
+ * leitura do timer, um índice e quatro escritas, sem trava: os hooks do
+ * kernel já rodam dentro das suas seções críticas.
+ *
+ * Tarefas são identificadas pelo uxTCBNumber, com o nome copiado na primeira
+ * troca para elas. Filas, semáforos e mutexes ganham um número no primeiro
+ * evento (uxQueueNumber), com o nome dado ao rtos_alloc. O argumento é o
+ * número de mensagens na fila antes da operação, ou o índice da notificação.
+ *
+ * trace_recorder_dump() para a gravação e escreve o anel no stdout em quadros
+ * com o enquadramento do dlog (0xD1 0x06, tipo, tamanho). Inteiros em
+ * little-endian:
+ *   0x20 header: instante do dump, eventos gravados, eventos no dump,
+ *                tamanho do anel (u32), núcleos (u8)
+ *   0x21 name:   0 = tarefa ou 1 = fila (u8), id (u16), tipo da fila (u8), nome
+ *   0x22 events: até 31 eventos
+ * tools/trace_to_chrome.py converte para o JSON de trace do Chrome, que o
+ * Perfetto abre.
+ */
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+#ifndef TRACE_RECORDER_BENCH
+#define TRACE_RECORDER_BENCH 0
+#endif
+
+#define TRACE_RECORDER_EVENTS        2048   // Potência de 2; 16 KiB
+#define TRACE_RECORDER_DUMP_MS       5000   // Na placa, dump único depois desse tempo
+#define TRACE_RECORDER_MAX_TASKS     64
+#define TRACE_RECORDER_MAX_QUEUES    32
+#define TRACE_RECORDER_NAME_LEN      16
+#define TRACE_RECORDER_BENCH_EVENTS  256    // Eventos por medida (cabe num tick)
+#define TRACE_RECORDER_BENCH_ROUNDS  64
+
+#define TRACE_RECORDER_FRAME_HEADER  0x20
+#define TRACE_RECORDER_FRAME_NAME    0x21
+#define TRACE_RECORDER_FRAME_EVENTS  0x22
+
+typedef struct {
+    uint32_t t_us;
+    uint16_t id;
+    uint8_t type;
+    uint8_t arg;
+} TraceEvent_t;
+
+// No host o dump sai no fim da execução; na placa um timer o faz depois de
+// TRACE_RECORDER_DUMP_MS. Chamar antes do scheduler
+bool trace_recorder_init(void);
+
+// Nome de uma fila, semáforo ou mutex; name precisa ter endereço fixo
+void trace_recorder_name_queue(void *queue, const char *name);
+
+// Início e fim do corpo de uma ISR, com o número da IRQ ou do pino
+void trace_recorder_isr_enter(uint32_t irq);
+void trace_recorder_isr_exit(uint32_t irq);
+
+#if TRACE_RECORDER
+#define TRACE_ISR_ENTER(irq) trace_recorder_isr_enter(irq)
+#define TRACE_ISR_EXIT(irq)  trace_recorder_isr_exit(irq)
+#else
+#define TRACE_ISR_ENTER(irq)
+#define TRACE_ISR_EXIT(irq)
+#endif
+
+// Eventos gravados desde o boot, inclusive os já sobrescritos
+uint32_t trace_recorder_count(void);
+
+// Para a gravação e escreve os quadros binários
+void trace_recorder_dump(void);
+
+// Custo de gravar um evento; uma linha JSON. Chamar de uma tarefa: na placa o
+// SysTick que mede só conta depois do vTaskStartScheduler()
+void trace_recorder_bench(void);
+
+#endif
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "wake_bench.h"
+#include "core_affinity.h"
+#include "stack_profile.h"
+#ifdef PICO_SIM
+#include "sim_hal.h"
+#endif
+
+#ifndef WAKE_BENCH_EXTRA_TASKS
+#define WAKE_BENCH_EXTRA_TASKS 0
+#endif
+#ifndef WAKE_BENCH_BUSY_US
+#define WAKE_BENCH_BUSY_US 0
+#endif
+#ifndef WAKE_BENCH_ISR_HZ
+#define WAKE_BENCH_ISR_HZ 0
+#endif
+
+#ifndef WAKE_BENCH_LOAD_PRIORITY
+#define WAKE_BENCH_LOAD_PRIORITY (tskIDLE_PRIORITY + 1)
+#endif
+
+#define ISR_BODY_US 20
+
+static WakeStats_t *registered[WAKE_BENCH_MAX_TASKS];
+static UBaseType_t registered_count = 0;
+
+static uint32_t extra_tasks = WAKE_BENCH_EXTRA_TASKS;
+static uint32_t busy_us = WAKE_BENCH_BUSY_US;
+static uint32_t isr_hz = WAKE_BENCH_ISR_HZ;
+
+void wake_stats_init(WakeStats_t *stats, const char *name, uint32_t period_ms) {
+    memset(stats, 0, sizeof(*stats));
+    stats->name = name;
+    stats->period_us = period_ms * 1000;
+    stats->min_us = INT64_MAX;
+    stats->max_us = INT64_MIN;
+
+    taskENTER_CRITICAL();
+    if (registered_count < WAKE_BENCH_MAX_TASKS) {
+        registered[registered_count++] = stats;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void wake_stats_mark(WakeStats_t *stats) {
+    uint64_t now = time_us_64();
+
+    if (stats->wakes == 0) {
+        stats->first_us = now;
+    } else {
+        // Atraso em relação ao período desde a última marca
+        int64_t lateness = (int64_t) (now - stats->last_us) - stats->period_us;
+        uint32_t bucket = 0;
+
+        if (lateness < stats->min_us) {
+            stats->min_us = lateness;
+        }
+        if (lateness > stats->max_us) {
+            stats->max_us = lateness;
+        }
+        stats->sum_us += lateness;
+
+        while (bucket < WAKE_BENCH_BUCKETS - 1 && lateness >= ((int64_t) 1 << bucket)) {
+            bucket++;
+        }
+        stats->histogram[bucket]++;
+
+        stats->drift_us = (int64_t) (now - stats->first_us) - (int64_t) stats->wakes * stats->period_us;
+    }
+
+    stats->last_us = now;
+    stats->wakes++;
+}
+
+// Limite superior do bucket do histograma que contém o percentil 99. Com
+// buckets em potências de 2 pode passar de perto do dobro do valor real, então
+// fica limitado ao máximo medido
+static int64_t p99_bucket_bound(const WakeStats_t *stats) {
+    uint32_t total = stats->wakes - 1;
+    uint32_t needed = total - total / 100;
+    uint32_t seen = 0;
+
+    for (int i = 0; i < WAKE_BENCH_BUCKETS; i++) {
+        seen += stats->histogram[i];
+        if (seen >= needed) {
+            int64_t bound = (int64_t) 1 << i;
+            return bound < stats->max_us ? bound : stats->max_us;
+        }
+    }
+    return stats->max_us;
+}
+
+static void report_task(FILE *out, const WakeStats_t *stats) {
+    if (stats->wakes < 2) {
+        return;
+    }
+
+    uint32_t samples = stats->wakes - 1;
+    fprintf(out, "{\"task\":\"%s\",\"period_us\":%lu,\"wakes\":%lu,"
+                 "\"load\":{\"extra_tasks\":%lu,\"busy_us\":%lu,\"isr_hz\":%lu},"
+                 "\"lateness_us\":{\"min\":%lld,\"mean\":%lld,\"p99_bucket_bound\":%lld,\"max\":%lld},"
+                 "\"drift_us\":%lld,\"histogram_log2_us\":[",
+            stats->name, (unsigned long) stats->period_us, (unsigned long) stats->wakes,
+            (unsigned long) extra_tasks, (unsigned long) busy_us, (unsigned long) isr_hz,
+            (long long) stats->min_us, (long long) (stats->sum_us / samples),
+            (long long) p99_bucket_bound(stats), (long long) stats->max_us,
+            (long long) stats->drift_us);
+
+    for (int i = 0; i < WAKE_BENCH_BUCKETS; i++) {
+        fprintf(out, "%s%lu", i ? "," : "", (unsigned long) stats->histogram[i]);
+    }
+    fprintf(out, "]}\n");
+}
+
+void wake_bench_report(void) {
+    FILE *out = stdout;
+
+#ifdef PICO_SIM
+    const char *path = getenv("WAKE_BENCH_OUT");
+    if (path != NULL && (out = fopen(path, "w")) == NULL) {
+        out = stdout;
+    }
+#endif
+
+    for (UBaseType_t i = 0; i < registered_count; i++) {
+        report_task(out, registered[i]);
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Carga de interferência
+
+// Tarefas extras disputando a CPU na mesma prioridade das práticas
+static void extra_load_task(void *params) {
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+
+    while (1) {
+        busy_wait_us_32(200);
+        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(10));
+    }
+}
+
+// Espera ocupada periódica, como o laço do buzzer na prática do ADC
+static void busy_load_task(void *params) {
+    while (1) {
+        busy_wait_us_32(busy_us);
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+// Rajada de interrupções: roda acima de todas as tarefas, como o controlador
+// de interrupções do simulador, e gasta ISR_BODY_US por disparo. A cada tick
+// executa todos os disparos vencidos desde o tick anterior.
+static void isr_storm_task(void *params) {
+    uint64_t period_us = 1000000 / isr_hz;
+    uint64_t next = time_us_64() + period_us;
+
+    while (1) {
+        while (next <= time_us_64()) {
+            busy_wait_us_32(ISR_BODY_US);
+            next += period_us;
+        }
+        vTaskDelay(1);
+    }
+}
+
+#ifndef PICO_SIM
+static void report_loop_task(void *params) {
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(WAKE_BENCH_REPORT_MS));
+        wake_bench_report();
+    }
+}
+#endif
+
+// Tarefas do próprio banco, marcadas como infraestrutura no relatório de pilha
+static void create_task(TaskFunction_t code, const char *name, configSTACK_DEPTH_TYPE stack, UBaseType_t priority,
+                        CoreRole_t role) {
+    TaskHandle_t task;
+
+    if (core_affinity_create(code, name, stack, NULL, priority, role, &task) == pdPASS) {
+        STACK_PROFILE_OWNER(task, "common");
+    }
+}
+
+void wake_bench_init(void) {
+#ifdef PICO_SIM
+    const char *value;
+    if ((value = getenv("WAKE_BENCH_EXTRA_TASKS")) != NULL) {
+        extra_tasks = strtoul(value, NULL, 10);
+    }
+    if ((value = getenv("WAKE_BENCH_BUSY_US")) != NULL) {
+        busy_us = strtoul(value, NULL, 10);
+    }
+    if ((value = getenv("WAKE_BENCH_ISR_HZ")) != NULL) {
+        isr_hz = strtoul(value, NULL, 10);
+    }
+    sim_at_exit(wake_bench_report);
+#else
+    create_task(report_loop_task, "WakeReport", 512, tskIDLE_PRIORITY + 1, CORE_ROLE_UI);
+#endif
+
+    for (uint32_t i = 0; i < extra_tasks; i++) {
+        create_task(extra_load_task, "ExtraLoad", 256, WAKE_BENCH_LOAD_PRIORITY, CORE_ROLE_ANY);
+    }
+    if (busy_us > 0) {
+        create_task(busy_load_task, "BusyLoad", 256, WAKE_BENCH_LOAD_PRIORITY, CORE_ROLE_ANY);
+    }
+    if (isr_hz > 0) {
+        create_task(isr_storm_task, "IsrStorm", 256, configMAX_PRIORITIES - 1, CORE_ROLE_ANY);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef WAKE_BENCH_H
+#define WAKE_BENCH_H
+
+/*
+ * Medição de latência e jitter de tarefas periódicas.
+ *
+ * A tarefa chama WAKE_BENCH_MARK() logo depois de acordar. Cada marca compara
+ * o instante real com o esperado (marca anterior + período) e com a grade
+ * ideal (primeira marca + n períodos), acumulando atraso mínimo, médio,
+ * máximo, um histograma em potências de 2 (µs) e o desvio acumulado.
+ *
+ * Com WAKE_BENCH = 1 a prática também liga a carga de interferência:
+ *   WAKE_BENCH_EXTRA_TASKS   tarefas extras acordando a cada 10 ms
+ *   WAKE_BENCH_BUSY_US       espera ocupada a cada 100 ms (como o buzzer)
+ *   WAKE_BENCH_ISR_HZ        rajada de "interrupções" de 20 µs nessa taxa
+ *   WAKE_BENCH_LOAD_PRIORITY prioridade das tarefas de carga
+ * No host os mesmos parâmetros podem vir das variáveis de ambiente de mesmo
+ * nome. O resultado é uma linha JSON por tarefa: no host ao final da execução
+ * (ou no arquivo WAKE_BENCH_OUT), na placa a cada WAKE_BENCH_REPORT_MS.
+ */
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+#ifndef WAKE_BENCH
+#define WAKE_BENCH 0
+#endif
+
+#define WAKE_BENCH_MAX_TASKS  8
+#define WAKE_BENCH_BUCKETS    24    // bucket i: atraso < 2^i µs
+#define WAKE_BENCH_REPORT_MS  10000
+
+typedef struct {
+    const char *name;
+    uint32_t period_us;
+    uint32_t wakes;
+    uint64_t first_us;     // primeira marca, origem da grade ideal
+    uint64_t last_us;
+    int64_t min_us;
+    int64_t max_us;
+    int64_t sum_us;
+    int64_t drift_us;      // desvio acumulado em relação à grade ideal
+    uint32_t histogram[WAKE_BENCH_BUCKETS];
+} WakeStats_t;
+
+void wake_stats_init(WakeStats_t *stats, const char *name, uint32_t period_ms);
+void wake_stats_mark(WakeStats_t *stats);
+
+// Liga a carga de interferência e o relatório; chamar antes do scheduler
+void wake_bench_init(void);
+
+// Escreve as estatísticas de todas as tarefas registradas em JSON
+void wake_bench_report(void);
+
+#if WAKE_BENCH
+#define WAKE_BENCH_TASK(var, name, period_ms) \
+    static WakeStats_t var; \
+    wake_stats_init(&var, name, period_ms)
+#define WAKE_BENCH_MARK(var) wake_stats_mark(&var)
+#else
+#define WAKE_BENCH_TASK(var, name, period_ms)
+#define WAKE_BENCH_MARK(var)
+#endif
+
+#endif
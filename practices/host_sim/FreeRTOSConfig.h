@@ -0,0 +1,101 @@
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*
+ * Configuração do FreeRTOS para rodar as práticas no host (port POSIX/Linux).
+ * Os valores seguem o FreeRTOSConfig.h usado na Pico sempre que possível,
+ * para que o comportamento das tarefas seja o mesmo nos dois ambientes.
+ */
+
+#include <stdint.h>
+
+// Escalonador
+#define configUSE_PREEMPTION                    1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#ifndef TICKLESS_IDLE
+#define TICKLESS_IDLE                           0
+#endif
+#define configUSE_TICKLESS_IDLE                 TICKLESS_IDLE   // Sono da idle em common/tickless
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   2
+#define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
+#define configMAX_PRIORITIES                    32
+#define configMINIMAL_STACK_SIZE                ( ( configSTACK_DEPTH_TYPE ) 256 )
+#define configMAX_TASK_NAME_LEN                 16
+#define configTICK_TYPE_WIDTH_IN_BITS           TICK_TYPE_WIDTH_32_BITS
+#define configIDLE_SHOULD_YIELD                 1
+#define configUSE_TIME_SLICING                  1
+
+// O port POSIX tem um núcleo só; common/core_affinity projeta os dois da Pico
+#define configNUMBER_OF_CORES                   1
+#define configUSE_CORE_AFFINITY                 0
+
+// Sincronização
+#define configUSE_TASK_NOTIFICATIONS            1
+#define configUSE_MUTEXES                       1
+#define configUSE_RECURSIVE_MUTEXES             1
+#define configUSE_COUNTING_SEMAPHORES           1
+#define configQUEUE_REGISTRY_SIZE               8
+#define configUSE_QUEUE_SETS                    0
+
+// Memória
+#define configSUPPORT_STATIC_ALLOCATION         1
+#ifndef configSUPPORT_DYNAMIC_ALLOCATION
+#define configSUPPORT_DYNAMIC_ALLOCATION        1   // 0 com STATIC_ALLOCATION=1 e sem heap_4.c
+#endif
+#define configKERNEL_PROVIDED_STATIC_MEMORY     1
+#define configTOTAL_HEAP_SIZE                   ( 128 * 1024 )
+#define configAPPLICATION_ALLOCATED_HEAP        0
+#define configRECORD_STACK_HIGH_ADDRESS         1
+
+// Hooks
+#define configUSE_IDLE_HOOK                     1
+#define configUSE_TICK_HOOK                     0
+#define configCHECK_FOR_STACK_OVERFLOW          2
+#define configUSE_MALLOC_FAILED_HOOK             0
+#ifndef SIM_VIRTUAL_TIME
+#define SIM_VIRTUAL_TIME                        0
+#endif
+#define configUSE_DAEMON_TASK_STARTUP_HOOK      SIM_VIRTUAL_TIME   // Desliga o tick do port no tempo virtual
+
+// Estatísticas
+#define configGENERATE_RUN_TIME_STATS           1
+#define configUSE_TRACE_FACILITY                1
+#define configUSE_STATS_FORMATTING_FUNCTIONS    0
+
+// Base de tempo das estatísticas: relógio simulado de 1 MHz, como o timer da Pico
+extern uint64_t sim_time_us(void);
+#define configRUN_TIME_COUNTER_TYPE             uint32_t
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()        ( ( uint32_t ) sim_time_us() )
+
+// Software timers
+#define configUSE_TIMERS                        1
+#define configTIMER_TASK_PRIORITY               ( configMAX_PRIORITIES - 1 )
+#define configTIMER_QUEUE_LENGTH                10
+#define configTIMER_TASK_STACK_DEPTH            1024
+
+// Funções opcionais da API usadas pelas práticas
+#define INCLUDE_vTaskPrioritySet                1
+#define INCLUDE_uxTaskPriorityGet               1
+#define INCLUDE_vTaskDelete                     1
+#define INCLUDE_vTaskSuspend                    1
+#define INCLUDE_xTaskDelayUntil                 1
+#define INCLUDE_vTaskDelay                      1
+#define INCLUDE_xTaskGetSchedulerState          1
+#define INCLUDE_xTaskGetCurrentTaskHandle       1
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
+#define INCLUDE_xTaskGetIdleTaskHandle          1
+#define INCLUDE_eTaskGetState                   1
+#define INCLUDE_xTimerPendFunctionCall          1
+#define INCLUDE_xTaskAbortDelay                 1
+#define INCLUDE_xTaskGetHandle                  1
+#define INCLUDE_xTaskResumeFromISR              1
+
+// Asserts caem no simulador, que informa arquivo e linha e encerra a execução
+extern void vAssertCalled(const char *pcFile, unsigned long ulLine);
+#define configASSERT( x )    if( ( x ) == 0 ) vAssertCalled( __FILE__, __LINE__ )
+
+// Macros de trace dos módulos de common/ (profiler de heap etc.)
+#include "trace_hooks.h"
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,14 @@
+#ifndef _HARDWARE_ADC_H
+#define _HARDWARE_ADC_H
+
+#include "pico/types.h"
+
+#define NUM_ADC_CHANNELS 5
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint adc_get_selected_input(void);
+uint16_t adc_read(void);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef _HARDWARE_CLOCKS_H
+#define _HARDWARE_CLOCKS_H
+
+#include "pico/types.h"
+
+enum clock_index {
+    clk_sys = 5,
+    clk_adc = 7
+};
+
+// Clock padrão do RP2040
+static inline uint32_t clock_get_hz(enum clock_index clk_index) {
+    return clk_index == clk_adc ? 48000000u : 125000000u;
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef _HARDWARE_GPIO_H
+#define _HARDWARE_GPIO_H
+
+#include "pico/types.h"
+
+#define NUM_BANK0_GPIOS 30
+
+#define GPIO_IN  false
+#define GPIO_OUT true
+
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW  = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL  = 0x4u,
+    GPIO_IRQ_EDGE_RISE  = 0x8u,
+};
+
+enum gpio_function {
+    GPIO_FUNC_PWM  = 4,
+    GPIO_FUNC_SIO  = 5,
+    GPIO_FUNC_NULL = 0x1f
+};
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_put(uint gpio, bool value);
+void gpio_put_masked(uint32_t mask, uint32_t value);
+bool gpio_get(uint gpio);
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
+void gpio_set_irq_callback(gpio_irq_callback_t callback);
+
+#endif
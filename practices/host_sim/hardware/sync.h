@@ -0,0 +1,41 @@
+#ifndef _HARDWARE_SYNC_H
+#define _HARDWARE_SYNC_H
+
+#include "pico/types.h"
+
+// No host só existe um core; desabilitar interrupções = bloquear o tick do port POSIX
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+static inline uint get_core_num(void) {
+    return 0;
+}
+
+// Spin locks de hardware: com um core só, a seção crítica já basta
+typedef volatile uint32_t spin_lock_t;
+
+static inline int spin_lock_claim_unused(bool required) {
+    (void) required;
+    return 0;
+}
+
+static inline spin_lock_t *spin_lock_init(uint lock_num) {
+    static spin_lock_t locks[32];
+    return &locks[lock_num];
+}
+
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock) {
+    (void) lock;
+    return save_and_disable_interrupts();
+}
+
+static inline void spin_unlock(spin_lock_t *lock, uint32_t saved_irq) {
+    (void) lock;
+    restore_interrupts(saved_irq);
+}
+
+static inline void __dmb(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#endif
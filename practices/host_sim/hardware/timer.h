@@ -0,0 +1,20 @@
+#ifndef _HARDWARE_TIMER_H
+#define _HARDWARE_TIMER_H
+
+#include "pico/types.h"
+
+// Relógio simulado de 1 MHz, equivalente ao timer do RP2040
+uint64_t time_us_64(void);
+
+static inline uint32_t time_us_32(void) {
+    return (uint32_t) time_us_64();
+}
+
+void busy_wait_us_32(uint32_t delay_us);
+void busy_wait_us(uint64_t delay_us);
+
+static inline void busy_wait_ms(uint32_t delay_ms) {
+    busy_wait_us((uint64_t) delay_ms * 1000);
+}
+
+#endif
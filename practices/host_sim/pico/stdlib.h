@@ -0,0 +1,17 @@
+#ifndef _PICO_STDLIB_H
+#define _PICO_STDLIB_H
+
+/*
+ * Substituto do pico/stdlib.h para o build no host. Expõe o mesmo subconjunto
+ * da API do Pico SDK que as práticas usam, implementado em sim_hal.c.
+ */
+
+#include <stdio.h>
+#include "pico/types.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+// Inicializa o simulador (script de entrada, trace de GPIO e tarefa de IRQ)
+bool stdio_init_all(void);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef _PICO_TIME_H
+#define _PICO_TIME_H
+
+#include "pico/types.h"
+#include "hardware/timer.h"
+
+static inline absolute_time_t get_absolute_time(void) {
+    return time_us_64();
+}
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t) (t / 1000);
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+#endif
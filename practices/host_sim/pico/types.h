@@ -0,0 +1,18 @@
+#ifndef _PICO_TYPES_H
+#define _PICO_TYPES_H
+
+// Marca o build no host; os módulos usam para escolher entre hardware e simulador
+#ifndef PICO_SIM
+#define PICO_SIM 1
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+// No SDK absolute_time_t é o tempo em µs desde o boot
+typedef uint64_t absolute_time_t;
+
+#endif
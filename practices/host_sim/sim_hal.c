@@ -0,0 +1,819 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "sim_hal.h"
+#include "stack_profile.h"
+
+// Estado dos pinos
+static uint8_t gpio_level[SIM_NUM_GPIOS];
+static bool gpio_is_output[SIM_NUM_GPIOS];
+static uint32_t gpio_irq_mask[SIM_NUM_GPIOS];
+static uint64_t gpio_edge_time[SIM_NUM_GPIOS];
+static gpio_irq_callback_t gpio_irq_callback = NULL;
+static bool gpio_is_pwm[SIM_NUM_GPIOS];
+
+// Estado dos slices de PWM; as bordas são geradas a partir de start_us
+typedef struct {
+    bool enabled;
+    float divider;
+    uint16_t wrap;
+    uint16_t level[2];
+    uint64_t start_us;
+} sim_pwm_slice_t;
+
+static sim_pwm_slice_t pwm_slice[NUM_PWM_SLICES];
+
+// Estado do ADC
+static uint16_t adc_value[NUM_ADC_CHANNELS];
+static uint16_t adc_noise[NUM_ADC_CHANNELS];
+static uint adc_selected = 0;
+
+static uint64_t random_state = 1;
+
+// Trace de bordas de GPIO
+static sim_edge_t trace[SIM_TRACE_MAX];
+static size_t trace_count = 0;
+static uint32_t trace_dropped = 0;
+
+// Script de estímulos, ordenado por instante
+static sim_event_t script[SIM_SCRIPT_MAX];
+static size_t script_count = 0;
+static uint64_t duration_us = 0;
+
+static void (*exit_handlers[SIM_EXIT_HANDLERS])(void);
+static size_t exit_handler_count = 0;
+
+static struct timespec boot_time;
+static bool initialized = false;
+static unsigned long long seed = 1;
+
+// ---------------------------------------------------------------------------
+// Tempo
+
+#define SIM_TICK_US (1000000ULL / configTICK_RATE_HZ)
+
+static uint64_t wall_time_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) (now.tv_sec - boot_time.tv_sec) * 1000000ULL
+         + (now.tv_nsec - boot_time.tv_nsec) / 1000;
+}
+
+#if SIM_VIRTUAL_TIME
+
+#if INCLUDE_xTaskGetSchedulerState != 1
+#error "SIM_VIRTUAL_TIME precisa de INCLUDE_xTaskGetSchedulerState"
+#endif
+
+// Relógio virtual e ticks já entregues ao kernel; o tick n cai em n * SIM_TICK_US
+static volatile uint64_t virtual_us = 0;
+static uint64_t virtual_ticks = 0;
+static bool clock_started = false;
+static uint32_t irq_nesting = 0;
+static TaskHandle_t clock_handle = NULL;
+
+// Copiados pelo traceENTER_vTaskSuspendAll, de dentro do tasks.c
+static uint32_t kernel_next_unblock;
+static uint32_t kernel_idle_ready;
+
+void sim_kernel_snapshot(uint32_t next_unblock, uint32_t idle_ready) {
+    kernel_next_unblock = next_unblock;
+    kernel_idle_ready = idle_ready;
+}
+
+// Ticks só podem ser entregues por uma tarefa, fora de seção crítica
+static bool can_tick(void) {
+    return clock_started && irq_nesting == 0 && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+// Avança o relógio até end_us entregando um tick a cada fronteira, como o
+// SysTick faria durante uma espera ocupada. Fronteiras passadas sem poder
+// entregar o tick ficam devendo e saem na próxima chamada
+static void virtual_run_until(uint64_t end_us) {
+    for (;;) {
+        uint64_t next_tick = (virtual_ticks + 1) * SIM_TICK_US;
+
+        if (next_tick > end_us || !can_tick()) {
+            if (virtual_us < end_us) {
+                virtual_us = end_us;
+            }
+            return;
+        }
+        if (virtual_us < next_tick) {
+            virtual_us = next_tick;
+        }
+        virtual_ticks++;
+        xTaskCatchUpTicks(1); // Pode trocar de tarefa; o estado é relido na volta
+    }
+}
+
+// Roda na prioridade da idle, ou seja, quando todas as outras tarefas estão
+// bloqueadas: nada acontece até o próximo desbloqueio, então o relógio salta
+// até ele e o kernel processa os ticks do intervalo de uma vez
+static void sim_clock_task(void *params) {
+    (void) params;
+
+    for (;;) {
+        vTaskSuspendAll();
+        TickType_t jump = (TickType_t) kernel_next_unblock - xTaskGetTickCount();
+        uint32_t idle_ready = kernel_idle_ready;
+        (void) xTaskResumeAll();
+
+        // Outra tarefa na prioridade da idle pronta divide a CPU tick a tick;
+        // sem nenhuma tarefa com prazo o salto é limitado a um segundo
+        if (jump == 0 || idle_ready > 2) {
+            jump = 1;
+        } else if (jump > configTICK_RATE_HZ) {
+            jump = configTICK_RATE_HZ;
+        }
+
+        virtual_ticks += jump;
+        if (virtual_us < virtual_ticks * SIM_TICK_US) {
+            virtual_us = virtual_ticks * SIM_TICK_US;
+        }
+        xTaskCatchUpTicks(jump);
+    }
+}
+
+// Sem tarefa bloqueando, o relógio virtual para; melhor encerrar que travar o CI
+static void *stall_watchdog(void *arg) {
+    uint64_t last = virtual_us;
+    struct timespec period = { .tv_sec = SIM_STALL_MS / 1000, .tv_nsec = (SIM_STALL_MS % 1000) * 1000000L };
+    sigset_t all;
+
+    (void) arg;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, NULL);
+
+    for (;;) {
+        nanosleep(&period, NULL);
+        uint64_t now = virtual_us;
+        if (now == last) {
+            fprintf(stderr, "sim: virtual clock stuck at %llu us for %d ms; a task runs without blocking\n",
+                    (unsigned long long) now, SIM_STALL_MS);
+            fflush(stdout);
+            _exit(2);
+        }
+        last = now;
+    }
+    return NULL;
+}
+
+// Primeira coisa que roda com o escalonador no ar, na tarefa do timer
+void vApplicationDaemonTaskStartupHook(void) {
+    struct itimerval off = { 0 };
+    pthread_t watchdog;
+
+    // O tick do port (setitimer ou thread própria) chega como SIGALRM
+    setitimer(ITIMER_REAL, &off, NULL);
+    signal(SIGALRM, SIG_IGN);
+
+    // O tempo gasto antes do escalonador não vira tick, como na placa
+    virtual_ticks = virtual_us / SIM_TICK_US;
+    clock_started = true;
+
+    if (pthread_create(&watchdog, NULL, stall_watchdog, NULL) == 0) {
+        pthread_detach(watchdog);
+    }
+}
+
+uint64_t sim_time_us(void) {
+    return virtual_us;
+}
+
+void busy_wait_us(uint64_t delay_us) {
+    virtual_run_until(virtual_us + delay_us);
+}
+
+TaskHandle_t sim_idle_task(void) {
+    return clock_handle;
+}
+
+#else
+
+uint64_t sim_time_us(void) {
+    return wall_time_us();
+}
+
+void busy_wait_us(uint64_t delay_us) {
+    uint64_t end = sim_time_us() + delay_us;
+    while (sim_time_us() < end) {
+        // Espera ocupada, como no hardware
+    }
+}
+
+TaskHandle_t sim_idle_task(void) {
+    return xTaskGetIdleTaskHandle();
+}
+
+#endif
+
+uint64_t time_us_64(void) {
+    return sim_time_us();
+}
+
+void busy_wait_us_32(uint32_t delay_us) {
+    busy_wait_us(delay_us);
+}
+
+// ---------------------------------------------------------------------------
+// Interrupções
+
+uint32_t save_and_disable_interrupts(void) {
+    // A seção crítica do port POSIX bloqueia o sinal do tick e aceita aninhamento
+    portENTER_CRITICAL();
+#if SIM_VIRTUAL_TIME
+    irq_nesting++;
+#endif
+    return 0;
+}
+
+void restore_interrupts(uint32_t status) {
+    (void) status;
+#if SIM_VIRTUAL_TIME
+    irq_nesting--;
+#endif
+    portEXIT_CRITICAL();
+}
+
+// ---------------------------------------------------------------------------
+// GPIO
+
+static void trace_edge_at(uint64_t t_us, uint pin, bool level) {
+    if (trace_count < SIM_TRACE_MAX) {
+        trace[trace_count].t_us = t_us;
+        trace[trace_count].pin = (uint8_t) pin;
+        trace[trace_count].level = level;
+        trace_count++;
+    } else {
+        trace_dropped++;
+    }
+}
+
+static void trace_edge(uint pin, bool level) {
+    trace_edge_at(sim_time_us(), pin, level);
+}
+
+static void set_level(uint pin, bool level) {
+    if (pin >= SIM_NUM_GPIOS || gpio_level[pin] == level) {
+        return;
+    }
+    gpio_level[pin] = level;
+    gpio_edge_time[pin] = sim_time_us();
+    trace_edge(pin, level);
+}
+
+void gpio_init(uint gpio) {
+    if (gpio < SIM_NUM_GPIOS) {
+        gpio_is_output[gpio] = false;
+        gpio_level[gpio] = 0;
+        gpio_irq_mask[gpio] = 0;
+    }
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    if (gpio < SIM_NUM_GPIOS) {
+        gpio_is_output[gpio] = out;
+    }
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    if (gpio < SIM_NUM_GPIOS) {
+        gpio_is_pwm[gpio] = fn == GPIO_FUNC_PWM;
+    }
+}
+
+void gpio_pull_up(uint gpio) {
+    // Entrada em repouso fica em nível alto (botões ativos em nível baixo)
+    if (gpio < SIM_NUM_GPIOS && !gpio_is_output[gpio]) {
+        gpio_level[gpio] = 1;
+    }
+}
+
+void gpio_pull_down(uint gpio) {
+    if (gpio < SIM_NUM_GPIOS && !gpio_is_output[gpio]) {
+        gpio_level[gpio] = 0;
+    }
+}
+
+void gpio_put(uint gpio, bool value) {
+    // Pino entregue ao PWM não responde ao SIO, como no hardware
+    if (gpio < SIM_NUM_GPIOS && !gpio_is_pwm[gpio]) {
+        set_level(gpio, value);
+    }
+}
+
+// Um pino por vez; na placa o SIO troca todos de uma vez
+void gpio_put_masked(uint32_t mask, uint32_t value) {
+    for (uint gpio = 0; gpio < SIM_NUM_GPIOS; gpio++) {
+        if (mask & (1u << gpio)) {
+            gpio_put(gpio, (value >> gpio) & 1u);
+        }
+    }
+}
+
+bool gpio_get(uint gpio) {
+    return gpio < SIM_NUM_GPIOS ? gpio_level[gpio] : false;
+}
+
+uint64_t sim_gpio_edge_time_us(uint pin) {
+    return pin < SIM_NUM_GPIOS ? gpio_edge_time[pin] : 0;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+    if (gpio >= SIM_NUM_GPIOS) {
+        return;
+    }
+    if (enabled) {
+        gpio_irq_mask[gpio] |= event_mask;
+    } else {
+        gpio_irq_mask[gpio] &= ~event_mask;
+    }
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+    // Como no SDK, existe um único callback de GPIO por core
+    gpio_irq_callback = callback;
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+}
+
+void gpio_set_irq_callback(gpio_irq_callback_t callback) {
+    gpio_irq_callback = callback;
+}
+
+void sim_set_input(uint pin, bool level) {
+    if (pin >= SIM_NUM_GPIOS || gpio_level[pin] == level) {
+        return;
+    }
+    set_level(pin, level);
+
+    uint32_t events = gpio_irq_mask[pin] & (level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL);
+    if (events != 0 && gpio_irq_callback != NULL) {
+        gpio_irq_callback(pin, events);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// PWM
+
+// Gera no trace as bordas de um canal entre start_us e end_us
+static void pwm_emit_channel(uint slice_num, uint chan, uint64_t end_us) {
+    const sim_pwm_slice_t *slice = &pwm_slice[slice_num];
+    uint pin = slice_num * 2 + chan;
+
+    if (pin >= SIM_NUM_GPIOS || !gpio_is_pwm[pin]) {
+        return;
+    }
+
+    // O contador vai de 0 a wrap; a saída fica alta enquanto contador < level
+    double tick_us = slice->divider * 1e6 / clock_get_hz(clk_sys);
+    double period_us = (slice->wrap + 1) * tick_us;
+    double high_us = slice->level[chan] * tick_us;
+
+    if (slice->level[chan] == 0) {
+        if (gpio_level[pin]) {
+            gpio_level[pin] = 0;
+            trace_edge_at(slice->start_us, pin, 0);
+        }
+        return;
+    }
+
+    for (double t = 0; slice->start_us + t < end_us; t += period_us) {
+        uint64_t rise = slice->start_us + (uint64_t) t;
+        uint64_t fall = slice->start_us + (uint64_t) (t + high_us);
+
+        if (!gpio_level[pin]) {
+            gpio_level[pin] = 1;
+            trace_edge_at(rise, pin, 1);
+        }
+        if (slice->level[chan] <= slice->wrap && fall < end_us) {
+            gpio_level[pin] = 0;
+            trace_edge_at(fall, pin, 0);
+        }
+    }
+}
+
+// Fecha o trecho gerado com a configuração antiga e recomeça o período agora
+static void pwm_flush(uint slice_num) {
+    sim_pwm_slice_t *slice = &pwm_slice[slice_num];
+    uint64_t now = sim_time_us();
+
+    if (slice->enabled) {
+        pwm_emit_channel(slice_num, PWM_CHAN_A, now);
+        pwm_emit_channel(slice_num, PWM_CHAN_B, now);
+    }
+    slice->start_us = now;
+}
+
+void pwm_set_clkdiv(uint slice_num, float divider) {
+    if (slice_num < NUM_PWM_SLICES) {
+        pwm_flush(slice_num);
+        pwm_slice[slice_num].divider = divider;
+    }
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {
+    if (slice_num < NUM_PWM_SLICES) {
+        pwm_flush(slice_num);
+        pwm_slice[slice_num].wrap = wrap;
+    }
+}
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level) {
+    if (slice_num < NUM_PWM_SLICES && chan < 2) {
+        pwm_flush(slice_num);
+        pwm_slice[slice_num].level[chan] = level;
+    }
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+    if (slice_num >= NUM_PWM_SLICES) {
+        return;
+    }
+    pwm_flush(slice_num);
+    pwm_slice[slice_num].enabled = enabled;
+
+    // Slice desligado congela a saída em nível baixo
+    for (uint chan = 0; !enabled && chan < 2; chan++) {
+        uint pin = slice_num * 2 + chan;
+        if (pin < SIM_NUM_GPIOS && gpio_is_pwm[pin] && gpio_level[pin]) {
+            gpio_level[pin] = 0;
+            trace_edge(pin, 0);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ADC
+
+void adc_init(void) {
+}
+
+void adc_gpio_init(uint gpio) {
+    (void) gpio;
+}
+
+void adc_select_input(uint input) {
+    if (input < NUM_ADC_CHANNELS) {
+        adc_selected = input;
+    }
+}
+
+uint adc_get_selected_input(void) {
+    return adc_selected;
+}
+
+uint16_t adc_read(void) {
+    int32_t value = adc_value[adc_selected];
+    uint16_t noise = adc_noise[adc_selected];
+
+    if (noise != 0) {
+        value += (int32_t) (sim_random() % (2u * noise + 1)) - noise;
+        value = value < 0 ? 0 : value > 0x0FFF ? 0x0FFF : value;
+    }
+    return (uint16_t) value;
+}
+
+void sim_set_adc(uint channel, uint16_t value) {
+    if (channel < NUM_ADC_CHANNELS) {
+        adc_value[channel] = value & 0x0FFF; // ADC de 12 bits
+    }
+}
+
+// xorshift64*: a mesma semente dá a mesma sequência em qualquer host
+uint32_t sim_random(void) {
+    random_state ^= random_state >> 12;
+    random_state ^= random_state << 25;
+    random_state ^= random_state >> 27;
+    return (uint32_t) ((random_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// ---------------------------------------------------------------------------
+// Script de estímulos
+
+bool sim_script_add(const sim_event_t *event) {
+    if (script_count >= SIM_SCRIPT_MAX) {
+        return false;
+    }
+
+    // Inserção ordenada; eventos no mesmo instante mantêm a ordem do script
+    size_t i = script_count;
+    while (i > 0 && script[i - 1].t_us > event->t_us) {
+        script[i] = script[i - 1];
+        i--;
+    }
+    script[i] = *event;
+    script_count++;
+    return true;
+}
+
+/*
+ * Formato: uma linha por evento, tempo em µs desde o boot.
+ *   <t_us> gpio <pino> <0|1>
+ *   <t_us> adc <canal> <valor>
+ *   <t_us> noise <canal> <amplitude>
+ *   <t_us> load <prioridade> <percentual>
+ *   <t_us> end
+ * Linhas vazias e iniciadas por '#' são ignoradas.
+ */
+bool sim_script_load(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "sim: cannot open script %s\n", path);
+        return false;
+    }
+
+    char line[128];
+    unsigned line_number = 0;
+    bool ok = true;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        unsigned long long t_us;
+        char kind[8];
+        unsigned id = 0, value = 0;
+        sim_event_t event;
+
+        line_number++;
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+
+        int fields = sscanf(line, "%llu %7s %u %u", &t_us, kind, &id, &value);
+        event.t_us = t_us;
+        event.id = (uint8_t) id;
+        event.value = (uint16_t) value;
+
+        if (fields == 4 && strcmp(kind, "gpio") == 0) {
+            event.kind = SIM_EVENT_GPIO;
+        } else if (fields == 4 && strcmp(kind, "adc") == 0) {
+            event.kind = SIM_EVENT_ADC;
+        } else if (fields == 4 && strcmp(kind, "noise") == 0) {
+            event.kind = SIM_EVENT_NOISE;
+        } else if (fields == 4 && strcmp(kind, "load") == 0 && id < configMAX_PRIORITIES - 1 && value <= 100) {
+            event.kind = SIM_EVENT_LOAD;
+        } else if (fields >= 2 && strcmp(kind, "end") == 0) {
+            event.kind = SIM_EVENT_END;
+        } else {
+            fprintf(stderr, "sim: %s:%u: invalid event\n", path, line_number);
+            ok = false;
+            continue;
+        }
+
+        if (!sim_script_add(&event)) {
+            fprintf(stderr, "sim: script too long, max %d events\n", SIM_SCRIPT_MAX);
+            ok = false;
+            break;
+        }
+    }
+
+    fclose(file);
+    return ok;
+}
+
+// Espera até o instante t_us; trechos menores que um tick são esperados ativamente
+static void wait_until(uint64_t t_us) {
+    uint64_t now;
+    while ((now = sim_time_us()) < t_us) {
+        uint64_t remaining = t_us - now;
+        if (remaining >= SIM_TICK_US) {
+            vTaskDelay((TickType_t) (remaining / SIM_TICK_US));
+        }
+#if SIM_VIRTUAL_TIME
+        else {
+            // O evento cai dentro do tick: o relógio vai direto até ele
+            virtual_run_until(t_us);
+        }
+#endif
+    }
+}
+
+// Carga de CPU pedida pelo script, abaixo da SimIRQ: ocupa load_percent de
+// cada tick com espera ocupada e fica suspensa com 0 %
+static TaskHandle_t load_handle = NULL;
+static volatile uint32_t load_percent = 0;
+
+static void sim_load_task(void *params) {
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1) {
+        if (load_percent == 0) {
+            vTaskSuspend(NULL);
+            last_wake = xTaskGetTickCount();
+            continue;
+        }
+        busy_wait_us(SIM_TICK_US * load_percent / 100);
+        xTaskDelayUntil(&last_wake, 1); // Com 100 % volta sem bloquear
+    }
+}
+
+static void set_load(uint priority, uint32_t percent) {
+    if (load_handle == NULL) {
+        return;
+    }
+    load_percent = percent;
+    vTaskPrioritySet(load_handle, priority);
+    if (percent != 0) {
+        vTaskResume(load_handle);
+    }
+}
+
+// Tarefa que faz o papel do controlador de interrupções
+static void sim_irq_task(void *params) {
+    for (size_t i = 0; i < script_count; i++) {
+        const sim_event_t *event = &script[i];
+
+        wait_until(event->t_us);
+
+        switch (event->kind) {
+            case SIM_EVENT_GPIO:
+                sim_set_input(event->id, event->value != 0);
+                break;
+            case SIM_EVENT_ADC:
+                sim_set_adc(event->id, event->value);
+                break;
+            case SIM_EVENT_NOISE:
+                if (event->id < NUM_ADC_CHANNELS) {
+                    adc_noise[event->id] = event->value;
+                }
+                break;
+            case SIM_EVENT_LOAD:
+                set_load(event->id, event->value);
+                break;
+            case SIM_EVENT_END:
+                sim_exit(0);
+                break;
+        }
+    }
+
+    if (duration_us != 0) {
+        wait_until(duration_us);
+        sim_exit(0);
+    }
+
+    vTaskDelete(NULL);
+}
+
+// ---------------------------------------------------------------------------
+// Inicialização e encerramento
+
+size_t sim_trace_count(void) {
+    return trace_count;
+}
+
+const sim_edge_t *sim_trace_get(size_t index) {
+    return index < trace_count ? &trace[index] : NULL;
+}
+
+uint32_t sim_trace_dropped(void) {
+    return trace_dropped;
+}
+
+bool sim_at_exit(void (*handler)(void)) {
+    if (exit_handler_count >= SIM_EXIT_HANDLERS) {
+        return false;
+    }
+    exit_handlers[exit_handler_count++] = handler;
+    return true;
+}
+
+// As bordas de PWM são geradas depois do fato, então o trace é ordenado na saída
+static int compare_edges(const void *a, const void *b) {
+    const sim_edge_t *edge_a = a;
+    const sim_edge_t *edge_b = b;
+    return (edge_a->t_us > edge_b->t_us) - (edge_a->t_us < edge_b->t_us);
+}
+
+static void write_trace(const char *path) {
+    qsort(trace, trace_count, sizeof(trace[0]), compare_edges);
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "sim: cannot write trace %s\n", path);
+        return;
+    }
+
+    fprintf(file, "t_us,pin,level\n");
+    for (size_t i = 0; i < trace_count; i++) {
+        fprintf(file, "%llu,%u,%u\n", (unsigned long long) trace[i].t_us, trace[i].pin, trace[i].level);
+    }
+    fclose(file);
+
+    if (trace_dropped != 0) {
+        fprintf(stderr, "sim: trace full, %lu edges dropped\n", (unsigned long) trace_dropped);
+    }
+}
+
+void sim_exit(int code) {
+    for (uint slice = 0; slice < NUM_PWM_SLICES; slice++) {
+        pwm_flush(slice);
+    }
+
+    for (size_t i = 0; i < exit_handler_count; i++) {
+        exit_handlers[i]();
+    }
+
+    const char *trace_path = getenv("SIM_TRACE");
+    if (trace_path != NULL) {
+        write_trace(trace_path);
+    }
+
+#if SIM_VIRTUAL_TIME
+    uint64_t wall_us = wall_time_us();
+    printf("{\"sim\":\"virtual\",\"seed\":%llu,\"sim_us\":%llu,\"wall_us\":%llu,\"speedup\":%.1f}\n",
+           (unsigned long long) seed, (unsigned long long) virtual_us, (unsigned long long) wall_us,
+           wall_us > 0 ? (double) virtual_us / wall_us : 0.0);
+#endif
+
+    fflush(stdout);
+    exit(code);
+}
+
+void sim_init(void) {
+    if (initialized) {
+        return;
+    }
+    initialized = true;
+
+    for (uint slice = 0; slice < NUM_PWM_SLICES; slice++) {
+        pwm_slice[slice].divider = 1.0f;
+        pwm_slice[slice].wrap = 0xffff;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &boot_time);
+
+    const char *script_path = getenv("SIM_SCRIPT");
+    if (script_path != NULL && !sim_script_load(script_path)) {
+        exit(1);
+    }
+
+    const char *duration = getenv("SIM_DURATION_MS");
+    if (duration != NULL) {
+        duration_us = strtoull(duration, NULL, 10) * 1000ULL;
+    }
+
+    // Estado do xorshift não pode ser zero
+    const char *seed_text = getenv("SIM_SEED");
+    if (seed_text != NULL) {
+        seed = strtoull(seed_text, NULL, 10);
+    }
+    random_state = seed != 0 ? seed : 1;
+
+#if SIM_VIRTUAL_TIME
+    static StackType_t clock_stack[configMINIMAL_STACK_SIZE * 2];
+    static StaticTask_t clock_tcb;
+    clock_handle = xTaskCreateStatic(sim_clock_task, "SimClock", configMINIMAL_STACK_SIZE * 2, NULL, tskIDLE_PRIORITY,
+                                     clock_stack, &clock_tcb);
+    STACK_PROFILE_OWNER(clock_handle, "sim");
+#endif
+
+    for (size_t i = 0; i < script_count; i++) {
+        if (script[i].kind == SIM_EVENT_LOAD) {
+            static StackType_t load_stack[configMINIMAL_STACK_SIZE * 2];
+            static StaticTask_t load_tcb;
+            load_handle = xTaskCreateStatic(sim_load_task, "SimLoad", configMINIMAL_STACK_SIZE * 2, NULL,
+                                            tskIDLE_PRIORITY, load_stack, &load_tcb);
+            STACK_PROFILE_OWNER(load_handle, "sim");
+            break;
+        }
+    }
+
+    if (script_count > 0 || duration_us != 0) {
+        // Estática, para rodar também nos builds sem alocação dinâmica
+        static StackType_t stack[configMINIMAL_STACK_SIZE * 4];
+        static StaticTask_t tcb;
+        TaskHandle_t irq_handle = xTaskCreateStatic(sim_irq_task, "SimIRQ", configMINIMAL_STACK_SIZE * 4, NULL,
+                                                    configMAX_PRIORITIES - 1, stack, &tcb);
+        STACK_PROFILE_OWNER(irq_handle, "sim");
+        (void) irq_handle;
+    }
+}
+
+bool stdio_init_all(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    sim_init();
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Hooks do FreeRTOS exigidos pela configuração do host
+
+void vAssertCalled(const char *pcFile, unsigned long ulLine) {
+    fprintf(stderr, "sim: assert failed at %s:%lu\n", pcFile, ulLine);
+    fflush(stderr);
+    abort();
+}
+
+// Práticas que não usam o idle hook ficam com esta versão vazia
+__attribute__((weak)) void vApplicationIdleHook(void) {
+}
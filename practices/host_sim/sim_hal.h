@@ -0,0 +1,90 @@
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+/*
+ * HAL simulado da Pico para o build no host.
+ *
+ * - GPIO: guarda o nível de cada pino e registra toda borda (pino, nível e
+ *   instante em µs) num trace que é salvo em CSV ao final da execução.
+ * - Entradas: um script de estímulos (botões e ADC) é reproduzido por uma
+ *   tarefa de prioridade máxima que faz o papel do controlador de interrupções
+ *   e chama o callback registrado em gpio_set_irq_enabled_with_callback().
+ * - PWM: as bordas de um slice habilitado são calculadas a partir do divisor,
+ *   do wrap e do nível, sem gastar CPU, e entram no mesmo trace.
+ * - Tempo: relógio monotônico de 1 MHz contado a partir do stdio_init_all().
+ *   Com SIM_VIRTUAL_TIME = 1 o relógio é virtual: só anda quando todas as
+ *   tarefas estão bloqueadas (a tarefa SimClock salta direto para o próximo
+ *   desbloqueio do kernel) ou numa espera ocupada, que soma o tempo pedido.
+ *   O tick do port é desligado e os ticks saem desse relógio, então a mesma
+ *   semente e o mesmo script geram sempre a mesma execução.
+ *
+ * Variáveis de ambiente:
+ *   SIM_SCRIPT       arquivo com os estímulos (formato em README.md)
+ *   SIM_TRACE        arquivo CSV de saída com as bordas de GPIO
+ *   SIM_DURATION_MS  encerra a execução após esse tempo simulado
+ *   SIM_SEED         semente do ruído de ADC do script (padrão 1)
+ */
+
+#include "pico/types.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define SIM_NUM_GPIOS      30
+#define SIM_TRACE_MAX      65536
+#define SIM_SCRIPT_MAX     4096
+#define SIM_EXIT_HANDLERS  12
+#define SIM_STALL_MS       5000   // Tempo virtual parado por isso (de relógio) encerra a execução
+
+// Borda registrada no trace de GPIO
+typedef struct {
+    uint64_t t_us;
+    uint8_t pin;
+    uint8_t level;
+} sim_edge_t;
+
+typedef enum {
+    SIM_EVENT_GPIO,  // muda o nível de um pino de entrada
+    SIM_EVENT_ADC,   // muda o valor lido por um canal do ADC
+    SIM_EVENT_NOISE, // soma ruído uniforme de ±value às leituras de um canal
+    SIM_EVENT_LOAD,  // ocupa value % de cada tick na prioridade id (0 % para)
+    SIM_EVENT_END    // encerra a execução
+} sim_event_kind_t;
+
+// Evento do script de estímulos
+typedef struct {
+    uint64_t t_us;
+    sim_event_kind_t kind;
+    uint8_t id;      // pino ou canal do ADC
+    uint16_t value;  // nível ou leitura do ADC
+} sim_event_t;
+
+void sim_init(void);
+
+// Tempo simulado em µs desde o boot
+uint64_t sim_time_us(void);
+
+// Estímulos programáticos (também usados pelo script)
+bool sim_script_load(const char *path);
+bool sim_script_add(const sim_event_t *event);
+void sim_set_input(uint pin, bool level);
+void sim_set_adc(uint channel, uint16_t value);
+
+// Gerador pseudoaleatório do simulador, semeado por SIM_SEED
+uint32_t sim_random(void);
+
+// Tarefa em que passa o tempo ocioso; a idle do kernel fora do tempo virtual
+TaskHandle_t sim_idle_task(void);
+
+// Instante da última borda do pino (entrada injetada ou gpio_put)
+uint64_t sim_gpio_edge_time_us(uint pin);
+
+// Acesso ao trace de GPIO
+size_t sim_trace_count(void);
+const sim_edge_t *sim_trace_get(size_t index);
+uint32_t sim_trace_dropped(void);
+
+// Funções chamadas ao final da execução, antes de gravar o trace
+bool sim_at_exit(void (*handler)(void));
+void sim_exit(int code);
+
+#endif
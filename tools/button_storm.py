@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""Bouncing button storm for the counting Semath practice on the host simulator.
+
+`gen` writes a SIM_SCRIPT with presses on all four buttons (pins 14/12/10/8,
+active low). Presses on different pins overlap freely, and every press and
+release bounces for a few milliseconds. The expected press count per pin is
+kept in a comment at the top of the script.
+
+`check` reads that script and the practice output, takes the JSON line
+printed at exit and reports lost and duplicate presses per button plus the
+ISR execution time. It exits with status 1 when any press was lost or
+duplicated.
+
+    python3 tools/button_storm.py gen --seed 7 > storm.txt
+    SIM_SCRIPT=storm.txt ./counting_host > out.txt
+    python3 tools/button_storm.py check storm.txt out.txt
+"""
+
+import argparse
+import json
+import random
+import sys
+
+PINS = [14, 12, 10, 8]
+
+BOUNCE_MAX_US = 4000       # Bounces settle well inside the 20 ms debounce window
+HOLD_US = (40000, 150000)
+SAME_PIN_GAP_US = 250000   # Above the original 200 ms debounce, so both builds can keep up
+
+
+def bounce(events, t, pin, level, rng):
+    """Chatter on the pin before it settles at level; returns the settle time."""
+    for _ in range(rng.randint(0, 6)):
+        events.append((t, pin, level))
+        t += rng.randint(100, BOUNCE_MAX_US // 8)
+        events.append((t, pin, 1 - level))
+        t += rng.randint(100, BOUNCE_MAX_US // 8)
+    events.append((t, pin, level))
+    return t
+
+
+def generate(args):
+    rng = random.Random(args.seed)
+    events = []
+    expected = {}
+
+    for pin in PINS:
+        t = rng.randint(50000, 150000)
+        expected[pin] = 0
+        while True:
+            hold = rng.randint(*HOLD_US)
+            if t + hold + 2 * BOUNCE_MAX_US > args.duration_ms * 1000:
+                break
+            pressed = bounce(events, t, pin, 0, rng)
+            bounce(events, pressed + hold, pin, 1, rng)
+            expected[pin] += 1
+            t += SAME_PIN_GAP_US + rng.randint(0, 200000)
+
+    # Stable sort keeps the order of edges generated for the same instant
+    events.sort(key=lambda event: event[0])
+
+    out = sys.stdout
+    out.write("# button_storm seed=%d\n" % args.seed)
+    out.write("# expected %s\n" % " ".join("%d:%d" % (pin, expected[pin]) for pin in PINS))
+    for t, pin, level in events:
+        out.write("%d gpio %d %d\n" % (t, pin, level))
+    out.write("%d end\n" % (args.duration_ms * 1000 + 500000))
+
+
+def read_expected(path):
+    with open(path) as script:
+        for line in script:
+            if line.startswith("# expected "):
+                pairs = (item.split(":") for item in line.split()[2:])
+                return {int(pin): int(count) for pin, count in pairs}
+    sys.exit("%s: no '# expected' line, was it written by 'gen'?" % path)
+
+
+def read_report(path):
+    source = sys.stdin if path == "-" else open(path)
+    for line in source:
+        line = line.strip()
+        if line.startswith("{") and '"debounce"' in line:
+            return json.loads(line)
+    sys.exit("%s: no press report found" % path)
+
+
+def check(args):
+    expected = read_expected(args.script)
+    report = read_report(args.output)
+    failed = False
+
+    print("debounce: %s" % report["debounce"])
+    for pin, seen in zip(PINS, report["presses"]):
+        want = expected[pin]
+        lost = max(want - seen, 0)
+        duplicate = max(seen - want, 0)
+        failed |= lost > 0 or duplicate > 0
+        print("pin %2d: expected %3d seen %3d lost %3d duplicate %3d" % (pin, want, seen, lost, duplicate))
+
+    isr = report["isr"]
+    print("isr: %d calls, mean %d ns, max %d ns" % (isr["count"], isr["mean_ns"], isr["max_ns"]))
+    return 1 if failed else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    gen = commands.add_parser("gen", help="write a storm script to stdout")
+    gen.add_argument("--seed", type=int, default=1)
+    gen.add_argument("--duration-ms", type=int, default=5000)
+
+    chk = commands.add_parser("check", help="compare a run against its script")
+    chk.add_argument("script")
+    chk.add_argument("output", help="practice output, '-' for stdin")
+
+    args = parser.parse_args()
+    if args.command == "gen":
+        generate(args)
+        return 0
+    return check(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
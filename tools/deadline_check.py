@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""Check the ADC practice's deadline misses against an overload scenario.
+
+Reads the SIM_SCRIPT and the practice output of a -DDEADLINE_MONITOR=1
+-DSIM_VIRTUAL_TIME=1 host run. The script's `load` events split the run into
+phases. The periodic "ADC deadline at <t> ms" lines give the miss count at
+each report, and the {"deadline":...} line printed at exit gives the period
+and the worst response. For every phase:
+
+- below 100% load the task must not miss a deadline;
+- at 100% load the task is starved, so its stuck job must count about one
+  miss per period;
+- once a 100% phase ends, the stuck job must complete with a response of
+  about the phase's length.
+
+"About" is within --tolerance percent. The exit status is 1 when any check
+fails or the output lacks the lines it needs.
+
+    SIM_SCRIPT=practices/host_sim/scenarios/adc_overload.txt ./adc_host > out.txt
+    python3 tools/deadline_check.py practices/host_sim/scenarios/adc_overload.txt out.txt
+"""
+
+import argparse
+import json
+import re
+import sys
+
+REPORT = re.compile(r"ADC deadline at (\d+) ms: (\d+) jobs, (\d+) misses")
+MISS = re.compile(r"ADC deadline miss at (\d+) ms: response (\d+) us")
+
+
+def read_phases(path):
+    """Return [(start_us, end_us, load_pct)] covering the whole script."""
+    loads = [(0, 0)]
+    end = None
+    for line in open(path):
+        fields = line.split("#", 1)[0].split()
+        if len(fields) >= 4 and fields[1] == "load":
+            loads.append((int(fields[0]), int(fields[3])))
+        elif len(fields) >= 2 and fields[1] == "end":
+            end = int(fields[0])
+    if end is None:
+        sys.exit("%s: the script has no end event" % path)
+    loads.sort(key=lambda load: load[0])
+    bounds = [t for t, _ in loads[1:]] + [end]
+    return [(start, stop, pct) for (start, pct), stop in zip(loads, bounds) if stop > start]
+
+
+def read_output(path, task):
+    reports, misses, stats = [], [], None
+    source = sys.stdin if path == "-" else open(path, errors="replace")
+    for line in source:
+        match = REPORT.search(line)
+        if match:
+            reports.append(tuple(int(group) for group in match.groups()))
+            continue
+        match = MISS.search(line)
+        if match:
+            misses.append((int(match.group(1)), int(match.group(2))))
+            continue
+        start = line.find('{"deadline"')
+        if start >= 0:
+            try:
+                record = json.loads(line[start:])
+            except ValueError:
+                continue
+            if record.get("deadline") == task:
+                stats = record
+    return reports, misses, stats
+
+
+def near(value, expected, tolerance):
+    return abs(value - expected) <= expected * tolerance / 100.0
+
+
+def check(phases, reports, misses, stats, tolerance):
+    """Yield (ok, message) for each check."""
+
+    def last_before(t_ms):
+        found = [report for report in reports if report[0] <= t_ms]
+        return found[-1] if found else None
+
+    def first_after(t_ms):
+        return next((report for report in reports if report[0] >= t_ms), None)
+
+    reports = [(0, 0, 0)] + reports  # Nothing is counted before the task starts
+    period_us = stats["period_us"]
+    previous_pct = 0
+    for start, stop, pct in phases:
+        name = "%.1f-%.1f s at %d%%" % (start / 1e6, stop / 1e6, pct)
+        if pct < 100:
+            # After a starved phase the first report still carries the stuck job's misses
+            before = first_after(start // 1000) if previous_pct >= 100 else last_before(start // 1000)
+            after = last_before(stop // 1000)
+            if before is None or after is None or after[0] < before[0]:
+                yield False, "%s: no deadline reports inside the phase" % name
+            else:
+                missed = after[2] - before[2]
+                yield missed == 0, "%s: %d misses between %d and %d ms, expected 0" % (
+                    name, missed, before[0], after[0])
+        else:
+            before = last_before(start // 1000)
+            after = first_after(stop // 1000)
+            expected = (stop - start) // period_us
+            if before is None or after is None:
+                yield False, "%s: no deadline report before and after the phase" % name
+            else:
+                missed = after[2] - before[2]
+                yield near(missed, expected, tolerance), "%s: %d misses, expected about %d" % (
+                    name, missed, expected)
+
+            response = stats["response_us"]["max"]
+            expected_us = stop - start
+            logged = next((miss for miss in misses if miss[0] >= stop // 1000), None)
+            detail = ", overrun handler logged %d us at %d ms" % (logged[1], logged[0]) if logged else ""
+            yield near(response, expected_us, tolerance), "%s: response max %d us, expected about %d%s" % (
+                name, response, expected_us, detail)
+        previous_pct = pct
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("script", help="SIM_SCRIPT the run used")
+    parser.add_argument("output", help="practice output, '-' for stdin")
+    parser.add_argument("--task", default="ADC Read Task", help="task name in the deadline report")
+    parser.add_argument("--tolerance", type=float, default=10, help="allowed error in percent")
+    args = parser.parse_args()
+
+    phases = read_phases(args.script)
+    reports, misses, stats = read_output(args.output, args.task)
+    if stats is None:
+        sys.exit('%s: no {"deadline":"%s"} line, was it built with DEADLINE_MONITOR=1?' % (args.output, args.task))
+    if not reports:
+        sys.exit("%s: no \"ADC deadline at\" lines, was it built with TELEMETRY=0?" % args.output)
+
+    failed = 0
+    for ok, message in check(phases, reports, misses, stats, args.tolerance):
+        print("%s %s" % ("ok  " if ok else "FAIL", message))
+        failed += not ok
+    print("deadline_check: %d jobs, %d misses, %d in a row at most" % (
+        stats["jobs"], stats["misses"], stats["max_consecutive_misses"]))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
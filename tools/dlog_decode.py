@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""Decode the binary stream written by common/dlog.c when built with DLOG_BINARY=1.
+
+Reads the raw serial capture (or host run stdout) and prints one line per
+record: timestamp in microseconds, core and the formatted message.
+
+    python3 tools/dlog_decode.py capture.bin
+    ./adc_host | python3 tools/dlog_decode.py -
+"""
+
+import re
+import struct
+import sys
+
+SYNC = b"\xd1\x06"
+FRAME_FORMAT = 1
+FRAME_RECORD = 2
+FRAME_DROP = 3
+
+CONVERSION = re.compile(r"%[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l|z)?([diouxXc%])")
+
+
+def render(fmt, args):
+    """Apply a C format string to the 32-bit integer arguments of a record."""
+    values = iter(args)
+    out = []
+    pos = 0
+    for match in CONVERSION.finditer(fmt):
+        out.append(fmt[pos:match.start()])
+        pos = match.end()
+        kind = match.group(1)
+        if kind == "%":
+            out.append("%")
+            continue
+        value = next(values, 0)
+        if kind in "di" and value & 0x80000000:
+            value -= 1 << 32
+        spec = re.sub(r"(hh|h|ll|l|z)", "", match.group(0))
+        out.append(spec.replace("u", "d") % value)
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def frames(data):
+    """Yield (type, payload) for every well-formed frame, skipping other output."""
+    pos = 0
+    while True:
+        pos = data.find(SYNC, pos)
+        if pos < 0 or pos + 4 > len(data):
+            return
+        kind, length = data[pos + 2], data[pos + 3]
+        payload = data[pos + 4:pos + 4 + length]
+        if len(payload) < length:
+            return
+        yield kind, payload
+        pos += 4 + length
+
+
+def decode(data, out):
+    formats = {}
+    for kind, payload in frames(data):
+        if kind == FRAME_FORMAT and len(payload) >= 2:
+            (fmt_id,) = struct.unpack_from("<H", payload)
+            formats[fmt_id] = payload[2:].decode("utf-8", "replace")
+        elif kind == FRAME_RECORD and len(payload) >= 8:
+            fmt_id, t_us, core, nargs = struct.unpack_from("<HIBB", payload)
+            args = struct.unpack_from("<%dI" % nargs, payload, 8)
+            fmt = formats.get(fmt_id, "<unknown format %d>" % fmt_id)
+            text = render(fmt, args).rstrip("\n")
+            out.write("%10d us  core%d  %s\n" % (t_us, core, text))
+        elif kind == FRAME_DROP and len(payload) == 4:
+            (dropped,) = struct.unpack_from("<I", payload)
+            out.write("%25s[dlog] %d records dropped\n" % ("", dropped))
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    path = sys.argv[1]
+    data = sys.stdin.buffer.read() if path == "-" else open(path, "rb").read()
+    decode(data, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Decode the heap profile frames written by common/heap_profile.c (HEAP_PROFILE=1).
+
+Prints one report per snapshot: heap usage and fragmentation, per-task
+allocation counts with the lifetime histogram, and the call sites that still
+hold memory. A site whose live block count grew in every snapshot is flagged
+as a probable leak. The last report ends with a configTOTAL_HEAP_SIZE
+suggestion based on the lowest free heap ever seen.
+
+    python3 tools/heap_decode.py capture.bin
+    ./heap_host | python3 tools/heap_decode.py -
+
+Call sites are return addresses; on the board resolve them with
+arm-none-eabi-addr2line -e <practice>.elf <address>.
+"""
+
+import struct
+import sys
+
+from dlog_decode import frames
+
+FRAME_HEAP = 0x10
+FRAME_TASK = 0x11
+FRAME_SITE = 0x12
+
+LIFETIME_BUCKETS = 12
+HEADROOM = 1.25
+
+
+def lifetime_label(bucket):
+    if bucket == LIFETIME_BUCKETS - 1:
+        return ">=%dms" % (1 << (bucket - 1))
+    return "<%dms" % (1 << bucket)
+
+
+def snapshots(data):
+    """Group frames into snapshots, each starting at a heap frame."""
+    current = None
+    for kind, payload in frames(data):
+        if kind == FRAME_HEAP and len(payload) == 40:
+            if current is not None:
+                yield current
+            fields = struct.unpack("<10I", payload)
+            keys = ("t_ms", "total", "free", "min_ever", "largest", "smallest",
+                    "free_blocks", "allocs", "frees", "untracked")
+            current = {"heap": dict(zip(keys, fields)), "tasks": [], "sites": []}
+        elif current is None:
+            continue
+        elif kind == FRAME_TASK and len(payload) == 40 + 2 * LIFETIME_BUCKETS:
+            name = payload[:16].split(b"\0", 1)[0].decode("utf-8", "replace")
+            counts = struct.unpack_from("<6I", payload, 16)
+            lifetime = struct.unpack_from("<%dH" % LIFETIME_BUCKETS, payload, 40)
+            current["tasks"].append((name,) + counts + (lifetime,))
+        elif kind == FRAME_SITE and len(payload) == 16:
+            current["sites"].append(struct.unpack("<4I", payload))
+    if current is not None:
+        yield current
+
+
+def report(snapshot, history, out):
+    heap = snapshot["heap"]
+    fragmentation = 0.0
+    if heap["free"]:
+        fragmentation = 100.0 * (1.0 - heap["largest"] / heap["free"])
+    out.write("t=%d ms  free %d/%d B  min ever %d B  largest free %d B  "
+              "free blocks %d  fragmentation %.1f%%  untracked %d\n"
+              % (heap["t_ms"], heap["free"], heap["total"], heap["min_ever"], heap["largest"],
+                 heap["free_blocks"], fragmentation, heap["untracked"]))
+
+    for name, allocs, frees, failures, allocated, live, peak, lifetime in snapshot["tasks"]:
+        hist = " ".join("%s:%d" % (lifetime_label(b), n) for b, n in enumerate(lifetime) if n)
+        out.write("  task %-16s allocs %6d frees %6d fails %3d bytes %8d live %7d peak %7d  %s\n"
+                  % (name, allocs, frees, failures, allocated, live, peak, hist))
+
+    for caller, allocs, live, live_bytes in sorted(snapshot["sites"], key=lambda s: -s[3]):
+        seen = history.setdefault(caller, [])
+        seen.append(live)
+        growing = len(seen) >= 3 and all(b > a for a, b in zip(seen, seen[1:]))
+        if live or growing:
+            out.write("  site 0x%08x allocs %6d live %5d (%d B)%s\n"
+                      % (caller, allocs, live, live_bytes, "  <- probable leak" if growing else ""))
+
+
+def decode(data, out):
+    history = {}
+    last = None
+    for snapshot in snapshots(data):
+        report(snapshot, history, out)
+        last = snapshot["heap"]
+    if last is not None:
+        peak_used = last["total"] - last["min_ever"]
+        out.write("peak heap use %d B; configTOTAL_HEAP_SIZE of %d B leaves %d%% headroom\n"
+                  % (peak_used, int(peak_used * HEADROOM), int((HEADROOM - 1) * 100)))
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    path = sys.argv[1]
+    data = sys.stdin.buffer.read() if path == "-" else open(path, "rb").read()
+    decode(data, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""Turn the stack report of a STACK_PROFILE=1 run into a practice's stack_sizes.h.
+
+Reads the JSON lines printed by common/stack_profile.c (host output at exit
+or a serial capture from the board), keeps the deepest use seen for each
+task name and writes a header with one STACK_<NAME> depth per task: used
+bytes plus the safety margin, in 32-bit words, rounded up to a multiple of
+16 and never below the minimum. Only tasks whose "owner" is "practice" are
+sized: stack_profile marks the kernel, simulator and common/ module tasks,
+whose stacks are set where they are created.
+
+    SIM_SCRIPT=... ./adc_host > run.txt
+    python3 tools/stack_sizes.py --update "practices/04 - ADC/stack_sizes.h" run.txt
+
+With --update the header is rewritten in place. Its STACK_ macros for tasks
+the run did not create (bench tasks, the other design of a practice) are
+kept with their value and marked as not measured, so every build still
+finds them. Without it the header goes to stdout.
+
+The header comments are in Portuguese like the rest of the practices; pass
+--lang en for the Semath practices, whose sources are in English.
+
+Tasks that used more than the configured stack minus the margin, and any
+stack overflow reported by vApplicationStackOverflowHook, are listed on
+stderr; the exit status is 1 when there is one.
+"""
+
+import argparse
+import json
+import math
+import re
+import sys
+
+HEADER = {
+    "pt": ("// Profundidade da pilha de cada tarefa, em palavras. Gerado por\n"
+           "// tools/stack_sizes.py com margem de %d%% sobre o uso medido.\n",
+           "%s: %d bytes usados (%s), antes %d",
+           "não medido, mantido"),
+    "en": ("// Stack depth of each task, in words. Generated by tools/stack_sizes.py\n"
+           "// with a %d%% margin over the measured use.\n",
+           "%s: %d bytes used (%s), was %d",
+           "not measured, kept"),
+}
+
+DEFINE = re.compile(r"^#define\s+(STACK_\w+)\s+(.*?)\s*(?://.*)?$")
+
+
+def macro(name):
+    return "STACK_" + re.sub(r"[^A-Z0-9]+", "_", name.upper()).strip("_")
+
+
+def read(source):
+    tasks = {}
+    overflows = []
+    for line in source:
+        line = line.strip()
+        if not line.startswith("{"):
+            continue
+        try:
+            record = json.loads(line)
+        except ValueError:
+            continue
+        if "stack_overflow" in record:
+            overflows.append(record["stack_overflow"])
+        elif "stack" in record and record.get("owner", "practice") == "practice":
+            seen = tasks.get(record["stack"])
+            if seen is None or record["used_bytes"] > seen["used_bytes"]:
+                tasks[record["stack"]] = record
+    return tasks, overflows
+
+
+def read_header(path):
+    """Return {macro: value} for the STACK_ macros of an existing header."""
+    kept = {}
+    for line in open(path):
+        match = DEFINE.match(line.strip())
+        if match and match.group(1) != "STACK_SIZES_H":
+            kept[match.group(1)] = match.group(2)
+    return kept
+
+
+def recommend(used_bytes, args):
+    words = math.ceil(used_bytes * (100 + args.margin) / 100 / args.word_bytes)
+    words = math.ceil(words / 16) * 16
+    return max(words, args.min_words)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("report", help="practice output, '-' for stdin")
+    parser.add_argument("--margin", type=int, default=25, help="safety margin in percent")
+    parser.add_argument("--word-bytes", type=int, default=4, help="StackType_t size on the target")
+    parser.add_argument("--min-words", type=int, default=128, help="configMINIMAL_STACK_SIZE on the board")
+    parser.add_argument("--lang", choices=sorted(HEADER), default="pt", help="language of the header comments")
+    parser.add_argument("--update", metavar="HEADER", help="rewrite this stack_sizes.h, keeping unmeasured macros")
+    args = parser.parse_args()
+
+    source = sys.stdin if args.report == "-" else open(args.report)
+    tasks, overflows = read(source)
+    if not tasks:
+        sys.exit("%s: no stack report found, was it built with STACK_PROFILE=1?" % args.report)
+
+    measured = {macro(name): name for name in tasks}
+    kept = {name: value for name, value in (read_header(args.update) if args.update else {}).items()
+            if name not in measured}
+    width = max(len(name) for name in list(measured) + list(kept))
+    intro, note, kept_note = HEADER[args.lang]
+    lines = ["#ifndef STACK_SIZES_H\n#define STACK_SIZES_H\n\n", intro % args.margin + "\n"]
+    for name in sorted(measured):
+        record = tasks[measured[name]]
+        words = recommend(record["used_bytes"], args)
+        lines.append("#define %s %d  // %s\n" % (name.ljust(width), words, note % (
+            measured[name], record["used_bytes"], record["source"], record["words"])))
+    for name in sorted(kept):
+        lines.append("#define %s %s  // %s\n" % (name.ljust(width), kept[name], kept_note))
+    lines.append("\n#endif\n")
+
+    out = open(args.update, "w") if args.update else sys.stdout
+    out.writelines(lines)
+    if args.update:
+        out.close()
+
+    risky = [name for name in sorted(tasks) if tasks[name].get("risk")]
+    for name in risky:
+        record = tasks[name]
+        print("risk: %s used %d of %d bytes" % (name, record["used_bytes"], record["words"] * args.word_bytes),
+              file=sys.stderr)
+    for name in overflows:
+        print("overflow: %s" % name, file=sys.stderr)
+    return 1 if risky or overflows else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
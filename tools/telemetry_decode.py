@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Decode the telemetry stream written by common/telemetry.c (TELEMETRY=1).
+
+Frames are COBS-encoded records ending in a zero byte, each with a
+CRC-16/CCITT. Anything else in the capture (printf text, dlog frames) fails
+the check and is skipped. By default one JSON object per record is printed;
+--csv PREFIX writes PREFIX_task.csv, PREFIX_adc.csv (one row per sample),
+PREFIX_heap.csv and PREFIX_event.csv instead. A summary with the frame count,
+damaged frames and records lost in transit (gaps in the sequence number) goes
+to stderr; printf text between batches is counted apart from damaged frames.
+
+    python3 tools/telemetry_decode.py capture.bin
+    ./adc_host | python3 tools/telemetry_decode.py --csv adc -
+"""
+
+import argparse
+import binascii
+import csv
+import json
+import struct
+import sys
+
+RECORD_TASK = 0x01
+RECORD_ADC = 0x02
+RECORD_HEAP = 0x03
+RECORD_EVENT = 0x04
+RECORD_NAME = 0x05
+
+HEADER = struct.Struct("<BBI")
+NAME_LEN = 16
+HEAP_FIELDS = ("total", "free", "min_ever", "pool_in_use", "pool_blocks",
+               "pool_failures", "fallback_in_use")
+
+CSV_COLUMNS = {
+    "task": ("t_us", "seq", "name", "usage", "peak"),
+    "adc": ("t_us", "seq", "channel", "index", "value"),
+    "heap": ("t_us", "seq") + HEAP_FIELDS,
+    "event": ("t_us", "seq", "name", "value"),
+}
+
+
+def cobs_decode(data):
+    """Return the decoded bytes, or None if the frame is malformed."""
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        end = pos + code
+        if code == 0 or end > len(data):
+            return None
+        out += data[pos + 1:end]
+        pos = end
+        if code < 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def is_text(chunk):
+    return all(32 <= byte < 127 or byte in b"\t\r\n" for byte in chunk)
+
+
+def records(data, summary):
+    """Yield (type, seq, t_us, payload) for every frame whose CRC matches."""
+    for chunk in data.split(b"\0"):
+        if not chunk:
+            continue
+        raw = cobs_decode(chunk)
+        if raw is None or len(raw) < HEADER.size + 2 or \
+                binascii.crc_hqx(raw[:-2], 0xFFFF) != struct.unpack_from("<H", raw, len(raw) - 2)[0]:
+            # printf output between batches is expected; anything else is a damaged frame
+            summary["text" if is_text(chunk) else "bad_frames"] += 1
+            continue
+        body = raw[:-2]
+        kind, seq, t_us = HEADER.unpack_from(body)
+        summary["frames"] += 1
+        if summary["last_seq"] is not None:
+            summary["lost"] += (seq - summary["last_seq"] - 1) & 0xFF
+        summary["last_seq"] = seq
+        yield kind, seq, t_us, body[HEADER.size:]
+
+
+def parse(data, summary):
+    """Yield (table, row) pairs; adc records expand to one row per sample."""
+    names = {}
+    for kind, seq, t_us, payload in records(data, summary):
+        if kind == RECORD_NAME and len(payload) >= 2:
+            (name_id,) = struct.unpack_from("<H", payload)
+            names[name_id] = payload[2:].decode("utf-8", "replace")
+        elif kind == RECORD_TASK and len(payload) == NAME_LEN + 4:
+            name = payload[:NAME_LEN].split(b"\0", 1)[0].decode("utf-8", "replace")
+            usage, peak = struct.unpack_from("<HH", payload, NAME_LEN)
+            yield "task", {"t_us": t_us, "seq": seq, "name": name,
+                           "usage": usage / 100.0, "peak": peak / 100.0}
+        elif kind == RECORD_ADC and len(payload) >= 2 and len(payload) == 2 + 2 * payload[1]:
+            channel, count = payload[0], payload[1]
+            for index, value in enumerate(struct.unpack_from("<%dH" % count, payload, 2)):
+                yield "adc", {"t_us": t_us, "seq": seq, "channel": channel,
+                              "index": index, "value": value}
+        elif kind == RECORD_HEAP and len(payload) == 4 * len(HEAP_FIELDS):
+            row = {"t_us": t_us, "seq": seq}
+            row.update(zip(HEAP_FIELDS, struct.unpack("<%dI" % len(HEAP_FIELDS), payload)))
+            yield "heap", row
+        elif kind == RECORD_EVENT and len(payload) == 6:
+            name_id, value = struct.unpack("<HI", payload)
+            yield "event", {"t_us": t_us, "seq": seq,
+                            "name": names.get(name_id, "#%d" % name_id), "value": value}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", help="raw capture file, or - for stdin")
+    parser.add_argument("--csv", metavar="PREFIX", help="write one CSV file per record type")
+    args = parser.parse_args()
+
+    data = sys.stdin.buffer.read() if args.capture == "-" else open(args.capture, "rb").read()
+    summary = {"frames": 0, "bad_frames": 0, "text": 0, "lost": 0, "last_seq": None}
+
+    if args.csv:
+        files = {}
+        writers = {}
+        for table, row in parse(data, summary):
+            if table not in writers:
+                files[table] = open("%s_%s.csv" % (args.csv, table), "w", newline="")
+                writers[table] = csv.DictWriter(files[table], fieldnames=CSV_COLUMNS[table])
+                writers[table].writeheader()
+            writers[table].writerow(row)
+        for handle in files.values():
+            handle.close()
+    else:
+        for table, row in parse(data, summary):
+            print(json.dumps(dict(record=table, **row)))
+
+    del summary["last_seq"]
+    sys.stderr.write("telemetry: %s\n" % json.dumps(summary))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""Convert the kernel trace written by common/trace_recorder.c (TRACE_RECORDER=1)
+into Chrome trace-event JSON, which ui.perfetto.dev and chrome://tracing open.
+
+Each core becomes a track with one slice per task, from its switch-in to the
+next switch-in on that core; ISRs are slices on their own track. Queue,
+semaphore and mutex operations are instant events on a track per queue, with
+a counter of the items waiting. Arrows link a notification to the next time
+the notified task runs and a send to the receive that takes the item.
+
+    python3 tools/trace_to_chrome.py capture.bin > trace.json
+    ./counting_host | python3 tools/trace_to_chrome.py - > trace.json
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+from dlog_decode import frames
+
+FRAME_HEADER = 0x20
+FRAME_NAME = 0x21
+FRAME_EVENTS = 0x22
+
+SWITCH_IN = 0x01
+QUEUE_SEND = 0x02
+QUEUE_RECEIVE = 0x03
+QUEUE_BLOCK = 0x04
+QUEUE_SEND_ISR = 0x05
+QUEUE_RECEIVE_ISR = 0x06
+QUEUE_GIVE_ISR = 0x07
+NOTIFY = 0x08
+NOTIFY_ISR = 0x09
+NOTIFY_GIVE_ISR = 0x0A
+ISR_ENTER = 0x0B
+ISR_EXIT = 0x0C
+
+# Change in items waiting after each queue operation; arg is the count before
+QUEUE_OPS = {
+    QUEUE_SEND: ("send", 1),
+    QUEUE_RECEIVE: ("receive", -1),
+    QUEUE_BLOCK: ("block", 0),
+    QUEUE_SEND_ISR: ("send_from_isr", 1),
+    QUEUE_RECEIVE_ISR: ("receive_from_isr", -1),
+    QUEUE_GIVE_ISR: ("give_from_isr", 1),
+}
+NOTIFY_OPS = {NOTIFY: "notify", NOTIFY_ISR: "notify_from_isr", NOTIFY_GIVE_ISR: "notify_give_from_isr"}
+
+# queueQUEUE_TYPE_* from queue.h
+QUEUE_TYPES = {0: "queue", 1: "mutex", 2: "counting", 3: "binary", 4: "recursive mutex", 5: "set"}
+
+EVENT = struct.Struct("<IHBB")
+PID_CORES = 1
+PID_ISR = 2
+PID_QUEUES = 3
+
+
+def parse(data):
+    """Return (header, task names, queues, events) from the last dump in the capture."""
+    header = None
+    tasks, queues, events = {}, {}, []
+    for kind, payload in frames(data):
+        if kind == FRAME_HEADER and len(payload) == 17:
+            # A new dump replaces whatever came before it
+            header = dict(zip(("t_us", "total", "count", "ring"), struct.unpack_from("<4I", payload)))
+            header["cores"] = payload[16]
+            tasks, queues, events = {}, {}, []
+        elif kind == FRAME_NAME and len(payload) >= 4:
+            (ident,) = struct.unpack_from("<H", payload, 1)
+            name = payload[4:].decode("utf-8", "replace")
+            if payload[0] == 0:
+                tasks[ident] = name
+            else:
+                queues[ident] = (name, payload[3])
+        elif kind == FRAME_EVENTS and len(payload) % EVENT.size == 0:
+            events.extend(EVENT.iter_unpack(payload))
+    return header, tasks, queues, events
+
+
+def unwrap(events):
+    """Yield (t_us, core, type, id, arg) with the 32-bit timer made monotonic."""
+    base = 0
+    last = None
+    for t_us, ident, type_core, arg in events:
+        if last is not None and t_us < last and last - t_us > 1 << 31:
+            base += 1 << 32
+        last = t_us
+        yield base + t_us, type_core >> 7, type_core & 0x7F, ident, arg
+
+
+def convert(header, tasks, queues, events, skip_idle):
+    out = []
+
+    def task_name(ident):
+        return tasks.get(ident, "task %d" % ident)
+
+    def queue_name(ident):
+        name, queue_type = queues.get(ident, ("", 0))
+        return "%s (%s)" % (name or "#%d" % ident, QUEUE_TYPES.get(queue_type, queue_type))
+
+    def meta(pid, tid, name):
+        if tid is None:
+            out.append({"ph": "M", "name": "process_name", "pid": pid, "args": {"name": name}})
+        else:
+            out.append({"ph": "M", "name": "thread_name", "pid": pid, "tid": tid, "args": {"name": name}})
+
+    meta(PID_CORES, None, "Cores")
+    meta(PID_ISR, None, "ISRs")
+    meta(PID_QUEUES, None, "Queues")
+    for core in range(max(header["cores"], 1)):
+        meta(PID_CORES, core, "Core %d" % core)
+
+    running = {}        # core -> (task, start)
+    isr_open = {}       # (core, irq) -> start
+    pending_notify = {} # task -> flow ids waiting for its next switch-in
+    pending_items = {}  # queue -> flow ids of sends not yet received
+    seen_queues = set()
+    seen_irqs = set()
+    flow_id = 0
+    t_end = None
+
+    def close_slice(core, t_us):
+        if core in running:
+            task, start = running.pop(core)
+            name = task_name(task)
+            if not (skip_idle and name.startswith("IDLE")):
+                out.append({"ph": "X", "name": name, "cat": "task", "pid": PID_CORES, "tid": core,
+                            "ts": start, "dur": t_us - start, "args": {"task": task}})
+
+    def flow(phase, ident, pid, tid, t_us, name):
+        event = {"ph": phase, "id": ident, "name": name, "cat": "flow", "pid": pid, "tid": tid, "ts": t_us}
+        if phase == "f":
+            event["bp"] = "e"
+        out.append(event)
+
+    def source(core):
+        """Track of whoever is running on core: an open ISR or the current task."""
+        for (isr_core, irq) in isr_open:
+            if isr_core == core:
+                return PID_ISR, irq
+        return PID_CORES, core
+
+    for t_us, core, kind, ident, arg in unwrap(events):
+        t_end = t_us
+        if kind == SWITCH_IN:
+            close_slice(core, t_us)
+            running[core] = (ident, t_us)
+            for pending in pending_notify.pop(ident, []):
+                flow("f", pending, PID_CORES, core, t_us, "notify")
+        elif kind in QUEUE_OPS:
+            name, delta = QUEUE_OPS[kind]
+            if ident not in seen_queues:
+                seen_queues.add(ident)
+                meta(PID_QUEUES, ident, queue_name(ident))
+            args = {"waiting": arg}
+            if core in running:
+                args["task"] = task_name(running[core][0])
+            out.append({"ph": "i", "s": "t", "name": name, "cat": "queue", "pid": PID_QUEUES, "tid": ident,
+                        "ts": t_us, "args": args})
+            out.append({"ph": "C", "name": queue_name(ident), "pid": PID_QUEUES, "ts": t_us,
+                        "args": {"waiting": max(arg + delta, 0)}})
+            pid, tid = source(core)
+            if delta > 0:
+                flow_id += 1
+                pending_items.setdefault(ident, []).append(flow_id)
+                flow("s", flow_id, pid, tid, t_us, "item")
+            elif delta < 0:
+                # arg items were waiting; sends older than the ring have no arrow
+                sends = pending_items.get(ident, [])
+                del sends[:max(len(sends) - arg, 0)]
+                if sends and len(sends) == arg:
+                    flow("f", sends.pop(0), pid, tid, t_us, "item")
+        elif kind in NOTIFY_OPS:
+            pid, tid = source(core)
+            out.append({"ph": "i", "s": "t", "name": "%s %s" % (NOTIFY_OPS[kind], task_name(ident)),
+                        "cat": "notify", "pid": pid, "tid": tid, "ts": t_us, "args": {"index": arg}})
+            flow_id += 1
+            pending_notify.setdefault(ident, []).append(flow_id)
+            flow("s", flow_id, pid, tid, t_us, "notify")
+        elif kind == ISR_ENTER:
+            if ident not in seen_irqs:
+                seen_irqs.add(ident)
+                meta(PID_ISR, ident, "IRQ %d" % ident)
+            isr_open[(core, ident)] = t_us
+        elif kind == ISR_EXIT and (core, ident) in isr_open:
+            start = isr_open.pop((core, ident))
+            out.append({"ph": "X", "name": "IRQ %d" % ident, "cat": "isr", "pid": PID_ISR, "tid": ident,
+                        "ts": start, "dur": t_us - start, "args": {"core": core}})
+
+    if t_end is not None:
+        for core in list(running):
+            close_slice(core, t_end)
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", help="raw capture file, or - for stdin")
+    parser.add_argument("--skip-idle", action="store_true", help="leave the idle tasks out of the core tracks")
+    args = parser.parse_args()
+
+    data = sys.stdin.buffer.read() if args.capture == "-" else open(args.capture, "rb").read()
+    header, tasks, queues, events = parse(data)
+    if header is None:
+        sys.exit("trace_to_chrome: no trace header in the capture (built with TRACE_RECORDER=1?)")
+
+    json.dump({"traceEvents": convert(header, tasks, queues, events, args.skip_idle)}, sys.stdout)
+    sys.stdout.write("\n")
+    sys.stderr.write("trace_to_chrome: %s\n" % json.dumps(
+        dict(header, events=len(events), tasks=len(tasks), queues=len(queues),
+             overwritten=header["total"] - header["count"])))
+
+
+if __name__ == "__main__":
+    main()